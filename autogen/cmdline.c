@@ -25,13 +25,13 @@
 
 #include "cmdline.h"
 
-const char *gengetopt_args_info_purpose = "Extrinsic measures evaluation: Omega Index (a fuzzy version of the Adjusted\nRand Index, identical to the Fuzzy Rand Index) and [mean] F1-score (prob, harm\nand avg) for the overlapping multi-resolution clusterings, and standard NMI for\nthe non-overlapping clustering on a single resolution. Unequal node base is\nallowed in the evaluating clusterings and optionally can be synchronized\nremoving nodes from the clusters missed in one of the clusterings\n(collections).";
+const char *gengetopt_args_info_purpose = "Extrinsic measures evaluation: Omega Index (a fuzzy version of the Adjusted\nRand Index, identical to the Fuzzy Rand Index) and [mean] F1-score (prob, harm\nand avg) for the overlapping multi-resolution clusterings, overlapping NMI (LFK\nand McDaid's max normalizations) for the overlapping clusterings and standard\nNMI for the non-overlapping clustering on a single resolution. Unequal node\nbase is allowed in the evaluating clusterings and optionally can be\nsynchronized removing nodes from the clusters missed in one of the clusterings\n(collections).";
 
-const char *gengetopt_args_info_usage = "Usage: xmeasures [OPTIONS] clustering1 clustering2\n\n  clustering  - input file, collection of the clusters to be evaluated.\n  \nExamples:\n  $ ./xmeasures -fp -kc networks/5K25.cnl tests/5K25_l0.825/5K25_l0.825_796.cnl\n  $ ./xmeasures -fh -kc -i tests/5K25.cll -ph -l networks/5K25.cnl\ntests/5K25_l0.825/5K25_l0.825_796.cnl\n  $ ./xmeasures -ox tests/clsevalsx/omega_c4.3-1.cnl\ntests/clsevalsx/omega_c4.3-2.cnl\n";
+const char *gengetopt_args_info_usage = "Usage: xmeasures [OPTIONS] clustering1 clustering2\n  xmeasures -c cnb_filename [-z] [-q] clustering\n\n  clustering  - input file, collection of the clusters to be evaluated in the\nCNL or binary clustering (.cnb) format, optionally gzip compressed. '-'\ndesignates the stdin, the streamed input (stdin, named pipes) should be in the\nCNL format.\n  \nExamples:\n  $ ./xmeasures -fp -kc networks/5K25.cnl tests/5K25_l0.825/5K25_l0.825_796.cnl\n  $ ./xmeasures -fh -kc -i tests/5K25.cll -ph -l networks/5K25.cnl\ntests/5K25_l0.825/5K25_l0.825_796.cnl\n  $ ./xmeasures -ox tests/clsevalsx/omega_c4.3-1.cnl\ntests/clsevalsx/omega_c4.3-2.cnl\n  $ ./xmeasures -z -c networks/5K25.cnb networks/5K25.cnl\n";
 
 const char *gengetopt_args_info_versiontext = "Author:  (c) Artem Lutov <artem@exascale.info>\nSources:  https://github.com/eXascaleInfolab/xmeasures\nPaper: \"Accuracy Evaluation of Overlapping and Multi-resolution Clustering\nAlgorithms on Large Datasets\" by Artem Lutov, Mourad Khayati and Philippe\nCudré-Mauroux, BigComp 2019\n";
 
-const char *gengetopt_args_info_description = "Extrinsic measures are evaluated, i.e. two input clusterings (collections of\nclusters) are compared to each other. Optionally, a labeling of the evaluating\nclusters with the specified ground-truth clusters is performed.\nNOTE:\n  - Multiple evaluating measures can be specified.\n  - Each cluster should contain unique members, which is ensured only if the\n'unique' option is specified.\n  - All clusters should be unique to not affect Omega Index evaluation, which\ncan be ensured by the [resmerge](https://github.com/eXascaleInfolab/resmerge)\nutility.\n  - Non-corrected unequal node base in the clusterings is allowed, it penalizes\nthe match.Use [OvpNMI](https://github.com/eXascaleInfolab/OvpNMI) or\n[GenConvNMI](https://github.com/eXascaleInfolab/GenConvNMI) for NMI evaluation\nin the arbitrary collections (still each cluster should contain unique\nmembers).\n\nEvaluating measures are:\n  - OI  - Omega Index (a fuzzy version of the Adjusted Rand Index, identical to\nthe Fuzzy Rand Index), which yields the same value as Adjusted Rand Index when\napplied to the non-overlapping clusterings.\n  - [M]F1  - various [mean] F1 measures of the Greatest (Max) Match including\nthe Average F1-Score (suggested by J. Leskovec) with the optional weighting.\nNOTE: There are 3 matching policies available for each kind of F1. The most\nrepresentative evaluation is performed by the F1p with combined matching\npolicy (considers both micro and macro weighting).\n  - NMI  - Normalized Mutual Information, normalized by either max or also\nsqrt, avg and min information content denominators.\nATTENTION: This is a standard NMI, which should be used ONLY for the HARD\npartitioning evaluation (non-overlapping clustering on a single resolution).\nIt penalizes overlapping and multi-resolution structures.\n";
+const char *gengetopt_args_info_description = "Extrinsic measures are evaluated, i.e. two input clusterings (collections of\nclusters) are compared to each other. Optionally, a labeling of the evaluating\nclusters with the specified ground-truth clusters is performed.\nNOTE:\n  - Multiple evaluating measures can be specified.\n  - Each cluster should contain unique members, which is ensured only if the\n'unique' option is specified.\n  - All clusters should be unique to not affect Omega Index evaluation, which\ncan be ensured by the [resmerge](https://github.com/eXascaleInfolab/resmerge)\nutility.\n  - Non-corrected unequal node base in the clusterings is allowed, it penalizes\nthe match. Use the overlapping NMI ('onmi' option) for the NMI evaluation in\nthe arbitrary collections (still each cluster should contain unique members).\n\nEvaluating measures are:\n  - OI  - Omega Index (a fuzzy version of the Adjusted Rand Index, identical to\nthe Fuzzy Rand Index), which yields the same value as Adjusted Rand Index when\napplied to the non-overlapping clusterings.\n  - [M]F1  - various [mean] F1 measures of the Greatest (Max) Match including\nthe Average F1-Score (suggested by J. Leskovec) with the optional weighting.\nNOTE: There are 3 matching policies available for each kind of F1. The most\nrepresentative evaluation is performed by the F1p with combined matching\npolicy (considers both micro and macro weighting).\n  - NMI  - Normalized Mutual Information, normalized by either max or also\nsqrt, avg and min information content denominators.\nATTENTION: This is a standard NMI, which should be used ONLY for the HARD\npartitioning evaluation (non-overlapping clustering on a single resolution).\nIt penalizes overlapping and multi-resolution structures.\n  - ONMI  - Overlapping NMI normalized by max (McDaid et al.) and LFK\n(Lancichinetti, Fortunato and Kertesz), which matches each cluster to the best\nintersecting cluster of the other clustering.\n";
 
 const char *gengetopt_args_info_help[] = {
   "  -h, --help                    Print help and exit",
@@ -40,6 +40,16 @@ const char *gengetopt_args_info_help[] = {
   "  -q, --unique                  ensure on loading that all cluster members are\n                                  unique by removing all duplicates.\n                                  (default=off)",
   "  -s, --sync=filename           synchronize with the specified node base\n                                  omitting the non-matching nodes.\n                                  NOTE: The node base can be either a separate,\n                                  or an evaluating CNL file, in the latter case\n                                  this option should precede the evaluating\n                                  filename not repeating it",
   "  -m, --membership=FLOAT        average expected membership of the nodes in the\n                                  clusters, > 0, typically >= 1. Used only to\n                                  facilitate estimation of the nodes number on\n                                  the containers preallocation if this number\n                                  is not specified in the file header.\n                                  (default=`1')",
+  "  -S, --string-ids              node ids are arbitrary tokens (e.g. URLs, user\n                                  handles) interned into the dense internal ids\n                                  shared by all input files. The whole member\n                                  token is the id in this mode (the share part\n                                  is not separated), binary clusterings and\n                                  snapshots are not applicable.  (default=off)",
+  "  -B, --batch                   batch evaluation of the clusterings against the\n                                  first one (ground-truth), which is loaded\n                                  once. The clusterings are evaluated\n                                  concurrently and their results are output in\n                                  a single line per each clustering in the\n                                  input order. A list of clusterings can be\n                                  specified as @<filename> with a file name per\n                                  line. The node base (sync) filters the\n                                  ground-truth, which filters the evaluating\n                                  clusterings. Labeling is not applicable in\n                                  this mode.  (default=off)",
+  "  -F, --prefetch=depth          the number of clusterings loaded ahead of their\n                                  evaluation per each worker in the batch mode,\n                                  which bounds the memory consumption of the\n                                  loading pipeline. 0 means the loading on\n                                  demand.  (default=`1')",
+  "  -P, --pairwise[=filename]     evaluate the symmetric matrix of each measure\n                                  (MF1, NMI, ONMI, Omega Index) for all pairs\n                                  of the clusterings, which are loaded once.\n                                  The pairs are evaluated concurrently and the\n                                  matrices are output to the specified file\n                                  (stdout by default) in CSV. A list of\n                                  clusterings can be specified as @<filename>\n                                  with a file name per line. The node base\n                                  (sync) filters each clustering. Labeling is\n                                  not applicable in this mode.",
+  "  -M, --binary-matrix           output the pairwise matrices in the binary\n                                  format (.xpm): the header followed by the\n                                  names of the measures, the row-major float64\n                                  matrix of each measure and the names of the\n                                  clusterings  (default=off)",
+  "  -U, --serve=socket            serve the evaluation requests on the specified\n                                  Unix domain socket keeping the ground-truth\n                                  clusterings resident. Each request is a line:\n                                  EVAL <ground-truth> <clustering | ->\n                                  [--<option>[=<value>] ...], where '-'\n                                  designates the inline CNL clustering\n                                  following the request and terminated by the\n                                  '.' line, and the options are the long\n                                  options of the measures (replacing the server\n                                  ones) and loading (ovp, unique, sync,\n                                  membership); LOAD <ground-truth> [--<option>\n                                  ...]; STATS; STOP. Each response is a line of\n                                  the JSON object. The requests are served\n                                  concurrently by the pool of workers.",
+  "  -R, --budget=MB               memory budget of the resident ground-truth\n                                  clusterings in the serving mode, the least\n                                  recently used clusterings exceeding the\n                                  budget are evicted  (default=`4096')",
+  "  -w, --wide-ids                node ids are 64-bit. Otherwise the 32-bit ids\n                                  are used and the clusterings are reloaded\n                                  with the 64-bit ones if their ids exceed the\n                                  32-bit range, which is not applicable for the\n                                  streamed input.  (default=off)",
+  "  -t, --prescan                 count the nodes of the loaded clusterings\n                                  before their indexing to preallocate the\n                                  containers exactly if the number of nodes is\n                                  not specified in the file header. The counts\n                                  are cached in the <clustering>.cnt sidecar\n                                  file, which is invalidated on the clustering\n                                  modification.  (default=off)",
+  "  -C, --cache-dir=dirname       directory of the cached binary snapshots of the\n                                  loaded CNL clusterings (typically the\n                                  ground-truth evaluated many times), which are\n                                  mapped instead of the parsing. A snapshot is\n                                  invalidated when the path, size, modification\n                                  time or content hash of its clustering\n                                  changes.",
   "  -d, --detailed                detailed (verbose) results output\n                                  (default=off)",
   "\nOmega Index:",
   "  -o, --omega                   evaluate Omega Index (a fuzzy version of the\n                                  Adjusted Rand Index, identical to the Fuzzy\n                                  Rand Index and on the non-overlapping\n                                  clusterings equals to ARI).  (default=off)",
@@ -52,16 +62,22 @@ const char *gengetopt_args_info_help[] = {
   "  -p, --policy[=ENUM]           Labels matching policy:\n                                   - p  - Partial Probabilities (maximizes\n                                  gain)\n                                   - h  - Harmonic Mean (minimizes loss,\n                                  maximizes F1)\n                                    (possible values=\"partprob\", \"harmonic\"\n                                  default=`harmonic')",
   "  -u, --unweighted              Labels weighting policy on F1 evaluation:\n                                  weighted by the number of instances in each\n                                  label by default (micro weighting, F1_micro)\n                                  or unweighed, where each label is treated\n                                  equally (i.e. macro weighting, F1_macro)\n                                  (default=off)",
   "  -i, --identifiers=labels_filename\n                                output labels (identifiers) of the evaluating\n                                  clusters as lines of space-separated indices\n                                  of the ground-truth clusters (.cll - clusters\n                                  labels list)\n                                  NOTE: If 'sync' option is specified then the\n                                  reduced collection is outputted to the\n                                  <labels_filename>.cnl besides the\n                                  <labels_filename>\n",
+  "  -b, --binary-labels           output labels (identifiers) of the evaluating\n                                  clusters in the binary CSR format (.clb): the\n                                  header followed by the offsets of the labels\n                                  of each cluster and the ordered indices of\n                                  the ground-truth clusters  (default=off)",
   "\nNMI:",
   "  -n, --nmi                     evaluate NMI (Normalized Mutual Information),\n                                  applicable only to the non-overlapping\n                                  clusters  (default=off)",
   "  -a, --all                     evaluate all NMIs using sqrt, avg and min\n                                  denominators besides the max one\n                                  (default=off)",
   "  -e, --ln                      use ln (exp base) instead of log2 (Shannon\n                                  entropy, bits) for the information measuring\n                                  (default=off)",
+  "  -N, --onmi                    evaluate overlapping NMI normalized by max\n                                  (McDaid et al.) and LFK, applicable to the\n                                  overlapping and multi-resolution clusters\n                                  (default=off)",
+  "\nBinary Clustering:",
+  "  -c, --convert=cnb_filename    convert the input CNL clustering to the binary\n                                  clustering format (.cnb), which is loaded\n                                  much faster than CNL and can be used instead\n                                  of the CNL clustering in the evaluation.\n                                  NOTE: The 'unique' option is applied on the\n                                  conversion.",
+  "  -z, --compress                compress the node ids of the binary clustering\n                                  by the delta-varint encoding of the sorted\n                                  cluster members  (default=off)",
     0
 };
 
 typedef enum {ARG_NO
   , ARG_FLAG
   , ARG_STRING
+  , ARG_INT
   , ARG_FLOAT
   , ARG_ENUM
 } cmdline_parser_arg_type;
@@ -94,6 +110,16 @@ void clear_given (struct gengetopt_args_info *args_info)
   args_info->unique_given = 0 ;
   args_info->sync_given = 0 ;
   args_info->membership_given = 0 ;
+  args_info->string_ids_given = 0 ;
+  args_info->batch_given = 0 ;
+  args_info->prefetch_given = 0 ;
+  args_info->pairwise_given = 0 ;
+  args_info->binary_matrix_given = 0 ;
+  args_info->serve_given = 0 ;
+  args_info->budget_given = 0 ;
+  args_info->wide_ids_given = 0 ;
+  args_info->prescan_given = 0 ;
+  args_info->cache_dir_given = 0 ;
   args_info->detailed_given = 0 ;
   args_info->omega_given = 0 ;
   args_info->extended_given = 0 ;
@@ -103,9 +129,13 @@ void clear_given (struct gengetopt_args_info *args_info)
   args_info->policy_given = 0 ;
   args_info->unweighted_given = 0 ;
   args_info->identifiers_given = 0 ;
+  args_info->binary_labels_given = 0 ;
   args_info->nmi_given = 0 ;
   args_info->all_given = 0 ;
   args_info->ln_given = 0 ;
+  args_info->onmi_given = 0 ;
+  args_info->convert_given = 0 ;
+  args_info->compress_given = 0 ;
 }
 
 static
@@ -118,6 +148,21 @@ void clear_args (struct gengetopt_args_info *args_info)
   args_info->sync_orig = NULL;
   args_info->membership_arg = 1;
   args_info->membership_orig = NULL;
+  args_info->string_ids_flag = 0;
+  args_info->batch_flag = 0;
+  args_info->prefetch_arg = 1;
+  args_info->prefetch_orig = NULL;
+  args_info->pairwise_arg = NULL;
+  args_info->pairwise_orig = NULL;
+  args_info->binary_matrix_flag = 0;
+  args_info->serve_arg = NULL;
+  args_info->serve_orig = NULL;
+  args_info->budget_arg = 4096;
+  args_info->budget_orig = NULL;
+  args_info->wide_ids_flag = 0;
+  args_info->prescan_flag = 0;
+  args_info->cache_dir_arg = NULL;
+  args_info->cache_dir_orig = NULL;
   args_info->detailed_flag = 0;
   args_info->omega_flag = 0;
   args_info->extended_flag = 0;
@@ -132,9 +177,14 @@ void clear_args (struct gengetopt_args_info *args_info)
   args_info->unweighted_flag = 0;
   args_info->identifiers_arg = NULL;
   args_info->identifiers_orig = NULL;
+  args_info->binary_labels_flag = 0;
   args_info->nmi_flag = 0;
   args_info->all_flag = 0;
   args_info->ln_flag = 0;
+  args_info->onmi_flag = 0;
+  args_info->convert_arg = NULL;
+  args_info->convert_orig = NULL;
+  args_info->compress_flag = 0;
   
 }
 
@@ -149,18 +199,32 @@ void init_args_info(struct gengetopt_args_info *args_info)
   args_info->unique_help = gengetopt_args_info_help[3] ;
   args_info->sync_help = gengetopt_args_info_help[4] ;
   args_info->membership_help = gengetopt_args_info_help[5] ;
-  args_info->detailed_help = gengetopt_args_info_help[6] ;
-  args_info->omega_help = gengetopt_args_info_help[8] ;
-  args_info->extended_help = gengetopt_args_info_help[9] ;
-  args_info->f1_help = gengetopt_args_info_help[11] ;
-  args_info->kind_help = gengetopt_args_info_help[12] ;
-  args_info->label_help = gengetopt_args_info_help[14] ;
-  args_info->policy_help = gengetopt_args_info_help[15] ;
-  args_info->unweighted_help = gengetopt_args_info_help[16] ;
-  args_info->identifiers_help = gengetopt_args_info_help[17] ;
-  args_info->nmi_help = gengetopt_args_info_help[19] ;
-  args_info->all_help = gengetopt_args_info_help[20] ;
-  args_info->ln_help = gengetopt_args_info_help[21] ;
+  args_info->string_ids_help = gengetopt_args_info_help[6] ;
+  args_info->batch_help = gengetopt_args_info_help[7] ;
+  args_info->prefetch_help = gengetopt_args_info_help[8] ;
+  args_info->pairwise_help = gengetopt_args_info_help[9] ;
+  args_info->binary_matrix_help = gengetopt_args_info_help[10] ;
+  args_info->serve_help = gengetopt_args_info_help[11] ;
+  args_info->budget_help = gengetopt_args_info_help[12] ;
+  args_info->wide_ids_help = gengetopt_args_info_help[13] ;
+  args_info->prescan_help = gengetopt_args_info_help[14] ;
+  args_info->cache_dir_help = gengetopt_args_info_help[15] ;
+  args_info->detailed_help = gengetopt_args_info_help[16] ;
+  args_info->omega_help = gengetopt_args_info_help[18] ;
+  args_info->extended_help = gengetopt_args_info_help[19] ;
+  args_info->f1_help = gengetopt_args_info_help[21] ;
+  args_info->kind_help = gengetopt_args_info_help[22] ;
+  args_info->label_help = gengetopt_args_info_help[24] ;
+  args_info->policy_help = gengetopt_args_info_help[25] ;
+  args_info->unweighted_help = gengetopt_args_info_help[26] ;
+  args_info->identifiers_help = gengetopt_args_info_help[27] ;
+  args_info->binary_labels_help = gengetopt_args_info_help[28] ;
+  args_info->nmi_help = gengetopt_args_info_help[30] ;
+  args_info->all_help = gengetopt_args_info_help[31] ;
+  args_info->ln_help = gengetopt_args_info_help[32] ;
+  args_info->onmi_help = gengetopt_args_info_help[33] ;
+  args_info->convert_help = gengetopt_args_info_help[35] ;
+  args_info->compress_help = gengetopt_args_info_help[36] ;
   
 }
 
@@ -256,6 +320,14 @@ cmdline_parser_release (struct gengetopt_args_info *args_info)
   free_string_field (&(args_info->sync_arg));
   free_string_field (&(args_info->sync_orig));
   free_string_field (&(args_info->membership_orig));
+  free_string_field (&(args_info->prefetch_orig));
+  free_string_field (&(args_info->pairwise_arg));
+  free_string_field (&(args_info->pairwise_orig));
+  free_string_field (&(args_info->serve_arg));
+  free_string_field (&(args_info->serve_orig));
+  free_string_field (&(args_info->budget_orig));
+  free_string_field (&(args_info->cache_dir_arg));
+  free_string_field (&(args_info->cache_dir_orig));
   free_string_field (&(args_info->f1_orig));
   free_string_field (&(args_info->kind_orig));
   free_string_field (&(args_info->label_arg));
@@ -263,6 +335,8 @@ cmdline_parser_release (struct gengetopt_args_info *args_info)
   free_string_field (&(args_info->policy_orig));
   free_string_field (&(args_info->identifiers_arg));
   free_string_field (&(args_info->identifiers_orig));
+  free_string_field (&(args_info->convert_arg));
+  free_string_field (&(args_info->convert_orig));
   
   
   for (i = 0; i < args_info->inputs_num; ++i)
@@ -351,6 +425,26 @@ cmdline_parser_dump(FILE *outfile, struct gengetopt_args_info *args_info)
     write_into_file(outfile, "sync", args_info->sync_orig, 0);
   if (args_info->membership_given)
     write_into_file(outfile, "membership", args_info->membership_orig, 0);
+  if (args_info->string_ids_given)
+    write_into_file(outfile, "string-ids", 0, 0 );
+  if (args_info->batch_given)
+    write_into_file(outfile, "batch", 0, 0 );
+  if (args_info->prefetch_given)
+    write_into_file(outfile, "prefetch", args_info->prefetch_orig, 0);
+  if (args_info->pairwise_given)
+    write_into_file(outfile, "pairwise", args_info->pairwise_orig, 0);
+  if (args_info->binary_matrix_given)
+    write_into_file(outfile, "binary-matrix", 0, 0 );
+  if (args_info->serve_given)
+    write_into_file(outfile, "serve", args_info->serve_orig, 0);
+  if (args_info->budget_given)
+    write_into_file(outfile, "budget", args_info->budget_orig, 0);
+  if (args_info->wide_ids_given)
+    write_into_file(outfile, "wide-ids", 0, 0 );
+  if (args_info->prescan_given)
+    write_into_file(outfile, "prescan", 0, 0 );
+  if (args_info->cache_dir_given)
+    write_into_file(outfile, "cache-dir", args_info->cache_dir_orig, 0);
   if (args_info->detailed_given)
     write_into_file(outfile, "detailed", 0, 0 );
   if (args_info->omega_given)
@@ -369,12 +463,20 @@ cmdline_parser_dump(FILE *outfile, struct gengetopt_args_info *args_info)
     write_into_file(outfile, "unweighted", 0, 0 );
   if (args_info->identifiers_given)
     write_into_file(outfile, "identifiers", args_info->identifiers_orig, 0);
+  if (args_info->binary_labels_given)
+    write_into_file(outfile, "binary-labels", 0, 0 );
   if (args_info->nmi_given)
     write_into_file(outfile, "nmi", 0, 0 );
   if (args_info->all_given)
     write_into_file(outfile, "all", 0, 0 );
   if (args_info->ln_given)
     write_into_file(outfile, "ln", 0, 0 );
+  if (args_info->onmi_given)
+    write_into_file(outfile, "onmi", 0, 0 );
+  if (args_info->convert_given)
+    write_into_file(outfile, "convert", args_info->convert_orig, 0);
+  if (args_info->compress_given)
+    write_into_file(outfile, "compress", 0, 0 );
   
 
   i = EXIT_SUCCESS;
@@ -493,6 +595,21 @@ cmdline_parser_required2 (struct gengetopt_args_info *args_info, const char *pro
   /* checks for required options */
   
   /* checks for dependences among options */
+  if (args_info->prefetch_given && ! args_info->batch_given)
+    {
+      fprintf (stderr, "%s: '--prefetch' ('-F') option depends on option 'batch'%s\n", prog_name, (additional_error ? additional_error : ""));
+      error_occurred = 1;
+    }
+  if (args_info->binary_matrix_given && ! args_info->pairwise_given)
+    {
+      fprintf (stderr, "%s: '--binary-matrix' ('-M') option depends on option 'pairwise'%s\n", prog_name, (additional_error ? additional_error : ""));
+      error_occurred = 1;
+    }
+  if (args_info->budget_given && ! args_info->serve_given)
+    {
+      fprintf (stderr, "%s: '--budget' ('-R') option depends on option 'serve'%s\n", prog_name, (additional_error ? additional_error : ""));
+      error_occurred = 1;
+    }
   if (args_info->extended_given && ! args_info->omega_given)
     {
       fprintf (stderr, "%s: '--extended' ('-x') option depends on option 'omega'%s\n", prog_name, (additional_error ? additional_error : ""));
@@ -518,6 +635,11 @@ cmdline_parser_required2 (struct gengetopt_args_info *args_info, const char *pro
       fprintf (stderr, "%s: '--identifiers' ('-i') option depends on option 'label'%s\n", prog_name, (additional_error ? additional_error : ""));
       error_occurred = 1;
     }
+  if (args_info->binary_labels_given && ! args_info->identifiers_given)
+    {
+      fprintf (stderr, "%s: '--binary-labels' ('-b') option depends on option 'identifiers'%s\n", prog_name, (additional_error ? additional_error : ""));
+      error_occurred = 1;
+    }
   if (args_info->all_given && ! args_info->nmi_given)
     {
       fprintf (stderr, "%s: '--all' ('-a') option depends on option 'nmi'%s\n", prog_name, (additional_error ? additional_error : ""));
@@ -528,6 +650,11 @@ cmdline_parser_required2 (struct gengetopt_args_info *args_info, const char *pro
       fprintf (stderr, "%s: '--ln' ('-e') option depends on option 'nmi'%s\n", prog_name, (additional_error ? additional_error : ""));
       error_occurred = 1;
     }
+  if (args_info->compress_given && ! args_info->convert_given)
+    {
+      fprintf (stderr, "%s: '--compress' ('-z') option depends on option 'convert'%s\n", prog_name, (additional_error ? additional_error : ""));
+      error_occurred = 1;
+    }
 
   return error_occurred;
 }
@@ -612,6 +739,9 @@ int update_arg(void *field, char **orig_field,
   case ARG_FLAG:
     *((int *)field) = !*((int *)field);
     break;
+  case ARG_INT:
+    if (val) *((int *)field) = strtol (val, &stop_char, 0);
+    break;
   case ARG_FLOAT:
     if (val) *((float *)field) = (float)strtod (val, &stop_char);
     break;
@@ -632,6 +762,7 @@ int update_arg(void *field, char **orig_field,
 
   /* check numeric conversion */
   switch(arg_type) {
+  case ARG_INT:
   case ARG_FLOAT:
     if (val && !(stop_char && *stop_char == '\0')) {
       fprintf(stderr, "%s: invalid numeric value: %s\n", package_name, val);
@@ -712,6 +843,16 @@ cmdline_parser_internal (
         { "unique",	0, NULL, 'q' },
         { "sync",	1, NULL, 's' },
         { "membership",	1, NULL, 'm' },
+        { "string-ids",	0, NULL, 'S' },
+        { "batch",	0, NULL, 'B' },
+        { "prefetch",	1, NULL, 'F' },
+        { "pairwise",	2, NULL, 'P' },
+        { "binary-matrix",	0, NULL, 'M' },
+        { "serve",	1, NULL, 'U' },
+        { "budget",	1, NULL, 'R' },
+        { "wide-ids",	0, NULL, 'w' },
+        { "prescan",	0, NULL, 't' },
+        { "cache-dir",	1, NULL, 'C' },
         { "detailed",	0, NULL, 'd' },
         { "omega",	0, NULL, 'o' },
         { "extended",	0, NULL, 'x' },
@@ -721,13 +862,17 @@ cmdline_parser_internal (
         { "policy",	2, NULL, 'p' },
         { "unweighted",	0, NULL, 'u' },
         { "identifiers",	1, NULL, 'i' },
+        { "binary-labels",	0, NULL, 'b' },
         { "nmi",	0, NULL, 'n' },
         { "all",	0, NULL, 'a' },
         { "ln",	0, NULL, 'e' },
+        { "onmi",	0, NULL, 'N' },
+        { "convert",	1, NULL, 'c' },
+        { "compress",	0, NULL, 'z' },
         { 0,  0, 0, 0 }
       };
 
-      c = getopt_long (argc, argv, "hVOqs:m:doxf::k::l:p::ui:nae", long_options, &option_index);
+      c = getopt_long (argc, argv, "hVOqs:m:SBF:P::MU:R:wtC:doxf::k::l:p::ui:bnaeNc:z", long_options, &option_index);
 
       if (c == -1) break;	/* Exit from `while (1)' loop.  */
 
@@ -788,6 +933,116 @@ cmdline_parser_internal (
               additional_error))
             goto failure;
         
+          break;
+        case 'S':	/* node ids are arbitrary tokens (e.g. URLs, user handles) interned into the dense internal ids shared by all input files. The whole member token is the id in this mode (the share part is not separated), binary clusterings and snapshots are not applicable..  */
+        
+        
+          if (update_arg((void *)&(args_info->string_ids_flag), 0, &(args_info->string_ids_given),
+              &(local_args_info.string_ids_given), optarg, 0, 0, ARG_FLAG,
+              check_ambiguity, override, 1, 0, "string-ids", 'S',
+              additional_error))
+            goto failure;
+        
+          break;
+        case 'B':	/* batch evaluation of the clusterings against the first one (ground-truth), which is loaded once. The clusterings are evaluated concurrently and their results are output in a single line per each clustering in the input order. A list of clusterings can be specified as @<filename> with a file name per line. The node base (sync) filters the ground-truth, which filters the evaluating clusterings. Labeling is not applicable in this mode..  */
+        
+        
+          if (update_arg((void *)&(args_info->batch_flag), 0, &(args_info->batch_given),
+              &(local_args_info.batch_given), optarg, 0, 0, ARG_FLAG,
+              check_ambiguity, override, 1, 0, "batch", 'B',
+              additional_error))
+            goto failure;
+        
+          break;
+        case 'F':	/* the number of clusterings loaded ahead of their evaluation per each worker in the batch mode, which bounds the memory consumption of the loading pipeline. 0 means the loading on demand..  */
+        
+        
+          if (update_arg( (void *)&(args_info->prefetch_arg), 
+               &(args_info->prefetch_orig), &(args_info->prefetch_given),
+              &(local_args_info.prefetch_given), optarg, 0, "1", ARG_INT,
+              check_ambiguity, override, 0, 0,
+              "prefetch", 'F',
+              additional_error))
+            goto failure;
+        
+          break;
+        case 'P':	/* evaluate the symmetric matrix of each measure (MF1, NMI, ONMI, Omega Index) for all pairs of the clusterings, which are loaded once. The pairs are evaluated concurrently and the matrices are output to the specified file (stdout by default) in CSV. A list of clusterings can be specified as @<filename> with a file name per line. The node base (sync) filters each clustering. Labeling is not applicable in this mode..  */
+        
+        
+          if (update_arg( (void *)&(args_info->pairwise_arg), 
+               &(args_info->pairwise_orig), &(args_info->pairwise_given),
+              &(local_args_info.pairwise_given), optarg, 0, 0, ARG_STRING,
+              check_ambiguity, override, 0, 0,
+              "pairwise", 'P',
+              additional_error))
+            goto failure;
+        
+          break;
+        case 'M':	/* output the pairwise matrices in the binary format (.xpm): the header followed by the names of the measures, the row-major float64 matrix of each measure and the names of the clusterings.  */
+        
+        
+          if (update_arg((void *)&(args_info->binary_matrix_flag), 0, &(args_info->binary_matrix_given),
+              &(local_args_info.binary_matrix_given), optarg, 0, 0, ARG_FLAG,
+              check_ambiguity, override, 1, 0, "binary-matrix", 'M',
+              additional_error))
+            goto failure;
+        
+          break;
+        case 'U':	/* serve the evaluation requests on the specified Unix domain socket keeping the ground-truth clusterings resident. Each request is a line: EVAL <ground-truth> <clustering | -> [--<option>[=<value>] ...], where '-' designates the inline CNL clustering following the request and terminated by the '.' line, and the options are the long options of the measures (replacing the server ones) and loading (ovp, unique, sync, membership); LOAD <ground-truth> [--<option> ...]; STATS; STOP. Each response is a line of the JSON object. The requests are served concurrently by the pool of workers..  */
+        
+        
+          if (update_arg( (void *)&(args_info->serve_arg), 
+               &(args_info->serve_orig), &(args_info->serve_given),
+              &(local_args_info.serve_given), optarg, 0, 0, ARG_STRING,
+              check_ambiguity, override, 0, 0,
+              "serve", 'U',
+              additional_error))
+            goto failure;
+        
+          break;
+        case 'R':	/* memory budget of the resident ground-truth clusterings in the serving mode, the least recently used clusterings exceeding the budget are evicted.  */
+        
+        
+          if (update_arg( (void *)&(args_info->budget_arg), 
+               &(args_info->budget_orig), &(args_info->budget_given),
+              &(local_args_info.budget_given), optarg, 0, "4096", ARG_INT,
+              check_ambiguity, override, 0, 0,
+              "budget", 'R',
+              additional_error))
+            goto failure;
+        
+          break;
+        case 'w':	/* node ids are 64-bit. Otherwise the 32-bit ids are used and the clusterings are reloaded with the 64-bit ones if their ids exceed the 32-bit range, which is not applicable for the streamed input..  */
+        
+        
+          if (update_arg((void *)&(args_info->wide_ids_flag), 0, &(args_info->wide_ids_given),
+              &(local_args_info.wide_ids_given), optarg, 0, 0, ARG_FLAG,
+              check_ambiguity, override, 1, 0, "wide-ids", 'w',
+              additional_error))
+            goto failure;
+        
+          break;
+        case 't':	/* count the nodes of the loaded clusterings before their indexing to preallocate the containers exactly if the number of nodes is not specified in the file header. The counts are cached in the <clustering>.cnt sidecar file, which is invalidated on the clustering modification..  */
+        
+        
+          if (update_arg((void *)&(args_info->prescan_flag), 0, &(args_info->prescan_given),
+              &(local_args_info.prescan_given), optarg, 0, 0, ARG_FLAG,
+              check_ambiguity, override, 1, 0, "prescan", 't',
+              additional_error))
+            goto failure;
+        
+          break;
+        case 'C':	/* directory of the cached binary snapshots of the loaded CNL clusterings (typically the ground-truth evaluated many times), which are mapped instead of the parsing. A snapshot is invalidated when the path, size, modification time or content hash of its clustering changes..  */
+        
+        
+          if (update_arg( (void *)&(args_info->cache_dir_arg), 
+               &(args_info->cache_dir_orig), &(args_info->cache_dir_given),
+              &(local_args_info.cache_dir_given), optarg, 0, 0, ARG_STRING,
+              check_ambiguity, override, 0, 0,
+              "cache-dir", 'C',
+              additional_error))
+            goto failure;
+        
           break;
         case 'd':	/* detailed (verbose) results output.  */
         
@@ -906,6 +1161,16 @@ cmdline_parser_internal (
               additional_error))
             goto failure;
         
+          break;
+        case 'b':	/* output labels (identifiers) of the evaluating clusters in the binary CSR format (.clb): the header followed by the offsets of the labels of each cluster and the ordered indices of the ground-truth clusters.  */
+        
+        
+          if (update_arg((void *)&(args_info->binary_labels_flag), 0, &(args_info->binary_labels_given),
+              &(local_args_info.binary_labels_given), optarg, 0, 0, ARG_FLAG,
+              check_ambiguity, override, 1, 0, "binary-labels", 'b',
+              additional_error))
+            goto failure;
+        
           break;
         case 'n':	/* evaluate NMI (Normalized Mutual Information), applicable only to the non-overlapping clusters.  */
         
@@ -937,6 +1202,39 @@ cmdline_parser_internal (
             goto failure;
         
           break;
+        case 'N':	/* evaluate overlapping NMI normalized by max (McDaid et al.) and LFK, applicable to the overlapping and multi-resolution clusters.  */
+        
+        
+          if (update_arg((void *)&(args_info->onmi_flag), 0, &(args_info->onmi_given),
+              &(local_args_info.onmi_given), optarg, 0, 0, ARG_FLAG,
+              check_ambiguity, override, 1, 0, "onmi", 'N',
+              additional_error))
+            goto failure;
+        
+          break;
+        case 'c':	/* convert the input CNL clustering to the binary clustering format (.cnb), which is loaded much faster than CNL and can be used instead of the CNL clustering in the evaluation.
+        NOTE: The 'unique' option is applied on the conversion..  */
+        
+        
+          if (update_arg( (void *)&(args_info->convert_arg), 
+               &(args_info->convert_orig), &(args_info->convert_given),
+              &(local_args_info.convert_given), optarg, 0, 0, ARG_STRING,
+              check_ambiguity, override, 0, 0,
+              "convert", 'c',
+              additional_error))
+            goto failure;
+        
+          break;
+        case 'z':	/* compress the node ids of the binary clustering by the delta-varint encoding of the sorted cluster members.  */
+        
+        
+          if (update_arg((void *)&(args_info->compress_flag), 0, &(args_info->compress_given),
+              &(local_args_info.compress_given), optarg, 0, 0, ARG_FLAG,
+              check_ambiguity, override, 1, 0, "compress", 'z',
+              additional_error))
+            goto failure;
+        
+          break;
 
         case 0:	/* Long option with no short option */
         case '?':	/* Invalid option.  */
@@ -31,7 +31,7 @@ extern "C" {
 
 #ifndef CMDLINE_PARSER_VERSION
 /** @brief the program version */
-#define CMDLINE_PARSER_VERSION "4.0.4"
+#define CMDLINE_PARSER_VERSION "4.3.0"
 #endif
 
 enum enum_f1 { f1__NULL = -1, f1_arg_partprob = 0, f1_arg_harmonic, f1_arg_average };
@@ -58,6 +58,31 @@ struct gengetopt_args_info
   float membership_arg;	/**< @brief average expected membership of the nodes in the clusters, > 0, typically >= 1. Used only to facilitate estimation of the nodes number on the containers preallocation if this number is not specified in the file header. (default='1').  */
   char * membership_orig;	/**< @brief average expected membership of the nodes in the clusters, > 0, typically >= 1. Used only to facilitate estimation of the nodes number on the containers preallocation if this number is not specified in the file header. original value given at command line.  */
   const char *membership_help; /**< @brief average expected membership of the nodes in the clusters, > 0, typically >= 1. Used only to facilitate estimation of the nodes number on the containers preallocation if this number is not specified in the file header. help description.  */
+  int string_ids_flag;	/**< @brief node ids are arbitrary tokens (e.g. URLs, user handles) interned into the dense internal ids shared by all input files. The whole member token is the id in this mode (the share part is not separated), binary clusterings and snapshots are not applicable. (default=off).  */
+  const char *string_ids_help; /**< @brief node ids are arbitrary tokens (e.g. URLs, user handles) interned into the dense internal ids shared by all input files. The whole member token is the id in this mode (the share part is not separated), binary clusterings and snapshots are not applicable. help description.  */
+  int batch_flag;	/**< @brief batch evaluation of the clusterings against the first one (ground-truth), which is loaded once. The clusterings are evaluated concurrently and their results are output in a single line per each clustering in the input order. A list of clusterings can be specified as @<filename> with a file name per line. The node base (sync) filters the ground-truth, which filters the evaluating clusterings. Labeling is not applicable in this mode. (default=off).  */
+  const char *batch_help; /**< @brief batch evaluation of the clusterings against the first one (ground-truth), which is loaded once. The clusterings are evaluated concurrently and their results are output in a single line per each clustering in the input order. A list of clusterings can be specified as @<filename> with a file name per line. The node base (sync) filters the ground-truth, which filters the evaluating clusterings. Labeling is not applicable in this mode. help description.  */
+  int prefetch_arg;	/**< @brief the number of clusterings loaded ahead of their evaluation per each worker in the batch mode, which bounds the memory consumption of the loading pipeline. 0 means the loading on demand. (default='1').  */
+  char * prefetch_orig;	/**< @brief the number of clusterings loaded ahead of their evaluation per each worker in the batch mode, which bounds the memory consumption of the loading pipeline. 0 means the loading on demand. original value given at command line.  */
+  const char *prefetch_help; /**< @brief the number of clusterings loaded ahead of their evaluation per each worker in the batch mode, which bounds the memory consumption of the loading pipeline. 0 means the loading on demand. help description.  */
+  char * pairwise_arg;	/**< @brief evaluate the symmetric matrix of each measure (MF1, NMI, ONMI, Omega Index) for all pairs of the clusterings, which are loaded once. The pairs are evaluated concurrently and the matrices are output to the specified file (stdout by default) in CSV. A list of clusterings can be specified as @<filename> with a file name per line. The node base (sync) filters each clustering. Labeling is not applicable in this mode..  */
+  char * pairwise_orig;	/**< @brief evaluate the symmetric matrix of each measure (MF1, NMI, ONMI, Omega Index) for all pairs of the clusterings, which are loaded once. The pairs are evaluated concurrently and the matrices are output to the specified file (stdout by default) in CSV. A list of clusterings can be specified as @<filename> with a file name per line. The node base (sync) filters each clustering. Labeling is not applicable in this mode. original value given at command line.  */
+  const char *pairwise_help; /**< @brief evaluate the symmetric matrix of each measure (MF1, NMI, ONMI, Omega Index) for all pairs of the clusterings, which are loaded once. The pairs are evaluated concurrently and the matrices are output to the specified file (stdout by default) in CSV. A list of clusterings can be specified as @<filename> with a file name per line. The node base (sync) filters each clustering. Labeling is not applicable in this mode. help description.  */
+  int binary_matrix_flag;	/**< @brief output the pairwise matrices in the binary format (.xpm): the header followed by the names of the measures, the row-major float64 matrix of each measure and the names of the clusterings (default=off).  */
+  const char *binary_matrix_help; /**< @brief output the pairwise matrices in the binary format (.xpm): the header followed by the names of the measures, the row-major float64 matrix of each measure and the names of the clusterings help description.  */
+  char * serve_arg;	/**< @brief serve the evaluation requests on the specified Unix domain socket keeping the ground-truth clusterings resident. Each request is a line: EVAL <ground-truth> <clustering | -> [--<option>[=<value>] ...], where '-' designates the inline CNL clustering following the request and terminated by the '.' line, and the options are the long options of the measures (replacing the server ones) and loading (ovp, unique, sync, membership); LOAD <ground-truth> [--<option> ...]; STATS; STOP. Each response is a line of the JSON object. The requests are served concurrently by the pool of workers..  */
+  char * serve_orig;	/**< @brief serve the evaluation requests on the specified Unix domain socket keeping the ground-truth clusterings resident. Each request is a line: EVAL <ground-truth> <clustering | -> [--<option>[=<value>] ...], where '-' designates the inline CNL clustering following the request and terminated by the '.' line, and the options are the long options of the measures (replacing the server ones) and loading (ovp, unique, sync, membership); LOAD <ground-truth> [--<option> ...]; STATS; STOP. Each response is a line of the JSON object. The requests are served concurrently by the pool of workers. original value given at command line.  */
+  const char *serve_help; /**< @brief serve the evaluation requests on the specified Unix domain socket keeping the ground-truth clusterings resident. Each request is a line: EVAL <ground-truth> <clustering | -> [--<option>[=<value>] ...], where '-' designates the inline CNL clustering following the request and terminated by the '.' line, and the options are the long options of the measures (replacing the server ones) and loading (ovp, unique, sync, membership); LOAD <ground-truth> [--<option> ...]; STATS; STOP. Each response is a line of the JSON object. The requests are served concurrently by the pool of workers. help description.  */
+  int budget_arg;	/**< @brief memory budget of the resident ground-truth clusterings in the serving mode, the least recently used clusterings exceeding the budget are evicted (default='4096').  */
+  char * budget_orig;	/**< @brief memory budget of the resident ground-truth clusterings in the serving mode, the least recently used clusterings exceeding the budget are evicted original value given at command line.  */
+  const char *budget_help; /**< @brief memory budget of the resident ground-truth clusterings in the serving mode, the least recently used clusterings exceeding the budget are evicted help description.  */
+  int wide_ids_flag;	/**< @brief node ids are 64-bit. Otherwise the 32-bit ids are used and the clusterings are reloaded with the 64-bit ones if their ids exceed the 32-bit range, which is not applicable for the streamed input. (default=off).  */
+  const char *wide_ids_help; /**< @brief node ids are 64-bit. Otherwise the 32-bit ids are used and the clusterings are reloaded with the 64-bit ones if their ids exceed the 32-bit range, which is not applicable for the streamed input. help description.  */
+  int prescan_flag;	/**< @brief count the nodes of the loaded clusterings before their indexing to preallocate the containers exactly if the number of nodes is not specified in the file header. The counts are cached in the <clustering>.cnt sidecar file, which is invalidated on the clustering modification. (default=off).  */
+  const char *prescan_help; /**< @brief count the nodes of the loaded clusterings before their indexing to preallocate the containers exactly if the number of nodes is not specified in the file header. The counts are cached in the <clustering>.cnt sidecar file, which is invalidated on the clustering modification. help description.  */
+  char * cache_dir_arg;	/**< @brief directory of the cached binary snapshots of the loaded CNL clusterings (typically the ground-truth evaluated many times), which are mapped instead of the parsing. A snapshot is invalidated when the path, size, modification time or content hash of its clustering changes..  */
+  char * cache_dir_orig;	/**< @brief directory of the cached binary snapshots of the loaded CNL clusterings (typically the ground-truth evaluated many times), which are mapped instead of the parsing. A snapshot is invalidated when the path, size, modification time or content hash of its clustering changes. original value given at command line.  */
+  const char *cache_dir_help; /**< @brief directory of the cached binary snapshots of the loaded CNL clusterings (typically the ground-truth evaluated many times), which are mapped instead of the parsing. A snapshot is invalidated when the path, size, modification time or content hash of its clustering changes. help description.  */
   int detailed_flag;	/**< @brief detailed (verbose) results output (default=off).  */
   const char *detailed_help; /**< @brief detailed (verbose) results output help description.  */
   int omega_flag;	/**< @brief evaluate Omega Index (a fuzzy version of the Adjusted Rand Index, identical to the Fuzzy Rand Index and on the non-overlapping clusterings equals to ARI). (default=off).  */
@@ -135,12 +160,24 @@ struct gengetopt_args_info
   const char *identifiers_help; /**< @brief output labels (identifiers) of the evaluating clusters as lines of space-separated indices of the ground-truth clusters (.cll - clusters labels list)
   NOTE: If 'sync' option is specified then the reduced collection is outputted to the <labels_filename>.cnl besides the <labels_filename>
  help description.  */
+  int binary_labels_flag;	/**< @brief output labels (identifiers) of the evaluating clusters in the binary CSR format (.clb): the header followed by the offsets of the labels of each cluster and the ordered indices of the ground-truth clusters (default=off).  */
+  const char *binary_labels_help; /**< @brief output labels (identifiers) of the evaluating clusters in the binary CSR format (.clb): the header followed by the offsets of the labels of each cluster and the ordered indices of the ground-truth clusters help description.  */
   int nmi_flag;	/**< @brief evaluate NMI (Normalized Mutual Information), applicable only to the non-overlapping clusters (default=off).  */
   const char *nmi_help; /**< @brief evaluate NMI (Normalized Mutual Information), applicable only to the non-overlapping clusters help description.  */
   int all_flag;	/**< @brief evaluate all NMIs using sqrt, avg and min denominators besides the max one (default=off).  */
   const char *all_help; /**< @brief evaluate all NMIs using sqrt, avg and min denominators besides the max one help description.  */
   int ln_flag;	/**< @brief use ln (exp base) instead of log2 (Shannon entropy, bits) for the information measuring (default=off).  */
   const char *ln_help; /**< @brief use ln (exp base) instead of log2 (Shannon entropy, bits) for the information measuring help description.  */
+  int onmi_flag;	/**< @brief evaluate overlapping NMI normalized by max (McDaid et al.) and LFK, applicable to the overlapping and multi-resolution clusters (default=off).  */
+  const char *onmi_help; /**< @brief evaluate overlapping NMI normalized by max (McDaid et al.) and LFK, applicable to the overlapping and multi-resolution clusters help description.  */
+  char * convert_arg;	/**< @brief convert the input CNL clustering to the binary clustering format (.cnb), which is loaded much faster than CNL and can be used instead of the CNL clustering in the evaluation.
+  NOTE: The 'unique' option is applied on the conversion..  */
+  char * convert_orig;	/**< @brief convert the input CNL clustering to the binary clustering format (.cnb), which is loaded much faster than CNL and can be used instead of the CNL clustering in the evaluation.
+  NOTE: The 'unique' option is applied on the conversion. original value given at command line.  */
+  const char *convert_help; /**< @brief convert the input CNL clustering to the binary clustering format (.cnb), which is loaded much faster than CNL and can be used instead of the CNL clustering in the evaluation.
+  NOTE: The 'unique' option is applied on the conversion. help description.  */
+  int compress_flag;	/**< @brief compress the node ids of the binary clustering by the delta-varint encoding of the sorted cluster members (default=off).  */
+  const char *compress_help; /**< @brief compress the node ids of the binary clustering by the delta-varint encoding of the sorted cluster members help description.  */
   
   unsigned int help_given ;	/**< @brief Whether help was given.  */
   unsigned int version_given ;	/**< @brief Whether version was given.  */
@@ -148,6 +185,16 @@ struct gengetopt_args_info
   unsigned int unique_given ;	/**< @brief Whether unique was given.  */
   unsigned int sync_given ;	/**< @brief Whether sync was given.  */
   unsigned int membership_given ;	/**< @brief Whether membership was given.  */
+  unsigned int string_ids_given ;	/**< @brief Whether string-ids was given.  */
+  unsigned int batch_given ;	/**< @brief Whether batch was given.  */
+  unsigned int prefetch_given ;	/**< @brief Whether prefetch was given.  */
+  unsigned int pairwise_given ;	/**< @brief Whether pairwise was given.  */
+  unsigned int binary_matrix_given ;	/**< @brief Whether binary-matrix was given.  */
+  unsigned int serve_given ;	/**< @brief Whether serve was given.  */
+  unsigned int budget_given ;	/**< @brief Whether budget was given.  */
+  unsigned int wide_ids_given ;	/**< @brief Whether wide-ids was given.  */
+  unsigned int prescan_given ;	/**< @brief Whether prescan was given.  */
+  unsigned int cache_dir_given ;	/**< @brief Whether cache-dir was given.  */
   unsigned int detailed_given ;	/**< @brief Whether detailed was given.  */
   unsigned int omega_given ;	/**< @brief Whether omega was given.  */
   unsigned int extended_given ;	/**< @brief Whether extended was given.  */
@@ -157,9 +204,13 @@ struct gengetopt_args_info
   unsigned int policy_given ;	/**< @brief Whether policy was given.  */
   unsigned int unweighted_given ;	/**< @brief Whether unweighted was given.  */
   unsigned int identifiers_given ;	/**< @brief Whether identifiers was given.  */
+  unsigned int binary_labels_given ;	/**< @brief Whether binary-labels was given.  */
   unsigned int nmi_given ;	/**< @brief Whether nmi was given.  */
   unsigned int all_given ;	/**< @brief Whether all was given.  */
   unsigned int ln_given ;	/**< @brief Whether ln was given.  */
+  unsigned int onmi_given ;	/**< @brief Whether onmi was given.  */
+  unsigned int convert_given ;	/**< @brief Whether convert was given.  */
+  unsigned int compress_given ;	/**< @brief Whether compress was given.  */
 
   char **inputs ; /**< @brief unnamed options (options without names) */
   unsigned inputs_num ; /**< @brief unnamed options number */
@@ -13,9 +13,11 @@
 
 #include <unordered_map>
 #include <memory>  // unique_ptr
+#include <functional>
 #include <string>
 #include <type_traits>
 #include <limits>
+#include <algorithm>  // max
 #if VALIDATE >= 1
 #include <stdexcept>
 #endif // VALIDATE
@@ -37,6 +39,7 @@ using std::unordered_map;
 using std::unique_ptr;
 using std::string;
 using std::pair;
+using std::move;
 using std::is_integral;
 using std::is_pointer;
 using std::is_floating_point;
@@ -49,17 +52,42 @@ using std::numeric_limits;
 #if VALIDATE >= 2
 using std::invalid_argument;
 #endif // VALIDATE
+using daoc::MappedFile;
+using daoc::LineReader;
+
+// Note: the interface is instantiated for the 64-bit node ids in the dedicated
+// namespace to be linked together with the default (32-bit) instantiation
+#ifdef ID64
+namespace id64 {
+#endif // ID64
 
 // Data Types ------------------------------------------------------------------
+#ifdef ID64
+using Id = uint64_t;  //!< Node id type
+// Note: Size should a magnitude larger than Id to hold Id*Id
+using AccId = unsigned __int128;  //!< Accumulated Id type
+#else
 using Id = uint32_t;  //!< Node id type
 // Note: Size should a magnitude larger than Id to hold Id*Id
 using AccId = uint64_t;  //!< Accumulated Id type
+#endif // ID64
 
 using Prob = float;  //!< Probability
 using AccProb = double;  //!< Accumulated Probability
 
 //! Aggregated Hash of the loading cluster member ids
 using AggHash = daoc::AggHash<Id, AccId>;
+#ifdef ID64
+}  // id64
+
+// Note: the global alias is required for the qualified ::AggHash, which resolves
+// the ambiguity with daoc::AggHash in the translation units using daoc namespace
+using id64::AggHash;
+
+namespace id64 {
+#endif // ID64
+
+using Interner = daoc::IdInterner<Id>;  //!< Interner of the string node ids
 
 using RawIds = vector<Id>;  //!< Node ids, unordered
 
@@ -81,6 +109,33 @@ using NodeRClusters = unordered_map<Id, pair<RawClusterPtrs, RawClusterPtrs>>;
 template <bool EXT=false>
 Prob omega(const NodeRClusters& ndrcs, const RawClusters& cls1, const RawClusters& cls2);
 
+//! Membership degrees of the node in its owner clusters: pairs of the cluster
+//! index and the degree E (0, 1], ordered by the cluster indices
+using RawDegrees = vector<pair<Id, Prob>>;
+//! Raw node membership degrees in the clusters of both collections
+using NodeRDegrees = unordered_map<Id, pair<RawDegrees, RawDegrees>>;
+
+//! Quantization of the weighted co-memberships to evaluate the expected agreement
+constexpr unsigned  omegaQuant = 32;
+
+//! \brief Weighted (fuzzy) Omega Index evaluation
+//! \note The co-membership of a pair of nodes is the sum of products of their
+//! membership degrees in the mutual clusters. The co-memberships of the pair
+//! in both collections agree by max(0, 1 - |difference|). The expected agreement
+//! is evaluated on the co-memberships quantized by 1/omegaQuant. The unit degrees
+//! (equal shares) yield the integral co-memberships, so the value is the same as
+//! omega() yields for the respective crisp clusters.
+//!
+//! \tparam EXT bool  - extended Omega Index, which does not excessively penalize
+//! 	distinct node shares
+//!
+//! \param nddgs const NodeRDegrees&  - node membership degrees in the clusters
+//! \param clsnum1 Id  - the number of clusters in the first collection
+//! \param clsnum2 Id  - the number of clusters in the second collection
+//! \return Prob  - omega index
+template <bool EXT=false>
+Prob omega(const NodeRDegrees& nddgs, Id clsnum1, Id clsnum2);
+
 //! \brief Evaluate the number of mutual raw cluster pointers in the containers
 //!
 //! \pre Input raw clusters pointer containers are ordered by the cmpBase<RawCluster*>
@@ -171,16 +226,13 @@ struct Cluster {
 	using CountT = Count;  //!< Count type, arithmetic
 
 	RawIds  members;  //!< Node ids, unordered
-	// Note: used by F1 only and always
-	Counter<Count>  counter;  //!< Cluster matching counter
-	////! Accumulated contribution
-	//using AccCont = conditional_t<m_overlaps, Count, AccId>;
-	//!< Contribution from members
-	// Note: used only in case of a) overlaps (by all measures) or
-	// b) multiple resolutions (by NMI only)
-	Count  mbscont;
-	static_assert(!is_floating_point<Count>::value || sizeof(mbscont) >= sizeof(double)
-		, "operator(), types validation failed");
+	//! Shares of the members in the cluster aligned with them, held only for the
+	//! overlaps to not lookup the member owners on the evaluation
+	vector<AccProb>  shares;
+	//! Index of the cluster in its collection, assigned on the loading
+	// Note: the evaluation state of the cluster (matching counter and members
+	// contribution) is held by the collection by this index
+	Id  index;
 
     //! Default constructor
 	Cluster();
@@ -190,8 +242,10 @@ struct Cluster {
     //!
     //! \param matches Count  - the number of matched members
     //! \param capacity Count  - contributions capacity of the matching foreign cluster
+    //! \param cont Count  - members contribution of this cluster, actual only
+    //! 	for the floating point counting
     //! \return AccProb  - resulting F1
-	AccProb f1(Count matches, Count capacity) const
+	AccProb f1(Count matches, Count capacity, Count cont) const
 #if VALIDATE < 2
 	noexcept
 #endif // VALIDATE
@@ -202,7 +256,7 @@ struct Cluster {
 		// F1 = 2 * m/c1 * m/c2 / (m/c1 + m/c2) = 2 * m / (c2 + c1)
 		// ATTENTION: F1 compares clusters per-pair, so it is much simpler and has another
 		// semantics of contribution for the multi-resolution case
-		const Count  contrib = is_floating_point<Count>::value ? cont() : members.size();
+		const Count  contrib = is_floating_point<Count>::value ? cont : members.size();
 #if VALIDATE >= 2
 		if(matches < 0 || daoc::less<conditional_t<is_floating_point<Count>::value
 		, Prob, Count>>(capacity, matches) || contrib <= 0)
@@ -223,8 +277,10 @@ struct Cluster {
     //!
     //! \param matches Count  - the number of matched members
     //! \param capacity Count  - contributions capacity of the matching foreign cluster
+    //! \param cont Count  - members contribution of this cluster, actual only
+    //! 	for the floating point counting
     //! \return AccProb  - resulting probability
-	AccProb pprob(Count matches, Count capacity) const
+	AccProb pprob(Count matches, Count capacity, Count cont) const
 #if VALIDATE < 2
 	noexcept
 #endif // VALIDATE
@@ -233,9 +289,9 @@ struct Cluster {
 		// where nodes contribution instead of the size should be used for overlaps.
 		// ATTENTION: F1 compares clusters per-pair, so it is much simpler and has another
 		// semantics of contribution for the multi-resolution case comparing to NMI
-		// that also uses cont()
+		// that also uses the members contribution
 		constexpr bool  floating = is_floating_point<Count>::value;
-		const Count  contrib = floating ? cont() : members.size();
+		const Count  contrib = floating ? cont : members.size();
 #if VALIDATE >= 2
 		if(matches < 0 || daoc::less<conditional_t<floating, Prob, Count>>
 		(capacity, matches) || contrib <= 0)
@@ -247,15 +303,6 @@ struct Cluster {
 			: static_cast<AccProb>(static_cast<AccId>(matches) * matches)
 				/ (static_cast<AccId>(capacity) * contrib);  // E [0, 1]
 	}
-
-    //! \brief Cluster members contribution
-    //!
-    //! \return Count  - total contribution from the members
-	Count cont() const noexcept
-	{
-//		return is_same<decltype(mbscont), EmptyStub>::value ? members.size() : mbscont;
-		return mbscont;
-	}
 };
 
 //! Automatic storage for the Cluster;
@@ -268,10 +315,313 @@ using ClusterHolder = unique_ptr<Cluster<Count>>;
 template <typename Count>
 using ClusterPtrs = vector<Cluster<Count>*>;
 
+//! Shares of the node in its owner clusters (fuzzy memberships)
+using Shares = vector<Prob>;
+
+//! Owner clusters of the node with the node shares in them
+//! \tparam Count  - arithmetic counting type
+template <typename Count>
+struct SharedClusters: ClusterPtrs<Count> {
+	//! Shares of the node in the owner clusters ordered by the owners and
+	//! summing to 1, empty for the equal shares to avoid their storage
+	Shares  shares;
+
+    //! \brief Default constructor
+	SharedClusters(): ClusterPtrs<Count>(), shares()  {}
+
+    //! \brief Share of the node in the owner cluster
+    //!
+    //! \param i size_t  - index of the owner cluster
+    //! \return AccProb  - the share E (0, 1]
+	AccProb share(size_t i) const noexcept
+	{
+		return shares.empty() ? AccProb(1) / this->size() : shares[i];
+	}
+
+    //! \brief Share of the node in the owner cluster
+    //! \pre The cluster is an owner of the node
+    //!
+    //! \param cl const Cluster<Count>*  - the owner cluster
+    //! \return AccProb  - the share E (0, 1]
+	AccProb share(const Cluster<Count>* cl) const noexcept
+	{
+		if(shares.empty())
+			return AccProb(1) / this->size();
+		return shares[std::find(this->begin(), this->end(), cl) - this->begin()];
+	}
+
+    //! \brief Normalize the (weighted) shares to sum up to 1, the equal shares
+    //! are dropped
+    //!
+    //! \return void
+	void normalize()
+	{
+		if(!shares.empty()) {
+			const auto  mm = std::minmax_element(shares.begin(), shares.end());
+			if(*mm.first < *mm.second) {
+				AccProb  sum = 0;
+				for(auto sh: shares)
+					sum += sh;
+				for(auto& sh: shares)
+					sh /= sum;
+				shares.shrink_to_fit();
+				return;
+			}
+		}
+		shares.clear();
+		shares.shrink_to_fit();
+	}
+};
+
+//! Hash map partitioned by the keys into the independent hash maps, which
+//! can be built concurrently (each partition by a single worker)
+//! \note The integral keys are partitioned by the modulo, so the keys of each
+//! partition are still uniformly distributed among the prime number of its buckets
+//! \tparam Key  - integral key type
+//! \tparam Value  - value type
+template <typename Key, typename Value>
+class PartitionedMap {
+public:
+	using Part = unordered_map<Key, Value>;  //!< Partition of the map
+	using key_type = Key;
+	using mapped_type = Value;
+	using value_type = typename Part::value_type;
+	using size_type = size_t;
+
+	//! Forward iterator over the items of all partitions
+	//! \tparam CONST  - whether the iterator is constant
+	template <bool CONST>
+	class Iterator {
+		friend class PartitionedMap;
+		using Parts = conditional_t<CONST, const vector<Part>, vector<Part>>;
+		using PartIter = conditional_t<CONST, typename Part::const_iterator, typename Part::iterator>;
+
+		Parts*  m_parts;  //!< Partitions of the map
+		size_t  m_ip;  //!< Index of the iterating partition, the number of partitions for the end
+		PartIter  m_it;  //!< Iterator in the partition
+
+        //! \brief Constructor
+        //!
+        //! \param parts Parts*  - partitions of the map
+        //! \param ip size_t  - index of the partition
+        //! \param it PartIter  - iterator in the partition, which is moved to
+        //! the next non-empty partition on the end
+		Iterator(Parts* parts, size_t ip, PartIter it): m_parts(parts), m_ip(ip), m_it(it)
+		{
+			while(m_ip < m_parts->size() && m_it == (*m_parts)[m_ip].end())
+				if(++m_ip < m_parts->size())
+					m_it = (*m_parts)[m_ip].begin();
+		}
+	public:
+		using iterator_category = std::forward_iterator_tag;
+		using value_type = typename Part::value_type;
+		using difference_type = ptrdiff_t;
+		using pointer = conditional_t<CONST, const value_type*, value_type*>;
+		using reference = conditional_t<CONST, const value_type&, value_type&>;
+
+        //! \brief Default constructor
+		Iterator(): m_parts(nullptr), m_ip(0), m_it()  {}
+
+		Iterator(const Iterator&)=default;
+		Iterator& operator=(const Iterator&)=default;
+
+		reference operator*() const  { return *m_it; }
+		pointer operator->() const  { return &*m_it; }
+
+		Iterator& operator++()
+		{
+			if(++m_it == (*m_parts)[m_ip].end())
+				*this = Iterator(m_parts, m_ip, m_it);
+			return *this;
+		}
+
+		Iterator operator++(int)  { Iterator  it = *this; ++*this; return it; }
+
+		bool operator==(const Iterator& it) const noexcept
+		{
+			return m_ip == it.m_ip && (!m_parts || m_ip >= m_parts->size() || m_it == it.m_it);
+		}
+
+		bool operator!=(const Iterator& it) const noexcept  { return !(*this == it); }
+	};
+
+	using iterator = Iterator<false>;
+	using const_iterator = Iterator<true>;
+
+    //! \brief Default constructor of the single partition map
+	PartitionedMap(): m_parts(1)  {}
+
+    //! \brief Move constructor
+    //! \note The source is left without partitions, being valid only for the
+    //! destruction, assignment, partition(), iteration and size queries
+	PartitionedMap(PartitionedMap&&) noexcept=default;
+
+	PartitionedMap(const PartitionedMap&)=default;
+	PartitionedMap& operator=(const PartitionedMap&)=default;
+
+    //! \brief Move assignment
+	PartitionedMap& operator=(PartitionedMap&& pm) noexcept  { m_parts.swap(pm.m_parts); return *this; }
+
+    //! \brief Split the map into the partitions preserving the reserved capacity
+    //! \pre The map is empty
+    //!
+    //! \param pnum size_t  - the number of partitions, >= 1
+    //! \return void
+	void partition(size_t pnum)
+	{
+		const size_t  cap = bucket_count() * max_load_factor();
+		m_parts = vector<Part>(std::max<size_t>(pnum, 1));
+		reserve(cap);
+	}
+
+    //! \brief The number of partitions
+	size_t partsnum() const noexcept  { return m_parts.size(); }
+
+    //! \brief Index of the partition holding the key
+	size_t partOf(const Key& key) const noexcept
+	{
+		return m_parts.size() == 1 ? 0 : key % m_parts.size();
+	}
+
+    //! \brief Partition of the map
+	Part& part(size_t ip) noexcept  { return m_parts[ip]; }
+
+	size_t size() const noexcept
+	{
+		size_t  num = 0;
+		for(const auto& pt: m_parts)
+			num += pt.size();
+		return num;
+	}
+
+	bool empty() const noexcept  { return !size(); }
+
+	size_t bucket_count() const noexcept
+	{
+		size_t  num = 0;
+		for(const auto& pt: m_parts)
+			num += pt.bucket_count();
+		return num;
+	}
+
+	float max_load_factor() const noexcept
+	{
+		return !m_parts.empty() ? m_parts.front().max_load_factor() : 1;
+	}
+
+    //! \brief Reserve the capacity distributing it among the partitions
+	void reserve(size_t num)
+	{
+		for(auto& pt: m_parts)
+			pt.reserve(num / m_parts.size() + (num % m_parts.size() != 0));
+	}
+
+	void rehash(size_t num)
+	{
+		for(auto& pt: m_parts)
+			pt.rehash(num / m_parts.size());
+	}
+
+	void clear() noexcept
+	{
+		for(auto& pt: m_parts)
+			pt.clear();
+	}
+
+	Value& operator[](const Key& key)  { return m_parts[partOf(key)][key]; }
+	Value& at(const Key& key)  { return m_parts[partOf(key)].at(key); }
+	const Value& at(const Key& key) const  { return m_parts[partOf(key)].at(key); }
+	size_t count(const Key& key) const  { return m_parts[partOf(key)].count(key); }
+	size_t erase(const Key& key)  { return m_parts[partOf(key)].erase(key); }
+
+	template <typename... Args>
+	pair<iterator, bool> emplace(const Key& key, Args&&... args)
+	{
+		const size_t  ip = partOf(key);
+		const auto  res = m_parts[ip].emplace(key, std::forward<Args>(args)...);
+		return {iterator(&m_parts, ip, res.first), res.second};
+	}
+
+	iterator find(const Key& key)
+	{
+		const size_t  ip = partOf(key);
+		const auto  it = m_parts[ip].find(key);
+		return it != m_parts[ip].end() ? iterator(&m_parts, ip, it) : end();
+	}
+
+	const_iterator find(const Key& key) const
+	{
+		const size_t  ip = partOf(key);
+		const auto  it = m_parts[ip].find(key);
+		return it != m_parts[ip].end() ? const_iterator(&m_parts, ip, it) : end();
+	}
+
+	// Note: the partition iterator of end() is not compared, so it is not bound
+	iterator begin()  { return !m_parts.empty() ? iterator(&m_parts, 0, m_parts.front().begin()) : end(); }
+	iterator end()  { return iterator(&m_parts, m_parts.size(), typename Part::iterator()); }
+	const_iterator begin() const
+	{
+		return !m_parts.empty() ? const_iterator(&m_parts, 0, m_parts.front().begin()) : end();
+	}
+	const_iterator end() const  { return const_iterator(&m_parts, m_parts.size(), typename Part::const_iterator()); }
+private:
+	vector<Part>  m_parts;  //!< Partitions of the map, at least one unless moved out
+};
+
 //! Node to clusters relations
+//! \note The node shares are stored only for the overlaps (floating point
+//! counting), the multi-resolution relations are the plain clusters.
+//! The relations are partitioned by the node ids to be indexed concurrently.
 //! \tparam Count  - arithmetic counting type
 template <typename Count>
-using NodeClusters = unordered_map<Id, ClusterPtrs<Count>>;
+using NodeClusters = PartitionedMap<Id, conditional_t<is_floating_point<Count>::value
+	, SharedClusters<Count>, ClusterPtrs<Count>>>;
+
+//! \brief Share of the node in the owner cluster
+//! \note The node of multiple resolutions is entirely contained in each owner
+//!
+//! \param ncs const ClusterPtrs<Count>&  - owner clusters of the node
+//! \param i size_t  - index of the owner cluster
+//! \return AccProb  - the share E (0, 1]
+template <typename Count>
+inline AccProb nodeShare(const ClusterPtrs<Count>&, size_t) noexcept  { return 1; }
+
+//! \copydoc SharedClusters::share(size_t) const
+template <typename Count>
+inline AccProb nodeShare(const SharedClusters<Count>& ncs, size_t i) noexcept  { return ncs.share(i); }
+
+//! \brief Share of the node in the owner cluster
+//!
+//! \param ncs const ClusterPtrs<Count>&  - owner clusters of the node
+//! \param cl const Cluster<Count>*  - the owner cluster
+//! \return AccProb  - the share E (0, 1]
+template <typename Count>
+inline AccProb nodeShare(const ClusterPtrs<Count>&, const Cluster<Count>*) noexcept  { return 1; }
+
+//! \copydoc SharedClusters::share(const Cluster<Count>*) const
+template <typename Count>
+inline AccProb nodeShare(const SharedClusters<Count>& ncs, const Cluster<Count>* cl) noexcept  { return ncs.share(cl); }
+
+//! \brief Copy the node shares if both owners hold them
+//!
+//! \param dst ClusterPtrs<Dst>&  - destination owners
+//! \param src const ClusterPtrs<Src>&  - source owners
+//! \return void
+template <typename Dst, typename Src>
+inline void copyShares(ClusterPtrs<Dst>&, const ClusterPtrs<Src>&) noexcept  {}
+
+template <typename Dst, typename Src>
+inline void copyShares(SharedClusters<Dst>& dst, const SharedClusters<Src>& src)  { dst.shares = src.shares; }
+
+//! \brief Memory consumed by the node shares
+//!
+//! \param ncs const ClusterPtrs<Count>&  - owner clusters of the node
+//! \return size_t  - the consumed memory, bytes
+template <typename Count>
+inline size_t sharesMem(const ClusterPtrs<Count>&) noexcept  { return 0; }
+
+template <typename Count>
+inline size_t sharesMem(const SharedClusters<Count>& ncs) noexcept  { return ncs.shares.capacity() * sizeof(Prob); }
 
 //! Resulting greatest matches for 2 input collections of clusters in a single direction
 using Probs = vector<Prob>;
@@ -455,7 +805,137 @@ struct RawNmi {
 	};
 };
 
+//! Overlapping NMI (McDaid's and LFK normalizations) of two collections
+struct RawOnmi {
+	Prob  mi;  //!< Mutual information of two collections by McDaid et al.
+	Prob  h1;  //!< Information content of the 1-st collection (sum of the clusters entropies)
+	Prob  h2;  //!< Information content of the 2-nd collection (sum of the clusters entropies)
+	Prob  lfk;  //!< NMI_lfk by Lancichinetti, Fortunato and Kertesz
+
+	static_assert(is_floating_point<Prob>::value, "RawOnmi, Prob should be a floating point type");
+	RawOnmi() noexcept: mi(0), h1(numeric_limits<Prob>::quiet_NaN())
+		, h2(numeric_limits<Prob>::quiet_NaN()), lfk(0)  {}
+
+    //! \brief NMI_max by McDaid, Greene and Hurley
+    //!
+    //! \return Prob  - mutual information normalized by the max information content
+	Prob nmax() const noexcept
+	{
+		const Prob  hmax = std::max(h1, h2);
+		return hmax > 0 ? mi / hmax : 0;
+	}
+};
+
+//! Conditional entropy of a collection given another collection,
+//! the intermediate result of the overlapping NMI evaluation
+struct CondEntropy {
+	AccProb  h;  //!< Information content of the collection, sum of H(X_k)
+	AccProb  hc;  //!< Conditional entropy H(X|Y), sum of H(X_k|Y)
+	AccProb  hcn;  //!< Sum of the normalized conditional entropies H(X_k|Y) / H(X_k)
+
+	CondEntropy() noexcept: h(0), hc(0), hcn(0)  {}
+};
+
+// Binary clustering format (CNB) ---------------------------------------------
+//! Header of the binary clustering (.cnb), which is followed by the offsets of
+//! the clusters (uint64_t x (clsnum + 1)) and the members payload.
+//! Each member is stored as Id, or the members of each cluster are sorted and
+//! stored as LEB128 varint deltas if CNB_DELTA flag is set, in which case the
+//! offsets are in bytes rather than in members.
+//! The members payload is followed by the node memberships index if CNB_INDEX
+//! flag is set: the ordered node ids (Id x ndsnum), offsets of their clusters
+//! (uint64_t x (ndsnum + 1)) and the cluster indices (Id x mbsnum).
+//! \note All values have the host byte order
+struct CnbHeader {
+	constexpr static char  MAGIC[4] = {'X', 'C', 'N', 'B'};  //!< File signature
+	constexpr static uint16_t  VERSION = 2;  //!< Current format version
+	// Flags
+	constexpr static uint8_t  CNB_DELTA = 0x1;  //!< The members are delta-varint encoded
+	constexpr static uint8_t  CNB_UNIQUE = 0x2;  //!< Each cluster contains unique members
+	constexpr static uint8_t  CNB_INDEX = 0x4;  //!< The node memberships index is stored
+
+	//! \brief The number of bytes in the node memberships index
+	//!
+	//! \tparam Id  - node id type
+	//! \return size_t  - the index size in bytes, 0 if the index is omitted
+	template <typename Id>
+	size_t indexbytes() const noexcept
+	{
+		return flags & CNB_INDEX ? (ndsnum + mbsnum) * sizeof(Id)
+			+ (ndsnum + 1) * sizeof(uint64_t) : 0;
+	}
+
+	char  magic[4];  //!< File signature, MAGIC
+	uint16_t  version;  //!< Format version
+	uint8_t  idbytes;  //!< Size of the node id in bytes
+	uint8_t  flags;  //!< Format flags
+	uint64_t  clsnum;  //!< The number of clusters
+	uint64_t  ndsnum;  //!< The number of unique nodes
+	uint64_t  mbsnum;  //!< The number of members in all clusters
+	uint64_t  hsize;  //!< The number of ids in AggHash of the node base
+	uint64_t  hidsum;  //!< Sum of ids in AggHash of the node base
+	uint64_t  hid2sum;  //!< Sum of squared ids in AggHash of the node base
+	uint64_t  mbsbytes;  //!< The number of bytes in the members payload
+};
+static_assert(sizeof(CnbHeader) == 64, "CnbHeader should not have the padding");
+
+//! Header of the binary clusters labels (.clb) in the CSR format, which is followed
+//! by the offsets of the labels of each evaluating cluster (uint64_t x (clsnum + 1))
+//! and the ordered indices of the ground-truth clusters (Id x mrksnum).
+//! The non-labeled clusters have empty ranges of the labels.
+//! \note All values have the host byte order
+struct ClbHeader {
+	constexpr static char  MAGIC[4] = {'X', 'C', 'L', 'B'};  //!< File signature
+	constexpr static uint16_t  VERSION = 1;  //!< Current format version
+
+	char  magic[4];  //!< File signature, MAGIC
+	uint16_t  version;  //!< Format version
+	uint8_t  idbytes;  //!< Size of the cluster index in bytes
+	uint8_t  flags;  //!< Format flags, reserved
+	uint64_t  clsnum;  //!< The number of evaluating (labeled) clusters
+	uint64_t  lbsnum;  //!< The number of labels (ground-truth clusters)
+	uint64_t  mrksnum;  //!< The number of labels assigned to all clusters
+};
+static_assert(sizeof(ClbHeader) == 32, "ClbHeader should not have the padding");
+
+// Members deduplication -------------------------------------------------------
+//! Generation-stamped marks of the seen node ids to remove the duplicated
+//! members of a cluster in a single pass without the sorting
+//! \note The stamps cover dense ids, their size is bounded by the number of the
+//! processed members. Clusters having sparse ids are deduplicated by the sorting.
+class SeenIds {
+	vector<uint32_t>  m_stamps;  //!< Generation of the last occurrence of each id
+	uint32_t  m_gen;  //!< Current generation, a distinct one for each cluster
+	size_t  m_mbsnum;  //!< The number of processed members
+public:
+    //! \brief Default constructor
+	SeenIds() noexcept: m_stamps(), m_gen(0), m_mbsnum(0)  {}
+
+    //! \brief Remove the duplicated members
+    //!
+    //! \param members RawIds&  - members of the cluster, the first occurrences
+    //! 	are retained in their order for the dense ids, the sparse ids are ordered
+    //! \param[out] idmax Id&  - max member id, 0 for the empty members
+    //! \return size_t  - the number of removed duplicates
+	size_t dedup(RawIds& members, Id& idmax);
+
+    //! \brief The instance of the calling thread
+    //!
+    //! \return SeenIds&  - the thread local instance
+	static SeenIds& local()
+	{
+		thread_local SeenIds  seen;
+		return seen;
+	}
+};
+
 // Collection ------------------------------------------------------------------
+struct NodeBaseI;
+
+//! Node base fetcher for the pipelined loading, which can block until the node
+//! base is ready and returns nullptr if the node base is omitted
+using NodeBaseFetcher = std::function<const NodeBaseI*()>;
+
 //! Unique ids (node ids)
 using UniqIds = unordered_set<Id>;
 
@@ -482,26 +962,62 @@ struct NodeBaseI {
 
 	//! \brief Nodebase content
 	//!
-	//! \return virtual const UniqIds&  - nodebase content
-	virtual const UniqIds& nodes() const noexcept = 0;
+	//! \return virtual const RawIds&  - nodebase content, ordered unique ids
+	virtual const RawIds& nodes() const noexcept = 0;
 };
 
 //! Node base
-struct NodeBase: protected UniqIds, NodeBaseI {
-	using UniqIds::clear;
-	using UniqIds::reserve;
-	using UniqIds::insert;
-	using UniqIds::begin;
-	using UniqIds::end;
+//! \note The nodes are held as the ordered unique ids. The node existence is
+//! checked by the bitmap over the ids range if the ids are dense, otherwise by
+//! the branchless search in the Eytzinger (BFS) layout of the ids, which costs
+//! about one cache line per lookup in both cases.
+class NodeBase: public NodeBaseI {
+	RawIds  m_ids;  //!< Ordered unique node ids
+	vector<uint64_t>  m_bits;  //!< Bitmap of the node ids if they are dense, empty otherwise
+	//! Eytzinger layout of the node ids (1-based, [0] is unused) if they are sparse,
+	//! empty otherwise
+	RawIds  m_eytz;
+public:
+    //! \brief Default constructor
+	NodeBase() noexcept: m_ids(), m_bits(), m_eytz()  {}
 
-	//! \copydoc NodeBaseI::nodeExists(Id nid) const noexcept
-	Id ndsnum() const noexcept override  { return size(); }
+    //! \brief Constructor
+    //!
+    //! \param ids RawIds&&  - node ids, which are ordered and deduplicated if required
+	explicit NodeBase(RawIds&& ids)
+	: NodeBase()  { assign(std::move(ids)); }
+
+    //! \brief Assign the node ids
+    //!
+    //! \param ids RawIds&&  - node ids, which are ordered and deduplicated if required
+    //! \return void
+	void assign(RawIds&& ids);
+
+    //! \brief Release the node ids
+    //!
+    //! \return void
+	void clear() noexcept;
+
+	//! \copydoc NodeBaseI::ndsnum() const noexcept
+	Id ndsnum() const noexcept override  { return m_ids.size(); }
 
 	//! \copydoc NodeBaseI::nodeExists(Id nid) const noexcept
-	bool nodeExists(Id nid) const noexcept override  { return count(nid); }
+	bool nodeExists(Id nid) const noexcept override
+	{
+		if(!m_bits.empty())
+			return nid / 64 < m_bits.size() && (m_bits[nid / 64] >> nid % 64 & 1);
+		// Note: the descent is branchless, the index of the last greater or equal
+		// element is restored by skipping the trailing right turns
+		const size_t  num = m_ids.size();
+		size_t  k = 1;
+		while(k <= num)
+			k = 2 * k + (m_eytz[k] < nid);
+		k >>= trailingOnes(k) + 1;
+		return k && m_eytz[k] == nid;
+	}
 
 	//! \copydoc NodeBaseI::nodes() const noexcept
-	const UniqIds& nodes() const noexcept override  { return *this; }
+	const RawIds& nodes() const noexcept override  { return m_ids; }
 
 #ifndef NO_FILEIO
 	//! \brief Load all unique nodes from the CNL file with optional filtering by the cluster size
@@ -515,10 +1031,36 @@ struct NodeBase: protected UniqIds, NodeBaseI {
 	//! \param cmin=0 size_t  - min allowed cluster size
 	//! \param cmax=0 size_t  - max allowed cluster size, 0 means any size
     //! \param verbose=false bool  - print intermediate results to the stdout
+	//! \param strids=nullptr Interner*  - interner of the string node ids,
+	//! 	the members are numeric ids if nullptr
     //! \return bool  - the collection is loaded successfully
 	static NodeBase load(const char* filename, float membership=1
-		, AggHash* ahash=nullptr, size_t cmin=0, size_t cmax=0, bool verbose=false);
+		, AggHash* ahash=nullptr, size_t cmin=0, size_t cmax=0, bool verbose=false
+		, Interner* strids=nullptr);
 #endif // NO_FILEIO
+private:
+    //! \brief The number of trailing one bits
+    //!
+    //! \param val size_t  - the value
+    //! \return unsigned  - the number of trailing ones
+	static unsigned trailingOnes(size_t val) noexcept
+	{
+#ifdef __GNUC__
+		return __builtin_ctzll(~static_cast<unsigned long long>(val));
+#else
+		unsigned  num = 0;
+		for(; val & 1; val >>= 1)
+			++num;
+		return num;
+#endif // __GNUC__
+	}
+
+    //! \brief Fill the Eytzinger layout from the ordered ids
+    //!
+    //! \param k size_t  - the current (1-based) index in the layout
+    //! \param i size_t&  - the index of the next ordered id
+    //! \return void
+	void fillEytzinger(size_t k, size_t& i) noexcept;
 };
 
 //template <typename Iter>
@@ -598,13 +1140,6 @@ struct PrcRec {
 	PrcRec(Prob prc=0, Prob rec=0): prc(prc), rec(rec)  {}
 };
 
-#ifdef C_API
-template <typename Count>
-class Collection;
-
-Collection<Id> loadCollection(const ClusterCollection rcn, bool makeunique
-	, float membership, ::AggHash* ahash, const NodeBaseI* nodebase, RawIds* lostcls, bool verbose);
-#endif // C_API
 
 //! Collection describing cluster-node relations
 //! \tparam Count  - arithmetic counting type
@@ -615,34 +1150,68 @@ public:
 	//! Overlaps / multi-resolutions evaluation flag
 	constexpr static bool  m_overlaps = is_floating_point<Count>::value;
 	//! Accumulated contribution
-	using AccCont = conditional_t<m_overlaps, Count, AccId>;
+	// Note: the contributions are bound by the number of members, which fits uint64_t
+	// unlike the squared ids accumulated by AccId
+	using AccCont = conditional_t<m_overlaps, Count, uint64_t>;
 	//! Clusters matching matrix
 	using ClustersMatching = SparseMatrix<Cluster<Count>*, AccCont>;  // Used only for NMI
 	using ClsLabels = ClustersLabels<Count>;
 
 #ifdef C_API
-	friend Collection<Id> loadCollection(const ClusterCollection rcn, bool makeunique, float membership
-		, ::AggHash* ahash, const NodeBaseI* nodebase, bool reduce, RawIds* lostcls, bool verbose);
+	template <typename C>
+	friend Collection<C> loadClusters(const ClusterCollection rcn, bool makeunique, float membership
+		, ::AggHash* ahash, const NodeBaseI* nodebase, bool reduce, RawIds* lacking
+		, RawIds* lostcls, bool verbose);
+	template <typename C>
+	friend class CollectionComplement;
 #endif // C_API
+	// Note: the collections of distinct counting are cloned one from another
+	template <typename C>
+	friend class Collection;
 private:
-	// ATTENTNION: Collection manages the memory of the m_cls
+	// ATTENTNION: Collection manages the memory of the m_cls unless they are shared
 	ClusterPtrs<Count>  m_cls;  //!< Clusters
-	NodeClusters<Count>  m_ndcs;  //!< Node clusters relations
+	NodeClusters<Count>  m_ndcs;  //!< Node clusters relations, empty if shared
 	size_t  m_ndshash;  //!< Nodes hash (of unique node ids only, not all members), 0 means was not evaluated
+	//! Origin collection owning the shared clusters and node clusters relations,
+	//! nullptr if they are owned by this collection
+	const Collection*  m_origin;
+	// Note: the evaluation state is held apart from the clusters by their
+	// indices to evaluate the shared clusters concurrently
+	// Note: used by F1 only and always
+	mutable vector<Counter<Count>>  m_counters;  //!< Cluster matching counters
+	//! Contributions from the cluster members
+	// Note: used only in case of a) overlaps (by all measures) or
+	// b) multiple resolutions (by NMI only)
+	mutable vector<Count>  m_conts;
+	static_assert(!is_floating_point<Count>::value || sizeof(Count) >= sizeof(double)
+		, "Collection, types validation failed");
 	//mutable bool  m_dirty;  //!< The cluster members contribution is not zero (should be reseted on reprocessing)
 	//! Sum of contributions of all members in each cluster
 	mutable AccCont  m_contsum;  // Used by NMI only, marked also by overlapping F1
 
 	//! \copydoc NodeBaseI::nodes() const noexcept
-	const UniqIds& nodes() const noexcept override  // Make a stub and close it
+	const RawIds& nodes() const noexcept override  // Make a stub and close it
 	{
 		assert(0 && "Nodes should not be accessed in collection via the NodeBaseI interface");
-		static UniqIds  nds;
+		static RawIds  nds;
 		return nds;  // Stub output
 	}
 protected:
     //! Default constructor
-	Collection(): m_cls(), m_ndcs(), m_ndshash(0), m_contsum(0)  {}  //, m_dirty(false)  {}
+	Collection(): m_cls(), m_ndcs(), m_ndshash(0), m_origin(nullptr), m_counters()
+	, m_conts(), m_contsum(0)  {}  //, m_dirty(false)  {}
+
+    //! \brief Node clusters relations, which are shared with the origin if any
+    //!
+    //! \return const NodeClusters<Count>&  - node clusters relations
+	const NodeClusters<Count>& ndcs() const noexcept
+	{ return m_origin ? m_origin->m_ndcs : m_ndcs; }
+
+    //! \brief Allocate the evaluation state of the clusters if required
+    //!
+    //! \return void
+	void prepstate() const;
 
 	// Note: Actual for NMI and overlapping F1
 	//! \brief Initialized cluster members contributions
@@ -652,6 +1221,40 @@ protected:
 	//! \return void
 	static void initconts(const CollectionT& cn) noexcept;
 public:
+    //! \brief Copy constructor
+    //! \note The collection owns the clusters
+	Collection(const Collection&)=delete;
+
+	//! \brief Move constructor
+	Collection(Collection&& cn) noexcept
+	: m_cls(std::move(cn.m_cls)), m_ndcs(std::move(cn.m_ndcs)), m_ndshash(cn.m_ndshash)
+	, m_origin(cn.m_origin), m_counters(std::move(cn.m_counters)), m_conts(std::move(cn.m_conts))
+	, m_contsum(cn.m_contsum)
+	{
+		cn.m_cls.clear();
+		cn.m_ndshash = 0;
+		cn.m_origin = nullptr;
+		cn.m_contsum = 0;
+	}
+
+    //! \brief Copy assignment
+    //! \note The collection owns the clusters
+	Collection& operator= (const Collection&)=delete;
+
+	//! \brief Move assignment
+	//! \note The clusters of this collection are released by the source
+	Collection& operator= (Collection&& cn) noexcept
+	{
+		std::swap(m_cls, cn.m_cls);
+		std::swap(m_ndcs, cn.m_ndcs);
+		std::swap(m_ndshash, cn.m_ndshash);
+		std::swap(m_origin, cn.m_origin);
+		std::swap(m_counters, cn.m_counters);
+		std::swap(m_conts, cn.m_conts);
+		std::swap(m_contsum, cn.m_contsum);
+		return *this;
+	}
+
 	~Collection();
 
     //! \brief The number of clusters
@@ -660,17 +1263,24 @@ public:
 	Id clsnum() const noexcept  { return m_cls.size(); }
 
 	//! \copydoc NodeBaseI::ndsnum() const noexcept
-	Id ndsnum() const noexcept override  { return m_ndcs.size(); }
+	Id ndsnum() const noexcept override  { return ndcs().size(); }
 
 	//! \copydoc NodeBaseI::nodeExists(Id nid) const noexcept
-	bool nodeExists(Id nid) const noexcept override  { return m_ndcs.count(nid); }
+	bool nodeExists(Id nid) const noexcept override  { return ndcs().count(nid); }
+
+    //! \brief Ordered node ids of the collection
+    //!
+    //! \return RawIds  - ordered unique node ids
+	RawIds sortedNodes() const;
 
 #ifndef NO_FILEIO
-	//! \brief Load collection from the CNL file
+	//! \brief Load collection from the CNL or binary clustering (.cnb) file
 	//! \pre All clusters in the file are expected to be unique and not validated for
 	//! the mutual match until makeunique is set
 	//!
-	//! \param filename const char*  - name of the input file
+	//! \param filename const char*  - name of the input file, "-" designates stdin.
+	//! 	The streamed input (stdin, named pipe) is parsed on the fly in the CNL format
+	//! 	without the snapshot caching
 	//! \param makeunique=false bool  - ensure that clusters contain unique members by
 	//! 	removing the duplicates
 	//! \param membership=1 float  - expected membership of the nodes, >0, typically >= 1.
@@ -682,28 +1292,124 @@ public:
 	//! \param lostcls=nullptr RawIds*  - indices of the lost clusters during the node base
 	//! synchronization
 	//! \param verbose=false bool  - print the number of loaded nodes to the stdout
+	//! \param prescan=false bool  - count the unique nodes before their indexing
+	//! 	to preallocate the index exactly if the number of nodes is not specified
+	//! 	in the header, the counts are cached in the <filename>.cnt sidecar file
+	//! \param cachedir=nullptr const char*  - directory of the cached snapshots of the
+	//! 	parsed CNL files, which are mapped instead of the parsing while the source
+	//! 	file is not modified; the caching is omitted if nullptr
+	//! \param strids=nullptr Interner*  - interner of the string node ids, which
+	//! 	should be shared by all loading clusterings and the node base. Each member
+	//! 	token is an id in this mode (the share part is not separated), the binary
+	//! 	clusterings and snapshots are not applicable. The members are numeric ids
+	//! 	if nullptr
     //! \return CollectionT  - the collection is loaded successfully
 	static CollectionT load(const char* filename, bool makeunique=false
 		, float membership=1, AggHash* ahash=nullptr, const NodeBaseI* nodebase=nullptr
-		, RawIds* lostcls=nullptr, bool verbose=false);
+		, RawIds* lostcls=nullptr, bool verbose=false, bool prescan=false
+		, const char* cachedir=nullptr, Interner* strids=nullptr);
+
+	//! \brief Load collection from the CNL or binary clustering (.cnb) file
+	//! synchronizing it with the node base fetched after the clusters parsing
+	//! \note The parsing is performed concurrently with the node base loading
+	//! and the nodes are filtered afterwards
+	//!
+	//! \param filename const char*  - name of the input file
+	//! \param fetchbase const NodeBaseFetcher&  - fetcher of the node base to
+	//! 	filter-out nodes, which is called once after the clusters are parsed
+	//! \param makeunique=false bool  - ensure that clusters contain unique members by
+	//! 	removing the duplicates
+	//! \param membership=1 float  - expected membership of the nodes, >0, typically >= 1
+    //! \param ahash=nullptr AggHash*  - resulting hash of the loaded
+    //! member ids base (unique ids only are hashed, not all ids) if not nullptr
+	//! \param lostcls=nullptr RawIds*  - indices of the lost clusters during the node base
+	//! synchronization
+	//! \param verbose=false bool  - print the number of loaded nodes to the stdout
+	//! \param prescan=false bool  - count the unique nodes before their indexing
+	//! 	caching the counts in the sidecar file
+	//! \param cachedir=nullptr const char*  - directory of the cached snapshots of the
+	//! 	parsed CNL files
+	//! \param strids=nullptr Interner*  - interner of the string node ids shared
+	//! 	with the node base, the members are numeric ids if nullptr
+    //! \return CollectionT  - the collection is loaded successfully
+	static CollectionT load(const char* filename, const NodeBaseFetcher& fetchbase
+		, bool makeunique=false, float membership=1, AggHash* ahash=nullptr
+		, RawIds* lostcls=nullptr, bool verbose=false, bool prescan=false
+		, const char* cachedir=nullptr, Interner* strids=nullptr);
+
+	//! \brief Save the collection to the binary clustering file (.cnb)
+	//!
+	//! \param filename const char*  - name of the output file
+	//! \param compress=false bool  - store members as the delta-varint encoded
+	//! 	sorted ids
+	//! \return void
+	void save(const char* filename, bool compress=false) const;
 #endif // NO_FILEIO
 
     //! \brief Transfer collection data
-    //! \post This collection becomes empty
+    //! \post This collection becomes empty unless retained
     //!
     //! \tparam FIRST bool  - fill first of second node clusters relations container
     //!
     //! \param cls RawClusters&  - raw clusters to be extended
     //! \param nds NodeRClusters&  - node raw clusters relations to be extended
+    //! \param retain=false bool  - copy the members retaining the collection for
+    //! 	the subsequent evaluations
     //! \return void
     template <bool FIRST>
-	void transfer(RawClusters& cls, NodeRClusters& ndrcs);
+	void transfer(RawClusters& cls, NodeRClusters& ndrcs, bool retain=false);
+
+    //! \brief Fetch the membership degrees of the nodes in the clusters for the
+    //! weighted Omega Index
+    //! \note The degree of a node is its share in the cluster relative to its
+    //! max share, so the equal shares yield the unit degrees
+    //!
+    //! \tparam FIRST bool  - fill first of second node degrees container
+    //!
+    //! \param nddgs NodeRDegrees&  - node membership degrees to be extended
+    //! \return void
+    template <bool FIRST>
+	void degrees(NodeRDegrees& nddgs) const;
 
     //! \brief Clear cluster counters
     //!
     //! \return void
 	void clearcounts() const noexcept;
 
+	//! \brief Clear the evaluation state (cluster counters and members contributions)
+	//! to evaluate the collection against another one
+	//!
+	//! \return void
+	void clearstate() const noexcept  { clearcounts(); clearconts(); }
+
+	//! \brief Make a deep copy of the collection without its evaluation state
+	//! \note The copies can be evaluated concurrently against distinct collections
+	//!
+	//! \tparam Dst  - counting type of the copy, the multi-resolution collection
+	//! 	is copied to the overlapping one with the equal shares
+	//!
+	//! \param clsnum=0 size_t  - the number of the leading clusters to be copied,
+	//! 	0 means all. The omitted trailing clusters should own their nodes
+	//! 	exclusively, which is the case of the complementary "noise" cluster
+	//! \return Collection<Dst>  - the replica of the collection
+	template <typename Dst=Count>
+	Collection<Dst> clone(size_t clsnum=0) const;
+
+	//! \brief Make a shallow replica of the collection sharing its clusters and
+	//! node memberships, which are read-only on the evaluation
+	//! \note The replicas hold their own evaluation state, so they can be evaluated
+	//! concurrently against distinct collections
+	//! \pre The origin collection outlives its replicas and is not modified
+	//!
+	//! \return Collection  - the replica of the collection
+	Collection share() const;
+
+	//! \brief Approximate memory consumption of the collection (clusters and
+	//! the node memberships index)
+	//!
+	//! \return size_t  - the consumed memory, bytes
+	size_t memsize() const noexcept;
+
 //	//! \brief Synchronize the node base of the cluster collections
 //	//!
 //	//! \tparam REDUCE bool  - whether to reduce collections by removing the non-matching nodes
@@ -725,10 +1431,24 @@ public:
     //! \param weighted=true bool  - weight labels by the number of instances or
     //! treat each label equally
     //! \param flname=nullptr const char*  - resulting label indices filename (.cll format)
+    //! \param binary=false bool  - output the label indices in the binary CSR format (.clb)
 //    //! \param verbose=false bool  - print intermediate results to the stdout
+    //! \param csls=nullptr ClsLabels*  - resulting labels of the clusters if required
     //! \return PrcRec  - resulting precision and recall for the labeled items
 	static PrcRec label(const CollectionT& gt, const CollectionT& cn //, const RawIds& lostcls
-		, bool prob, bool weighted=true, const char* flname=nullptr); //, bool verbose=false);
+		, bool prob, bool weighted=true, const char* flname=nullptr, bool binary=false //, bool verbose=false);
+		, ClsLabels* csls=nullptr);
+
+    //! \brief Label indices of the clusters in the CSR format
+    //!
+    //! \param cn const CollectionT&  - labeled cluster collection
+    //! \param csls const ClsLabels&  - labels of the clusters
+    //! \param[out] offsets vector<uint64_t>&  - offsets of the labels of each cluster
+    //! in the marks, clsnum + 1 items
+    //! \param[out] marks RawIds&  - ordered label indices of all clusters
+    //! \return void
+	static void labelIndices(const CollectionT& cn, const ClsLabels& csls
+		, vector<uint64_t>& offsets, RawIds& marks);
 
 	//! \brief Specified F1 evaluation of the Greatest (Max) Match for the
 	//! multi-resolution clustering with possibly unequal node base
@@ -769,7 +1489,195 @@ public:
 	//! \return RawNmi  - resulting NMI
 	static RawNmi nmi(const CollectionT& cn1, const CollectionT& cn2, bool expbase=false
 		, bool verbose=false);
+
+	//! \brief Overlapping NMI evaluation (McDaid's and LFK normalizations)
+	//! \note Undirected (symmetric) evaluation. Only the intersecting clusters
+	//! are matched and the clusters are processed in parallel, the node base
+	//! is the union of nodes of both collections.
+	//!
+	//! \param cn1 const CollectionT&  - first collection
+	//! \param cn2 const CollectionT&  - second collection
+    //! \param verbose=false bool  - print intermediate results to the stdout
+	//! \return RawOnmi  - resulting overlapping NMI
+	static RawOnmi onmi(const CollectionT& cn1, const CollectionT& cn2, bool verbose=false);
 protected:
+	// Loading related functions -----------------------------------------------
+	//! Clusters loaded from a chunk of the input file
+	struct LoadedClusters {
+		vector<ClusterHolder<Count>>  cls;  //!< Loaded clusters
+		RawIds  lost;  //!< Local indices of the lost clusters
+		vector<pair<Id, Id>>  dups;  //!< Local cluster index and the number of removed duplicates
+		vector<string>  cidsempty;  //!< Ids of the empty clusters
+		size_t  mbsnum;  //!< The number of members in the loaded clusters
+		Id  idmax;  //!< Max member id
+		daoc::StrIds<Id>  strids;  //!< Local ids of the string members if interned
+
+		LoadedClusters(): cls(), lost(), dups(), cidsempty(), mbsnum(0), idmax(0), strids()  {}
+	};
+
+	//! \brief Complete loading of the cluster: register it as lost if empty,
+	//! remove the duplicated members if required
+	//! \note The duplicates are removed by SeenIds of the calling thread
+	//!
+	//! \param chd ClusterHolder<Count>&&  - the loaded cluster
+	//! \param makeunique bool  - remove the duplicated members
+	//! \param chk LoadedClusters&  - the chunk to be extended with the cluster
+	//! \return void
+	static void settleCluster(ClusterHolder<Count>&& chd, bool makeunique, LoadedClusters& chk);
+
+	//! \brief Append the loaded chunks of clusters in their order
+	//! \post chunks are empty
+	//!
+	//! \param chunks vector<LoadedClusters>&  - the loaded chunks
+	//! \param lostcls RawIds*  - indices of the lost clusters to be extended if not nullptr
+	//! \return void
+	void appendClusters(vector<LoadedClusters>& chunks, RawIds* lostcls);
+
+	//! \brief Filter the loaded clusters by the node base
+	//!
+	//! \param chk LoadedClusters&  - the chunk of clusters loaded without the filtering
+	//! \param nodebase const NodeBaseI*  - node base to filter-out nodes if not nullptr
+	//! \param makeunique bool  - remove the duplicated members
+	//! \return void
+	static void filterClusters(LoadedClusters& chk, const NodeBaseI* nodebase, bool makeunique);
+
+	//! \brief Count the unique member nodes of the loaded clusters
+	//! \note The ids are marked in the bitmap if they are dense enough,
+	//! otherwise a copy of the ids is sorted
+	//!
+	//! \param chunks const vector<LoadedClusters>&  - the loaded chunks of clusters
+	//! \param[out] tmpmem size_t&  - the number of bytes temporarily allocated for the counting
+	//! \return size_t  - the number of unique nodes
+	static size_t countNodes(const vector<LoadedClusters>& chunks, size_t& tmpmem);
+
+	//! \brief Replace the local ids of the string members with the shared ones
+	//! \note The local tables are merged in the chunks order, so the shared ids
+	//! are the same as on the sequential interning
+	//! \post The local tables of the chunks are released
+	//!
+	//! \param chunks vector<LoadedClusters>&  - the chunks of clusters with the local ids
+	//! \param strids Interner&  - the shared interner
+	//! \param workers unsigned  - the number of workers to remap the members
+	//! \return void
+	static void internChunks(vector<LoadedClusters>& chunks, Interner& strids, unsigned workers);
+
+	//! \brief Write the label indices of the clusters either as the text lines
+	//! of the ordered indices (.cll) or in the binary CSR format (.clb)
+	//!
+	//! \param fout FILE*  - the output file
+	//! \param gt const CollectionT&  - ground-truth cluster collection (labels)
+	//! \param cn const CollectionT&  - labeled cluster collection
+	//! \param csls const ClsLabels&  - labels of the clusters
+	//! \param binary bool  - output the labels in the binary CSR format
+	//! \return bool  - the labels are written successfully
+	static bool writeLabels(FILE* fout, const CollectionT& gt, const CollectionT& cn
+		, const ClsLabels& csls, bool binary);
+
+#ifndef NO_FILEIO
+	//! \brief Write the collection in the binary clustering format (.cnb)
+	//!
+	//! \param fout FILE*  - the output file
+	//! \param compress bool  - store members as the delta-varint encoded sorted ids
+	//! \param index bool  - store the node memberships index
+	//! \param[out] hdr CnbHeader&  - the written header
+	//! \return bool  - the collection is written successfully
+	bool writeCnb(FILE* fout, bool compress, bool index, CnbHeader& hdr) const;
+
+	//! \brief Load collection from the CNL or binary clustering (.cnb) file
+	//! \copydetails load(const char*, bool, float, AggHash*, const NodeBaseI*, RawIds*, bool, bool, const char*, Interner*)
+	//! \param fetchbase const NodeBaseFetcher*  - fetcher of the node base, which is
+	//! 	used instead of nodebase if not nullptr
+	static CollectionT loadFile(const char* filename, bool makeunique, float membership
+		, AggHash* ahash, const NodeBaseI* nodebase, const NodeBaseFetcher* fetchbase
+		, RawIds* lostcls, bool verbose, bool prescan, const char* cachedir, Interner* strids);
+
+	//! \brief Load clusters from the CNL content
+	//!
+	//! \param file const MappedFile&  - the CNL content
+	//! \param makeunique bool  - remove the duplicated members of the clusters
+	//! \param membership float  - expected membership of the nodes, >0, typically >= 1
+	//! \param nodebase const NodeBaseI*  - node base to filter-out nodes if not nullptr
+	//! \param[out] chunks vector<LoadedClusters>&  - the loaded chunks of clusters
+	//! \param[out] ndsnum size_t&  - the number of nodes specified in the header, 0 if omitted
+	//! \param strids bool  - intern the member tokens into the local ids of the chunks
+	//! 	instead of their parsing as numeric ids
+	//! \return unsigned  - the number of workers used for the loading
+	static unsigned loadCnl(const MappedFile& file, bool makeunique, float membership
+		, const NodeBaseI* nodebase, vector<LoadedClusters>& chunks, size_t& ndsnum
+		, bool strids);
+
+	//! \brief Load clusters from the streamed CNL input parsing it on the fly
+	//! \note The containers grow adaptively since the input size is not known,
+	//! gzip input is decompressed transparently
+	//!
+	//! \param lines LineReader&  - the CNL input
+	//! \param makeunique bool  - remove the duplicated members of the clusters
+	//! \param nodebase const NodeBaseI*  - node base to filter-out nodes if not nullptr
+	//! \param[out] chunks vector<LoadedClusters>&  - the loaded chunks of clusters
+	//! \param[out] ndsnum size_t&  - the number of nodes specified in the header, 0 if omitted
+	//! \param strids bool  - intern the member tokens into the local ids
+	//! \return unsigned  - the number of workers used for the loading, 0 if the input
+	//! 	is not in the CNL format
+	static unsigned loadCnl(LineReader& lines, bool makeunique, const NodeBaseI* nodebase
+		, vector<LoadedClusters>& chunks, size_t& ndsnum, bool strids);
+
+	//! \brief Parse the CNL clusters in the range of whole lines
+	//!
+	//! \param pos const char*  - the beginning of the range
+	//! \param end const char*  - the end of the range
+	//! \param nodebase const NodeBaseI*  - node base to filter-out nodes if not nullptr
+	//! \param makeunique bool  - remove the duplicated members of the clusters
+	//! \param ndchars float  - expected number of chars per member to preallocate
+	//! 	the clusters, >= 1
+	//! \param chk LoadedClusters&  - the chunk to be extended with the parsed clusters
+	//! \param strids bool  - intern the member tokens into the local ids of the chunk
+	//! \return void
+	static void parseCnl(const char* pos, const char* end, const NodeBaseI* nodebase
+		, bool makeunique, float ndchars, LoadedClusters& chk, bool strids);
+
+	//! \brief Load clusters from the binary clustering content (.cnb)
+	//!
+	//! \param file const MappedFile&  - the binary clustering content
+	//! \param makeunique bool  - remove the duplicated members of the clusters
+	//! \param nodebase const NodeBaseI*  - node base to filter-out nodes if not nullptr
+	//! \param[out] chunks vector<LoadedClusters>&  - the loaded chunks of clusters
+	//! \param[out] ahash AggHash&  - the stored hash of the node base if the nodes
+	//! 	are not filtered
+	//! \return unsigned  - the number of workers used for the loading
+	unsigned loadCnb(const MappedFile& file, bool makeunique
+		, const NodeBaseI* nodebase, vector<LoadedClusters>& chunks, AggHash& ahash);
+
+	//! \brief Load the node memberships index (m_ndcs) from the binary clustering
+	//! content (.cnb) instead of the indexing
+	//! \pre The clusters are loaded from the same content without any filtering
+	//! and m_ndcs is empty
+	//!
+	//! \param file const MappedFile&  - the binary clustering content
+	//! \param makeunique bool  - the duplicated members of the clusters are removed,
+	//! 	so the index is not actual unless the stored members are unique
+	//! \return bool  - the index is loaded, false if it is not stored, not actual
+	//! 	or corrupted (m_ndcs is left empty to be rebuilt)
+	bool loadIndex(const MappedFile& file, bool makeunique);
+#endif // NO_FILEIO
+
+	//! \brief Index the clusters of each member node (m_ndcs) from the loaded
+	//! clusters preserving the clusters order
+	//! \note The memberships of the contiguous ranges of clusters are bucketed
+	//! concurrently by the node partitions of m_ndcs, then each partition is
+	//! indexed by a single worker from its buckets without any merging
+	//! \pre m_ndcs is empty
+	//!
+	//! \param workers unsigned  - the number of workers, >= 1
+	//! \return void
+	void indexNodes(unsigned workers);
+
+	//! \brief Index the shares of the members in each cluster from m_ndcs
+	//! \note The shares are held only for the overlaps
+	//! \pre m_ndcs is actual
+	//!
+	//! \return void
+	void indexShares();
+
 	// Label related functions -------------------------------------------------
     //! \brief Mark clusters of the argument collection with the labels
     //! \note For EACH label the best matching cluster is identified. Mutual match
@@ -828,6 +1736,18 @@ protected:
     //! \return RawNmi  - resulting NMI
 	RawNmi nmi(const CollectionT& cn, bool expbase) const;
 
+	//! \brief Conditional entropy of this collection given the specified one
+	//! for the overlapping NMI
+	//! \note Each cluster is matched only to the intersecting clusters of cn
+	//! and to the non-intersecting clusters that can satisfy the information
+	//! constraint, the clusters are processed in parallel
+	//! \attention Directed (non-symmetric) evaluation
+	//!
+	//! \param cn const CollectionT&  - collection to compare with
+	//! \param ndsnum Id  - the number of nodes in both collections (union)
+	//! \return CondEntropy  - resulting conditional entropy H(this|cn)
+	CondEntropy condh(const CollectionT& cn, Id ndsnum) const;
+
     //! \brief Clear contributions in each cluster and optionally
     //! evaluate the clusters matching
     //!
@@ -883,4 +1803,8 @@ AccProb gmean(AccProb a, AccProb b) noexcept;
 //! \return AccProb  - resulting mean
 AccProb amean(AccProb a, AccProb b) noexcept;
 
+#ifdef ID64
+}  // id64
+#endif // ID64
+
 #endif // INTERFACE_H
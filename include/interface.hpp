@@ -8,11 +8,16 @@
 //! \email luart@ya.ru
 //! \date 2017-02-13
 
-#include <cstring>  // strlen, strtok
+#include <cstring>  // strlen, strtok, memchr, memcpy
 //#include <cmath>  // sqrt
 #include <algorithm>
+#include <bitset>
+#if TRACE >= 2
+#include <chrono>
+#endif // TRACE
 
 #include "operations.hpp"
+#include "parallel.hpp"
 #include "interface.h"
 
 
@@ -20,17 +25,26 @@ using std::out_of_range;
 using std::overflow_error;
 using std::invalid_argument;
 using std::to_string;
-//using std::bitset;
+using std::bitset;
 using std::min;
 using std::max;
+using std::max_element;
 using std::sort;
 using std::unique;
-//using std::adjacent_find;
+using std::remove_if;
+using std::adjacent_find;
 #if VALIDATE >= 1
 using std::domain_error;
 #endif // VALIDATE 1
 using namespace daoc;
 
+#ifdef ID64
+namespace id64 {
+
+// Note: std::to_string is hidden by the namespace overloads otherwise
+using std::to_string;
+#endif // ID64
+
 
 //! \brief Extended contribution of the node occurrences in the clusters
 //!
@@ -53,7 +67,7 @@ template <>
 inline void xcontrib<false>(AccId& eh, const RawIds& icount, const RawIds& jcount) noexcept
 {}
 
-template <bool EXT=false>
+template <bool EXT>
 Prob omega(const NodeRClusters& ndrcs, const RawClusters& cls1, const RawClusters& cls2)
 {
 	//using AccContrib = conditional_t<EXT, AccProb, AccId>;  // Accumulated contribution of the pair to OI
@@ -89,9 +103,80 @@ Prob omega(const NodeRClusters& ndrcs, const RawClusters& cls1, const RawCluster
 	return (oh - enorm) / (npairs - enorm);
 }
 
+//! \brief Weighted co-membership of the nodes
+//!
+//! \param a const RawDegrees&  - membership degrees of the first node
+//! \param b const RawDegrees&  - membership degrees of the second node
+//! \return AccProb  - the sum of products of the degrees in the mutual clusters
+inline AccProb comembership(const RawDegrees& a, const RawDegrees& b) noexcept
+{
+	AccProb  cm = 0;
+	auto  ia = a.begin();
+	auto  ib = b.begin();
+	while(ia != a.end() && ib != b.end()) {
+		if(ia->first < ib->first)
+			++ia;
+		else if(ib->first < ia->first)
+			++ib;
+		else {
+			cm += AccProb(ia->second) * ib->second;
+			++ia;
+			++ib;
+		}
+	}
+	return cm;
+}
+
+template <bool EXT>
+Prob omega(const NodeRDegrees& nddgs, Id clsnum1, Id clsnum2)
+{
+	AccProb  oh = 0;  // Observed contribution of the high (top right) part of the matrix
+	// Histograms of the quantized co-memberships
+	vector<AccId>  icount(omegaQuant + 1, 0);
+	vector<AccId>  jcount(omegaQuant + 1, 0);
+	auto count = [](vector<AccId>& hist, AccProb cm) {
+		const size_t  iq = std::lround(cm * omegaQuant);
+		if(iq >= hist.size())
+			hist.resize(iq + omegaQuant, 0);
+		++hist[iq];
+	};
+	const auto ends = nddgs.end();
+	for(auto iidgs = nddgs.begin(); iidgs != ends;) {
+		auto& idgs = *iidgs;
+		for(auto ijdgs = ++iidgs; ijdgs != ends; ++ijdgs) {
+			const AccProb  icm = comembership(idgs.second.first, ijdgs->second.first);
+			const AccProb  jcm = comembership(idgs.second.second, ijdgs->second.second);
+			oh += max<AccProb>(1 - fabs(icm - jcm), 0);
+			count(icount, icm);
+			count(jcount, jcm);
+		}
+	}
+	// Note: the agreement of the quantized co-memberships is nonzero only if
+	// they are closer than omegaQuant
+	AccProb  eh = 0;  // Expected contribution of the high (top right) part of the matrix
+	for(size_t i = 0; i < icount.size(); ++i) {
+		if(!icount[i])
+			continue;
+		const size_t  jend = min(jcount.size(), i + omegaQuant);
+		for(size_t j = i >= omegaQuant ? i - omegaQuant + 1 : 0; j < jend; ++j)
+			eh += AccProb(icount[i]) * jcount[j] * (1 - (i > j ? i - j : j - i) / AccProb(omegaQuant));
+	}
+	// Consider remained accumulated counts of the co-memberships exceeding the
+	// number of clusters of the other collection
+	if(EXT && clsnum1 != clsnum2) {
+		const auto&  rcount = clsnum1 > clsnum2 ? icount : jcount;
+		for(size_t i = size_t(min(clsnum1, clsnum2)) * omegaQuant + 1; i < rcount.size(); ++i)
+			eh += rcount[i];
+	}
+	// The number of pairs = nodes_num * (nodes_num - 1) / 2
+	const AccId  npairs = nddgs.size() * (nddgs.size() - 1) >> 1;
+	const AccProb  enorm = eh / npairs;
+	return (oh - enorm) / (npairs - enorm);
+}
+
 // Cluster definition ----------------------------------------------------------
 template <typename Count>
-Cluster<Count>::Cluster(): members(), counter(), mbscont()
+Cluster<Count>::Cluster(): members(), shares(), index(0)
 {}
 
 // SparseMatrix definitions ----------------------------------------------------
@@ -175,206 +260,856 @@ template <typename Count>
 Collection<Count>::~Collection()
 {
 	// Note: exception on double memory release occurs if m_cls contain non-unique pointers,
-	// which should never happen
-    for(auto cl: m_cls)
-		delete cl;
+	// which should never happen. The shared clusters are released by their origin
+	if(!m_origin)
+		for(auto cl: m_cls)
+			delete cl;
 	m_cls.clear();
 }
 
+template <typename Count>
+RawIds Collection<Count>::sortedNodes() const
+{
+	RawIds  nodes;  // Uses NRVO return value optimization
+	nodes.reserve(ndcs().size());
+	for(const auto& ndcl: ndcs())
+		nodes.push_back(ndcl.first);
+	sort(nodes.begin(), nodes.end());
+	return nodes;
+}
+
 #ifndef NO_FILEIO
 template <typename Count>
 Collection<Count> Collection<Count>::load(const char* filename, bool makeunique, float membership
-	, ::AggHash* ahash, const NodeBaseI* nodebase, RawIds* lostcls, [[maybe_unused]] bool verbose)
+	, ::AggHash* ahash, const NodeBaseI* nodebase, RawIds* lostcls, bool verbose, bool prescan
+	, const char* cachedir, Interner* strids)
+{
+	return loadFile(filename, makeunique, membership, ahash, nodebase, nullptr, lostcls
+		, verbose, prescan, cachedir, strids);
+}
+
+template <typename Count>
+Collection<Count> Collection<Count>::load(const char* filename, const NodeBaseFetcher& fetchbase
+	, bool makeunique, float membership, ::AggHash* ahash, RawIds* lostcls, bool verbose
+	, bool prescan, const char* cachedir, Interner* strids)
+{
+	return loadFile(filename, makeunique, membership, ahash, nullptr, &fetchbase, lostcls
+		, verbose, prescan, cachedir, strids);
+}
+
+template <typename Count>
+Collection<Count> Collection<Count>::loadFile(const char* filename, bool makeunique, float membership
+	, ::AggHash* ahash, const NodeBaseI* nodebase, const NodeBaseFetcher* fetchbase
+	, RawIds* lostcls, [[maybe_unused]] bool verbose, bool prescan, const char* cachedir
+	, Interner* strids)
 {
 	Collection  cn;  // Return using NRVO, named return value optimization
 
-	// Open file
-	NamedFileWrapper  file(filename, "r");
-	if(!file) {
-		perror(string("ERROR load(), failed on opening ").append(filename).c_str());
-		return cn;
+	// Note: the file is memory mapped to parse the ids without the intermediate
+	// line buffering and tokenization, the streamed input is parsed on the fly
+	const bool  streamed = isStreamed(filename);
+	MappedFile  file;  // Note: mapped lazily, the actual snapshot does not need the source
+#if TRACE >= 2
+	if(nodebase)
+		fprintf(stderr, "load(), nodebase provided with %lu nodes\n", size_t(nodebase->ndsnum()));
+#endif // TRACE
+
+	// Load clusters
+	::AggHash  mbhash;  // Nodes hash (only unique nodes, not all the members)
+	auto isCnb = [](const MappedFile& content) noexcept -> bool {
+		return content.size() >= sizeof(CnbHeader)
+			&& !memcmp(content.data(), CnbHeader::MAGIC, sizeof CnbHeader::MAGIC);
+	};
+	vector<LoadedClusters>  chunks;
+	size_t  ndsnum = 0;  // The number of nodes to preallocate the index
+#if TRACE >= 2
+	const char*  ndsorigin = "header";  // Origin of the number of nodes
+	size_t  tmpmem = 0;  // Memory temporary allocated for the nodes counting, bytes
+#endif // TRACE
+	// Note: the duplicates are removed on filtering if the node base is fetched
+	unsigned  workers = 0;
+	// Map the cached snapshot of the CNL file instead of its parsing if the snapshot is actual.
+	// Note: the snapshot is validated by the file stamp, the source is mapped
+	// only if its content should be hashed
+	string  snapname;  // Name of the snapshot, empty if the caching is omitted
+	MappedFile  snapshot;
+	bool  snapped = false;  // The clusters are loaded from the snapshot
+	// Note: the interned ids depend on the loading order, so they are not cached
+	if(cachedir && !streamed && !strids) {
+		// Note: the snapshots are distinguished by the id size and members uniqueness
+		snapname = snapshotName(cachedir, filename, (string("-i").append(to_string(sizeof(Id)))
+			.append(makeunique ? "u" : "") += ".cnb").c_str());
+		if(!snapname.empty()) {
+			if(snapshotActual(snapname, filename, file))
+				snapshot = MappedFile(snapname.c_str());
+			if(isCnb(snapshot))
+				try {
+					workers = cn.loadCnb(snapshot, makeunique && !fetchbase, nodebase, chunks, mbhash);
+					snapped = true;
+				} catch(invalid_argument& err) {
+					fprintf(stderr, "WARNING load(), the snapshot is rebuilt since %s", err.what());
+					chunks.clear();
+					mbhash.clear();
+					workers = 0;
+				}
+#if TRACE >= 2
+			fprintf(stderr, "load(), the snapshot %s is %s\n", snapname.c_str()
+				, snapped ? "mapped" : "omitted");
+#endif // TRACE
+		}
 	}
+	// Open the source file unless the clusters are loaded from the snapshot
+	FileWrapper  input(streamed ? openFile(filename, "rb") : nullptr, !isStdStream(filename));
+	bool  binary = false;  // The source file is a binary clustering
+	if(!snapped) {
+		if(!streamed && !file)
+			file = MappedFile(filename);
+		if(streamed ? !input : !file) {
+			perror(string("ERROR load(), failed on opening ").append(filename).c_str());
+			return cn;
+		}
+		if(!streamed && !file.size()) {
+			fputs(("WARNING load(), the file '" + file.name()
+				+ " is empty, skipped\n").c_str(), stderr);
+			return cn;
+		}
+		binary = isCnb(file);
+		if(binary) {
+			if(strids) {
+				fprintf(stderr, "ERROR load(), the binary clustering holds numeric ids, which"
+					" can't be evaluated with the string ids: %s\n", filename);
+				return cn;
+			}
+			snapname.clear();  // Note: the binary clusterings are not cached
+			workers = cn.loadCnb(file, makeunique && !fetchbase, nodebase, chunks, mbhash);
+		}
+	}
+	if(!workers) {
+		size_t  clsnum = 0;  // The number of clusters in the sidecar
+		const bool  cached = prescan && !streamed && loadCnlCounts(filename, clsnum, ndsnum);
+#if TRACE >= 2
+		if(cached)
+			ndsorigin = "sidecar";
+#endif // TRACE
+		size_t  hdrnds = 0;  // The number of nodes specified in the header
+		// Note: the string members are filtered by the node base after their interning
+		if(streamed) {
+			LineReader  lines(input);
+			workers = loadCnl(lines, makeunique && !fetchbase, strids ? nullptr : nodebase
+				, chunks, hdrnds, strids);
+			if(!workers) {
+				fprintf(stderr, "ERROR load(), binary clusterings can't be streamed: %s\n"
+					, filename);
+				return cn;
+			}
+		} else workers = loadCnl(file, makeunique && !fetchbase, membership
+			, strids ? nullptr : nodebase, chunks, hdrnds, strids);
+		if(strids) {
+			internChunks(chunks, *strids, workers);
+			if(nodebase)
+				parallelFor(chunks.size(), [&chunks, nodebase](size_t i, unsigned) {
+					filterClusters(chunks[i], nodebase, false);
+				}, workers, 1);
+		}
+		if(!cached)
+			ndsnum = hdrnds;
+		if(!ndsnum && prescan) {
+			// Note: the counting is performed before the fetched node base filtering
+#if TRACE >= 2
+			ndsorigin = "prescan";
+			const auto  tcount = std::chrono::steady_clock::now();
+			ndsnum = countNodes(chunks, tmpmem);
+			fprintf(stderr, "load(), %lu nodes counted in %.3f sec using %lu bytes\n", ndsnum
+				, std::chrono::duration<double>(std::chrono::steady_clock::now() - tcount).count()
+				, tmpmem);
+#else
+			size_t  tmpmem = 0;
+			ndsnum = countNodes(chunks, tmpmem);
+#endif // TRACE
+			// Cache the counts of the unfiltered clusters
+			if(!nodebase && !streamed) {
+				clsnum = 0;
+				for(const auto& chk: chunks)
+					clsnum += chk.cls.size();
+				saveCnlCounts(filename, clsnum, ndsnum);
+			}
+		}
+		// Note: the index of the streamed input grows adaptively
+		if(!ndsnum && !streamed) {
+			ndsnum = estimateCnlNodes(file.size(), membership);
+#if TRACE >= 2
+			ndsorigin = "estimate";
+#endif // TRACE
+		}
+#if TRACE >= 2
+		fprintf(stderr, "load(), %lu nodes expected (%s)\n", ndsnum, ndsorigin);
+#endif // TRACE
+	}
+	// Fetch the node base and filter the loaded clusters
+	if(fetchbase) {
+		nodebase = (*fetchbase)();
+#if TRACE >= 2
+		if(nodebase)
+			fprintf(stderr, "load(), nodebase fetched with %lu nodes\n"
+				, size_t(nodebase->ndsnum()));
+#endif // TRACE
+		if(nodebase)
+			mbhash.clear();  // The stored hash is not actual
+		if(nodebase || makeunique)
+			parallelFor(chunks.size(), [&chunks, nodebase, makeunique](size_t i, unsigned) {
+				filterClusters(chunks[i], nodebase, makeunique);
+			}, workers, 1);
+	}
+	size_t  lostnum = 0;  // The number of lost clusters
+	for(const auto& chk: chunks) {
+		lostnum += chk.lost.size();
+		// Note: the ids out of the hashing range are reported to be reloaded with the wider ids
+		if(chk.idmax > ::AggHash::idmax)
+			throw IdOverflow("ERROR load(), the node id " + to_string(chk.idmax)
+				+ " exceeds the supported range in " + filename + "\n");
+	}
+	cn.appendClusters(chunks, lostcls);
 
-	constexpr size_t  FILESIZE_INVALID = size_t(-1);
-	const size_t fsize = file.size();
-	if(!fsize) {
-		fputs(("WARNING load(), the file '" + file.name()
-			+ " is empty, skipped\n").c_str(), stderr);
-		return cn;
+	// Index the node memberships unless the stored index is actual
+	if((!binary && !snapped) || nodebase || !cn.loadIndex(snapped ? snapshot : file, makeunique)) {
+		if(cn.m_ndcs.bucket_count() * cn.m_ndcs.max_load_factor() < ndsnum)
+			cn.m_ndcs.reserve(ndsnum);
+		cn.indexNodes(workers);
 	}
+	cn.indexShares();
+	// Save some space if it is essential
+	if(cn.m_cls.size() < cn.m_cls.capacity() / 2)
+		cn.m_cls.shrink_to_fit();
+	// Rehash the clusters and nodes for faster traversing if required
+	//if(cn.m_cls.size() < cn.m_cls.bucket_count() * cn.m_cls.max_load_factor() / 2)
+	//	cn.m_cls.reserve(cn.m_cls.size());
+	if(cn.m_ndcs.size() < cn.m_ndcs.bucket_count() * cn.m_ndcs.max_load_factor() / 2)
+		cn.m_ndcs.reserve(cn.m_ndcs.size());
 
-	// Load clusters
+	// Evaluate the node hash unless it is stored
+	if(!mbhash.size())
+		for(const auto& ndcl: cn.m_ndcs)
+			mbhash.add(ndcl.first);
+	// Assign hash to the results
+	cn.m_ndshash = mbhash.hash();  // Note: required to identify the unequal node base in the processing collections
+	if(ahash)
+		*ahash = move(mbhash);
+
+	// Cache the snapshot of the parsed clusters if they are not reduced by the node base
+	if(!snapname.empty() && !snapped && !nodebase && !lostnum) {
+		// Note: the snapshot is written to the temporary file to be replaced atomically
+		const string  tmpname = tempName(snapname);
+		NamedFileWrapper  fsnap(tmpname.c_str(), "wb");
+		CnbHeader  hdr;
+		const bool  done = fsnap && cn.writeCnb(fsnap, false, true, hdr) && !fflush(fsnap);
+		fsnap.reset(nullptr, nullptr);  // Close the file
+		if(done && !rename(tmpname.c_str(), snapname.c_str()))
+			saveSnapshotKey(snapname, filename, contentHash(file.data(), file.size()));
+		else {
+			perror(("WARNING load(), the snapshot can't be cached: " + snapname).c_str());
+			remove(tmpname.c_str());
+		}
+	}
+#if TRACE >= 2
+	printf("load(), loaded %lu clusters (capacity: %lu, overhead: %0.2f %%) and"
+		" %lu nodes (reserved %lu buckets, overhead: %0.2f %%) with hash %lu from %s\n"
+		, cn.m_cls.size(), cn.m_cls.capacity()
+		, cn.m_cls.size() ? float(cn.m_cls.capacity() - cn.m_cls.size()) / cn.m_cls.size() * 100
+			: numeric_limits<float>::infinity()
+		, cn.m_ndcs.size(), cn.m_ndcs.bucket_count()
+		, cn.m_ndcs.size() ? float(cn.m_ndcs.bucket_count() - cn.m_ndcs.size()) / cn.m_ndcs.size() * 100
+			: numeric_limits<float>::infinity()
+		, cn.m_ndshash, filename);
+#elif TRACE >= 1
+	if(verbose)
+		printf("load(), loaded %lu clusters %lu nodes from %s\n", cn.m_cls.size()
+			, cn.m_ndcs.size(), filename);
+#endif
+
+	return cn;
+}
+
+template <typename Count>
+unsigned Collection<Count>::loadCnl(const MappedFile& file, bool makeunique, float membership
+	, const NodeBaseI* nodebase, vector<LoadedClusters>& chunks, size_t& ndsnum, bool strids)
+{
 	// Note: CNL [CSN] format only is supported
+	const size_t  fsize = file.size();
 	size_t  csnum = 0;  // The number of clusters
-	size_t  nsnum = 0;  // The number of nodes
-	// Note: strings defined out of the cycle to avoid reallocations
-	StringBuffer  line;  // Reading line
+	ndsnum = 0;
 	// Parse header and read the number of clusters if specified
-	parseCnlHeader(file, line, csnum, nsnum);
-
+	parseCnlHeader(file, csnum, ndsnum);
+	// Note: the clusters are preallocated exactly on their appending, the nodes
+	// are preallocated by the caller
+	size_t  nsnum = ndsnum;  // The number of nodes
 	// Estimate the number of nodes in the file if not specified
 	if(!nsnum) {
-		if(fsize != FILESIZE_INVALID) {  // File length fetching failed
-			nsnum = estimateCnlNodes(fsize, membership);
+		nsnum = estimateCnlNodes(fsize, membership);
 #if TRACE >= 2
-			fprintf(stderr, "load(), %lu estimated nodes from %lu bytes\n", nsnum, fsize);
+		fprintf(stderr, "loadCnl(), %lu estimated nodes from %lu bytes\n", nsnum, fsize);
 #endif // TRACE
-		} else if(csnum)
-			nsnum = 2 * csnum; // / membership;  // Note: use optimistic estimate instead of pessimistic (square / membership) to not overuse the memory
 	}
-	// Estimate the number of clusters in the file if not specified
-	if(!csnum && nsnum)
-		csnum = estimateClusters(nsnum, membership);
 #if TRACE >= 2
-	fprintf(stderr, "load(), expected %lu clusters, %lu nodes from %lu input bytes\n"
+	fprintf(stderr, "loadCnl(), expected %lu clusters, %lu nodes from %lu input bytes\n"
 		, csnum, nsnum, fsize);
-	if(nodebase)
-		fprintf(stderr, "load(), nodebase provided with %u nodes\n", nodebase->ndsnum());
 #endif // TRACE
 
-	// Preallocate space for the clusters and nodes
-	if(cn.m_cls.capacity() < csnum)  //  * cn.m_cls.max_load_factor()
-		cn.m_cls.reserve(csnum);
-	if(cn.m_ndcs.bucket_count() * cn.m_ndcs.max_load_factor() < nsnum)
-		cn.m_ndcs.reserve(nsnum);
-
 	// Parse clusters
-	// ATTENTION: without '\n' delimiter the terminating '\n' is read as an item
-	constexpr char  mbdelim[] = " \t\n";  // Delimiter for the members
 	// Estimate the number of chars per node, floating number
-	const float  ndchars = nsnum ? (fsize != FILESIZE_INVALID
-		? fsize / float(nsnum) : log10(float(nsnum) + 1))  // Note: + 1 to consider the leading space
-		: 1.f;
+	const float  ndchars = nsnum ? fsize / float(nsnum) : 1.f;
 #if VALIDATE >= 2
-	//fprintf(stderr, "load(), ndchars: %.4G\n", ndchars);
-	assert(ndchars >= 1 && "load(), ndchars invalid");
+	//fprintf(stderr, "loadCnl(), ndchars: %.4G\n", ndchars);
+	assert(ndchars >= 1 && "loadCnl(), ndchars invalid");
 #endif // VALIDATE
-	ClusterHolder<Count>  chd(new Cluster<Count>());
-	do {
-		// Skip cluster id if specified and parse first node id
-		char *tok = strtok(line, mbdelim);  // const_cast<char*>(line.data())
+	// Split the file into the chunks of whole lines to parse them concurrently
+	// Note: the chunks are concatenated in the file order, so the cluster indices
+	// are the same as on the sequential parsing
+	constexpr size_t  chunkbytesMin = 1 << 20;  // 1 MB
+	const unsigned  workers = workersNum(fsize, chunkbytesMin);
+	chunks.resize(workers >= 2 ? workers * 4 : 1);
+	vector<const char*>  bounds;  // Chunk bounds
+	bounds.reserve(chunks.size() + 1);
+	bounds.push_back(file.data());
+	const char* const  end = file.data() + fsize;
+	for(size_t i = 1; i < chunks.size(); ++i) {
+		const char*  pos = max(bounds.back(), file.data() + fsize * i / chunks.size());
+		if(pos != end && pos != file.data() && pos[-1] != '\n') {
+			pos = static_cast<const char*>(memchr(pos, '\n', end - pos));
+			pos = pos ? pos + 1 : end;
+		}
+		bounds.push_back(pos);
+	}
+	bounds.push_back(end);
+	parallelFor(chunks.size(), [&bounds, &chunks, nodebase, makeunique, ndchars, strids](size_t i, unsigned) {
+		parseCnl(bounds[i], bounds[i + 1], nodebase, makeunique, ndchars, chunks[i], strids);
+	}, workers, 1);
+	return workers;
+}
 
-		// Skip comments
-		if(!tok || tok[0] == '#')
+template <typename Count>
+unsigned Collection<Count>::loadCnl(LineReader& lines, bool makeunique, const NodeBaseI* nodebase
+	, vector<LoadedClusters>& chunks, size_t& ndsnum, bool strids)
+{
+	size_t  csnum = 0;  // The number of clusters
+	ndsnum = 0;
+	// Parse header and read the number of clusters if specified
+	char*  line = parseCnlHeader(lines, csnum, ndsnum);
+	// Note: the binary clusterings can't be parsed on the fly
+	if(line && lines.length() >= sizeof CnbHeader::MAGIC
+	&& !memcmp(line, CnbHeader::MAGIC, sizeof CnbHeader::MAGIC))
+		return 0;
+#if TRACE >= 2
+	fprintf(stderr, "loadCnl(), expected %lu clusters, %lu nodes from the stream\n"
+		, csnum, ndsnum);
+#endif // TRACE
+
+	// Parse clusters line by line, the containers grow adaptively since the
+	// input size is unknown
+	chunks.resize(1);
+	auto&  chk = chunks.front();
+	size_t  nchars = 0;  // The number of parsed chars
+	for(; line; line = lines.readline()) {
+		const size_t  len = lines.length();
+		// Note: the number of chars per member is refined by the parsed clusters
+		// to preallocate the members, initially a digit and a delimiter are expected
+		parseCnl(line, line + len, nodebase, makeunique
+			, chk.mbsnum ? max(nchars / float(chk.mbsnum), 1.f) : 2.f, chk, strids);
+		nchars += len + 1;  // Note: + 1 for the line delimiter
+	}
+	return 1;
+}
+
+template <typename Count>
+void Collection<Count>::parseCnl(const char* pos, const char* end, const NodeBaseI* nodebase
+	, bool makeunique, float ndchars, LoadedClusters& chk, bool strids)
+{
+	for(const char* eol; pos != end; pos = eol) {
+		// Fetch the line bounds, eol points to the beginning of the next line
+		eol = static_cast<const char*>(memchr(pos, '\n', end - pos));
+		eol = eol ? eol + 1 : end;
+		pos = skipCnlSpaces(pos, eol);
+		// Skip empty lines and comments
+		if(pos == eol || *pos == '#')
 			continue;
+		const char* const  lbeg = pos;  // Beginning of the cluster line
 		// Skip the cluster id if present
-		if(tok[strlen(tok) - 1] == '>') {
-			const char* cidstr = tok;
-			tok = strtok(nullptr, mbdelim);
+		const char*  tokend = cnlTokenEnd(pos, eol);
+		if(tokend[-1] == '>') {
+			pos = skipCnlSpaces(tokend, eol);
 			// Skip empty clusters, which actually should not exist
-			if(!tok) {
-				fprintf(stderr, "WARNING load(), empty cluster"
-					" exists: '%s', skipped\n", cidstr);
+			if(pos == eol) {
+				chk.cidsempty.emplace_back(lbeg, tokend);
 				continue;
 			}
 		}
 
 		// Parse remained node ids and load cluster members
-		Cluster<Count>* const  pcl = chd.get();
-		auto& members = pcl->members;
-		members.reserve(line.length() / ndchars);  // Note: strtok() does not affect line.length()
+		ClusterHolder<Count>  chd(new Cluster<Count>());
+		auto& members = chd->members;
+		members.reserve((eol - lbeg) / ndchars);
 		do {
 			// Note: only the node id is parsed, share part is skipped if exists,
 			// but potentially can be considered in NMI and F1 evaluation.
 			// In the latter case abs diff of shares instead of co occurrence
 			// counting should be performed.
-			Id  nid = parseId(tok);
-//			Id  nid = strtoul(tok, nullptr, 10);
-//#if VALIDATE >= 2
-//			if(!nid && tok[0] != '0') {
-//				fprintf(stderr, "WARNING load(), conversion error of '%s' into 0: %s\n"
-//					, tok, strerror(errno));
-//				continue;
-//			}
-//#endif // VALIDATE
+			Id  nid;
+			if(strids) {
+				// Note: the whole token is the id, which is interned locally
+				tokend = cnlTokenEnd(pos, eol);
+				nid = chk.strids.intern(pos, tokend - pos);
+				pos = tokend;
+			} else nid = scanId<Id>(pos, eol);
+			pos = skipCnlSpaces(pos, eol);
 			// Filter out nodes if required
 			if(nodebase && !nodebase->nodeExists(nid))
 				continue;
 			members.push_back(nid);
-			auto& ncs = cn.m_ndcs[nid];
-			// Note: the hash should be updated later considering that some nodes can be removed
-			ncs.push_back(pcl);
-		} while((tok = strtok(nullptr, mbdelim)));
-		if(!members.empty()) {
-			if(makeunique) {
-				// Ensure or validate that members are unique
-				sort(members.begin(), members.end());
-				const auto im = unique(members.begin(), members.end());
-				//const auto im = adjacent_find(members.begin(), members.end());
-				if(im != members.end()) {
-					fprintf(stderr, "WARNING load(), #%lu cluster contained %lu duplicated members, corrected.\n"
-						, cn.m_cls.size(), distance(im, members.end()));
-					// Remove associated clusters
-					for(auto jm = im; jm != members.end(); ++jm)
-						cn.m_ndcs[*jm].pop_back();
-					// Remove the tail of duplicated node ids
-					members.erase(im, members.end());
-					//fprintf(stderr, "WARNING load(), #%lu cluster contains duplicated member #%lu: %u\n"
-					//	, cn.m_cls.size(), distance(members.begin(), im), *im);
-					//throw invalid_argument("load(), the cluster contains duplicated members\n");
+		} while(pos != eol);
+		settleCluster(move(chd), makeunique, chk);
+	}
+}
+
+template <typename Count>
+unsigned Collection<Count>::loadCnb(const MappedFile& file, bool makeunique
+	, const NodeBaseI* nodebase, vector<LoadedClusters>& chunks, ::AggHash& ahash)
+{
+	CnbHeader  hdr;
+	memcpy(&hdr, file.data(), sizeof hdr);
+	const bool  delta = hdr.flags & CnbHeader::CNB_DELTA;
+	// Validate the header
+	if(hdr.version > CnbHeader::VERSION || !hdr.version)
+		throw invalid_argument("ERROR loadCnb(), unsupported format version "
+			+ to_string(hdr.version) + " of " + file.name() + "\n");
+	// Note: the wider ids are reported as the overflow to be reloaded with the wider ids
+	if(hdr.idbytes > sizeof(Id))
+		throw IdOverflow("ERROR loadCnb(), " + to_string(hdr.idbytes)
+			+ " bytes node ids of " + file.name() + " exceed the supported ones\n");
+	if(hdr.idbytes != sizeof(Id))
+		throw invalid_argument("ERROR loadCnb(), " + to_string(hdr.idbytes)
+			+ " bytes node ids of " + file.name() + " are not supported\n");
+	const size_t  offsbytes = (hdr.clsnum + 1) * sizeof(uint64_t);
+	if(hdr.clsnum >= file.size() || hdr.ndsnum >= file.size() || file.size() != sizeof hdr
+	+ offsbytes + hdr.mbsbytes + hdr.indexbytes<Id>()
+	|| (!delta && hdr.mbsbytes != hdr.mbsnum * sizeof(Id)))
+		throw invalid_argument("ERROR loadCnb(), the content size does not correspond to"
+			" the header of " + file.name() + "\n");
+#if TRACE >= 2
+	fprintf(stderr, "loadCnb(), %lu clusters, %lu nodes, %lu members (%s%s) from %lu input bytes\n"
+		, hdr.clsnum, hdr.ndsnum, hdr.mbsnum, delta ? "delta-varint" : "raw"
+		, hdr.flags & CnbHeader::CNB_INDEX ? ", indexed" : "", file.size());
+#endif // TRACE
+	// Note: the offsets are read by memcpy since the content alignment is not guaranteed
+	const char* const  offsdata = file.data() + sizeof hdr;
+	auto offset = [offsdata](size_t i) noexcept -> uint64_t {
+		uint64_t  val;
+		memcpy(&val, offsdata + i * sizeof val, sizeof val);
+		return val;
+	};
+	const char* const  mbsdata = offsdata + offsbytes;
+
+	m_cls.reserve(hdr.clsnum);
+	if(m_ndcs.bucket_count() * m_ndcs.max_load_factor() < hdr.ndsnum)
+		m_ndcs.reserve(hdr.ndsnum);
+	// Duplicates are removed only if they could be present
+	makeunique = makeunique && !(hdr.flags & CnbHeader::CNB_UNIQUE);
+
+	// Load clusters in the contiguous ranges concurrently
+	const unsigned  workers = workersNum(hdr.mbsbytes, 1 << 20);  // 1 MB
+	chunks.resize(workers >= 2 ? workers * 4 : 1);
+	parallelFor(chunks.size(), [&](size_t ic, unsigned) {
+		auto& chk = chunks[ic];
+		const size_t  icend = hdr.clsnum * (ic + 1) / chunks.size();
+		for(size_t i = hdr.clsnum * ic / chunks.size(); i < icend; ++i) {
+			const uint64_t  ibeg = offset(i);
+			const uint64_t  iend = offset(i + 1);
+			if(ibeg > iend || iend > (delta ? hdr.mbsbytes : hdr.mbsnum))
+				throw invalid_argument("ERROR loadCnb(), invalid offsets of the cluster #"
+					+ to_string(i) + "\n");
+			ClusterHolder<Count>  chd(new Cluster<Count>());
+			auto& members = chd->members;
+			if(delta) {
+				const uint8_t*  pos = reinterpret_cast<const uint8_t*>(mbsdata) + ibeg;
+				const uint8_t* const  end = reinterpret_cast<const uint8_t*>(mbsdata) + iend;
+				members.reserve(end - pos);
+				for(Id  nid = 0; pos != end;) {
+					nid += scanVarint<Id>(pos, end);
+					if(!nodebase || nodebase->nodeExists(nid))
+						members.push_back(nid);
 				}
+			} else {
+				members.resize(iend - ibeg);
+				memcpy(members.data(), mbsdata + ibeg * sizeof(Id), members.size() * sizeof(Id));
+				if(nodebase)
+					members.erase(remove_if(members.begin(), members.end(), [nodebase](Id nid) noexcept {
+						return !nodebase->nodeExists(nid);
+					}), members.end());
 			}
-			members.shrink_to_fit();  // Free over reserved space
-			//for(auto v: members)
-			//	printf(" %u", v);
-			//puts("");
-			cn.m_cls.push_back(chd.release());
-			// Start filling a new cluster
-			chd.reset(new Cluster<Count>());
-		} else if(lostcls)
-			lostcls->push_back(lostcls->size() + cn.m_cls.size());
-	} while(line.readline(file));
-	// Save some space if it is essential
-	if(cn.m_cls.size() < cn.m_cls.capacity() / 2)
-		cn.m_cls.shrink_to_fit();
-	// Rehash the clusters and nodes for faster traversing if required
-	//if(cn.m_cls.size() < cn.m_cls.bucket_count() * cn.m_cls.max_load_factor() / 2)
-	//	cn.m_cls.reserve(cn.m_cls.size());
-	if(cn.m_ndcs.size() < cn.m_ndcs.bucket_count() * cn.m_ndcs.max_load_factor() / 2)
-		cn.m_ndcs.reserve(cn.m_ndcs.size());
+			settleCluster(move(chd), makeunique, chk);
+		}
+	}, workers, 1);
 
-	// Evaluate the node hash
-	::AggHash  mbhash;  // Nodes hash (only unique nodes, not all the members)
-	for(const auto& ndcl: cn.m_ndcs)
+	// Restore the stored hash if the node base is not reduced and the hash fits the header
+	if(!nodebase && sizeof(::AggHash::AccIdT) <= sizeof hdr.hidsum)
+		ahash = ::AggHash(hdr.hsize, hdr.hidsum, hdr.hid2sum);
+	return workers;
+}
+
+template <typename Count>
+void Collection<Count>::save(const char* filename, bool compress) const
+{
+	NamedFileWrapper  fout(filename, "wb");
+	if(!fout)
+		throw std::ios_base::failure(string("ERROR save(), the file can't be created: ")
+			.append(filename) += "\n");
+
+	CnbHeader  hdr;
+	if(!writeCnb(fout, compress, false, hdr))
+		throw std::ios_base::failure(string("ERROR save(), writing failed to ")
+			.append(filename) += "\n");
+#if TRACE >= 1
+	printf("save(), %lu clusters, %lu nodes, %lu members are saved to %s (%lu bytes)\n"
+		, hdr.clsnum, hdr.ndsnum, hdr.mbsnum, filename
+		, sizeof hdr + (hdr.clsnum + 1) * sizeof(uint64_t) + hdr.mbsbytes);
+#endif // TRACE
+}
+
+template <typename Count>
+bool Collection<Count>::writeCnb(FILE* fout, bool compress, bool index, CnbHeader& hdr) const
+{
+	memset(&hdr, 0, sizeof hdr);
+	memcpy(hdr.magic, CnbHeader::MAGIC, sizeof hdr.magic);
+	hdr.version = CnbHeader::VERSION;
+	hdr.idbytes = sizeof(Id);
+	hdr.clsnum = m_cls.size();
+	hdr.ndsnum = ndcs().size();
+	::AggHash  mbhash;
+	for(const auto& ndcl: ndcs())
 		mbhash.add(ndcl.first);
-	// Assign hash to the results
-	cn.m_ndshash = mbhash.hash();  // Note: required to identify the unequal node base in the processing collections
-	if(ahash)
-		*ahash = move(mbhash);
-#if TRACE >= 2
-	printf("load(), loaded %lu clusters (capacity: %lu, overhead: %0.2f %%) and"
-		" %lu nodes (reserved %lu buckets, overhead: %0.2f %%) with hash %lu from %s\n"
-		, cn.m_cls.size(), cn.m_cls.capacity()
-		, cn.m_cls.size() ? float(cn.m_cls.capacity() - cn.m_cls.size()) / cn.m_cls.size() * 100
-			: numeric_limits<float>::infinity()
-		, cn.m_ndcs.size(), cn.m_ndcs.bucket_count()
-		, cn.m_ndcs.size() ? float(cn.m_ndcs.bucket_count() - cn.m_ndcs.size()) / cn.m_ndcs.size() * 100
-			: numeric_limits<float>::infinity()
-		, cn.m_ndshash, file.name().c_str());
-#elif TRACE >= 1
-	if(verbose)
-		printf("load(), loaded %lu clusters %lu nodes from %s\n", cn.m_cls.size()
-			, cn.m_ndcs.size(), file.name().c_str());
-#endif
+	hdr.hsize = mbhash.size();
+	hdr.hidsum = mbhash.idsum();
+	hdr.hid2sum = mbhash.id2sum();
+
+	// Form the offsets and payload
+	vector<uint64_t>  offsets;
+	offsets.reserve(m_cls.size() + 1);
+	offsets.push_back(0);
+	vector<uint8_t>  mbsbuf;  // Compressed members
+	RawIds  members;  // Sorted members of the cluster
+	bool  uniqmbs = true;  // All clusters contain unique members
+	for(auto pcl: m_cls) {
+		members = pcl->members;
+		sort(members.begin(), members.end());
+		uniqmbs = uniqmbs && adjacent_find(members.begin(), members.end()) == members.end();
+		hdr.mbsnum += members.size();
+		if(compress) {
+			Id  nprev = 0;
+			for(auto nid: members) {
+				appendVarint(mbsbuf, Id(nid - nprev));
+				nprev = nid;
+			}
+			offsets.push_back(mbsbuf.size());
+		} else offsets.push_back(hdr.mbsnum);
+	}
+	hdr.flags = (compress ? CnbHeader::CNB_DELTA : 0) | (uniqmbs ? CnbHeader::CNB_UNIQUE : 0)
+		| (index ? CnbHeader::CNB_INDEX : 0);
+	hdr.mbsbytes = compress ? mbsbuf.size() : hdr.mbsnum * sizeof(Id);
+
+	// Write the content
+	bool  done = fwrite(&hdr, sizeof hdr, 1, fout) == 1
+		&& fwrite(offsets.data(), sizeof(uint64_t), offsets.size(), fout) == offsets.size();
+	if(compress)
+		done = done && fwrite(mbsbuf.data(), 1, mbsbuf.size(), fout) == mbsbuf.size();
+	else for(auto icl = m_cls.begin(); done && icl != m_cls.end(); ++icl) {
+		const auto&  mbs = (*icl)->members;
+		done = fwrite(mbs.data(), sizeof(Id), mbs.size(), fout) == mbs.size();
+	}
+	if(!index || !done)
+		return done;
+
+	// Form the node memberships index ordered by the node ids
+	const RawIds  nodes = sortedNodes();
+	offsets.clear();
+	offsets.push_back(0);
+	RawIds  ndcls;  // Cluster indices of the nodes
+	ndcls.reserve(hdr.mbsnum);
+	for(auto nid: nodes) {
+		for(auto pcl: ndcs().at(nid))
+			ndcls.push_back(pcl->index);
+		offsets.push_back(ndcls.size());
+	}
+	return fwrite(nodes.data(), sizeof(Id), nodes.size(), fout) == nodes.size()
+		&& fwrite(offsets.data(), sizeof(uint64_t), offsets.size(), fout) == offsets.size()
+		&& fwrite(ndcls.data(), sizeof(Id), ndcls.size(), fout) == ndcls.size();
+}
 
-	return cn;
+template <typename Count>
+bool Collection<Count>::loadIndex(const MappedFile& file, bool makeunique)
+{
+	CnbHeader  hdr;
+	memcpy(&hdr, file.data(), sizeof hdr);
+	if(!(hdr.flags & CnbHeader::CNB_INDEX) || hdr.clsnum != m_cls.size()
+	|| (makeunique && !(hdr.flags & CnbHeader::CNB_UNIQUE))
+	|| file.size() < sizeof hdr + hdr.indexbytes<Id>())
+		return false;
+	const char* const  ndsdata = file.data() + file.size() - hdr.indexbytes<Id>();
+	const char* const  offsdata = ndsdata + hdr.ndsnum * sizeof(Id);
+	const char* const  clsdata = offsdata + (hdr.ndsnum + 1) * sizeof(uint64_t);
+	// Note: the values are read by memcpy since the content alignment is not guaranteed
+	uint64_t  ibeg = 0;  // Begin of the node clusters
+	if(m_ndcs.bucket_count() * m_ndcs.max_load_factor() < hdr.ndsnum)
+		m_ndcs.reserve(hdr.ndsnum);
+	for(size_t i = 0; i < hdr.ndsnum; ++i) {
+		Id  nid;
+		memcpy(&nid, ndsdata + i * sizeof nid, sizeof nid);
+		uint64_t  iend;
+		memcpy(&iend, offsdata + (i + 1) * sizeof iend, sizeof iend);
+		if(ibeg > iend || iend > hdr.mbsnum) {
+			fprintf(stderr, "WARNING loadIndex(), the index is rebuilt since the offsets"
+				" of the node #%lu are invalid\n", i);
+			m_ndcs.clear();
+			return false;
+		}
+		auto& ndcls = m_ndcs[nid];
+		ndcls.reserve(iend - ibeg);
+		for(; ibeg < iend; ++ibeg) {
+			Id  icl;
+			memcpy(&icl, clsdata + ibeg * sizeof icl, sizeof icl);
+			if(icl >= m_cls.size()) {
+				fprintf(stderr, "WARNING loadIndex(), the index is rebuilt since the node #%lu"
+					" refers to the invalid cluster #%lu\n", i, size_t(icl));
+				m_ndcs.clear();
+				return false;
+			}
+			ndcls.push_back(m_cls[icl]);
+		}
+	}
+	return true;
 }
 #endif // NO_FILEIO
 
+template <typename Count>
+void Collection<Count>::settleCluster(ClusterHolder<Count>&& chd, bool makeunique
+	, LoadedClusters& chk)
+{
+	auto& members = chd->members;
+	if(members.empty()) {
+		chk.lost.push_back(chk.lost.size() + chk.cls.size());
+		return;
+	}
+	Id  idmax;  // Max member id
+	if(makeunique) {
+		// Ensure or validate that members are unique
+		const size_t  ndups = SeenIds::local().dedup(members, idmax);
+		if(ndups)
+			chk.dups.emplace_back(chk.cls.size(), ndups);
+	} else idmax = *max_element(members.begin(), members.end());
+	members.shrink_to_fit();  // Free over reserved space
+	chk.mbsnum += members.size();
+	chk.idmax = max(chk.idmax, idmax);
+	chk.cls.push_back(move(chd));
+}
+
+template <typename Count>
+void Collection<Count>::filterClusters(LoadedClusters& chk, const NodeBaseI* nodebase
+	, bool makeunique)
+{
+	// Note: the clusters are not lost before the filtering, so the local
+	// indices of the lost clusters are formed from scratch
+	LoadedClusters  res;
+	res.cls.reserve(chk.cls.size());
+	res.cidsempty = move(chk.cidsempty);
+	for(auto& chd: chk.cls) {
+		auto& members = chd->members;
+		if(nodebase)
+			members.erase(remove_if(members.begin(), members.end(), [nodebase](Id nid) noexcept {
+				return !nodebase->nodeExists(nid);
+			}), members.end());
+		settleCluster(move(chd), makeunique, res);
+	}
+	chk = move(res);
+}
+
+template <typename Count>
+size_t Collection<Count>::countNodes(const vector<LoadedClusters>& chunks, size_t& tmpmem)
+{
+	size_t  mbsnum = 0;
+	Id  idmax = 0;
+	for(const auto& chk: chunks) {
+		mbsnum += chk.mbsnum;
+		idmax = max(idmax, chk.idmax);
+	}
+	tmpmem = 0;
+	if(!mbsnum)
+		return 0;
+
+	size_t  ndsnum = 0;
+	// Note: the bitmap is not larger than the ids copy for the dense ids
+	constexpr unsigned  wbits = 64;  // The number of bits in the bitmap word
+	if(idmax / wbits < mbsnum) {
+		vector<uint64_t>  nodes(idmax / wbits + 1);
+		tmpmem = nodes.size() * sizeof(uint64_t);
+		for(const auto& chk: chunks)
+			for(const auto& chd: chk.cls)
+				for(auto nid: chd->members)
+					nodes[nid / wbits] |= uint64_t(1) << nid % wbits;
+		for(auto word: nodes)
+			ndsnum += bitset<wbits>(word).count();
+	} else {
+		RawIds  nodes;
+		nodes.reserve(mbsnum);
+		tmpmem = mbsnum * sizeof(Id);
+		for(const auto& chk: chunks)
+			for(const auto& chd: chk.cls)
+				nodes.insert(nodes.end(), chd->members.begin(), chd->members.end());
+		sort(nodes.begin(), nodes.end());
+		ndsnum = distance(nodes.begin(), unique(nodes.begin(), nodes.end()));
+	}
+	return ndsnum;
+}
+
+template <typename Count>
+void Collection<Count>::internChunks(vector<LoadedClusters>& chunks, Interner& strids
+	, unsigned workers)
+{
+	vector<RawIds>  ids;  // Shared ids of the chunks indexed by the local ids
+	ids.reserve(chunks.size());
+	for(auto& chk: chunks) {
+		ids.push_back(strids.merge(chk.strids));
+		chk.strids.clear();
+	}
+	parallelFor(chunks.size(), [&chunks, &ids](size_t i, unsigned) {
+		auto& chk = chunks[i];
+		const auto&  cids = ids[i];
+		chk.idmax = 0;
+		for(auto& chd: chk.cls)
+			for(auto& nid: chd->members) {
+				nid = cids[nid];
+				chk.idmax = max(chk.idmax, nid);
+			}
+	}, workers, 1);
+}
+
+template <typename Count>
+void Collection<Count>::appendClusters(vector<LoadedClusters>& chunks, RawIds* lostcls)
+{
+	size_t  clsnum = m_cls.size();
+	for(const auto& chk: chunks)
+		clsnum += chk.cls.size();
+	if(m_cls.capacity() < clsnum)
+		m_cls.reserve(clsnum);
+	for(auto& chk: chunks) {
+		for(const auto& cid: chk.cidsempty)
+			fprintf(stderr, "WARNING load(), empty cluster"
+				" exists: '%s', skipped\n", cid.c_str());
+		for(const auto& dup: chk.dups)
+			fprintf(stderr, "WARNING load(), #%lu cluster contained %lu duplicated members, corrected.\n"
+				, m_cls.size() + dup.first, size_t(dup.second));
+		if(lostcls) {
+			// Note: the index of the cluster line considers both loaded and lost clusters
+			const size_t  ibase = lostcls->size() + m_cls.size();
+			for(auto icl: chk.lost)
+				lostcls->push_back(ibase + icl);
+		}
+		for(auto& chd: chk.cls) {
+			chd->index = m_cls.size();
+			m_cls.push_back(chd.release());
+		}
+		chk = LoadedClusters();
+	}
+	chunks.clear();
+}
+
+template <typename Count>
+void Collection<Count>::indexNodes(unsigned workers)
+{
+	if(workers <= 1) {
+		for(auto pcl: m_cls)
+			for(auto nid: pcl->members)
+				m_ndcs[nid].push_back(pcl);
+		return;
+	}
+
+	// Split the clusters into the contiguous ranges of the balanced number of members
+	size_t  mbsnum = 0;  // The number of members
+	for(auto pcl: m_cls)
+		mbsnum += pcl->members.size();
+	RawIds  bounds;  // Bounds of the ranges of the clusters
+	bounds.reserve(workers + 1);
+	bounds.push_back(0);
+	size_t  rmbs = 0;  // The number of members in the forming range
+	for(Id icl = 0; icl < m_cls.size(); ++icl) {
+		rmbs += m_cls[icl]->members.size();
+		if(rmbs * workers >= mbsnum * bounds.size() && bounds.size() < workers)
+			bounds.push_back(icl + 1);
+	}
+	if(bounds.back() != m_cls.size())
+		bounds.push_back(m_cls.size());
+
+	// Bucket the memberships of each range of clusters by the node partitions
+	m_ndcs.partition(workers);
+	const size_t  pnum = m_ndcs.partsnum();
+	using Membership = pair<Id, Id>;  // Node id and the cluster index
+	vector<vector<vector<Membership>>>  buckets(bounds.size() - 1, vector<vector<Membership>>(pnum));
+	parallelFor(buckets.size(), [this, &bounds, &buckets, pnum](size_t ir, unsigned) {
+		auto&  rbks = buckets[ir];
+		size_t  rmbs = 0;  // The number of members in the range
+		for(Id icl = bounds[ir]; icl < bounds[ir + 1]; ++icl)
+			rmbs += m_cls[icl]->members.size();
+		for(auto& bk: rbks)
+			bk.reserve(rmbs / pnum + 1);
+		for(Id icl = bounds[ir]; icl < bounds[ir + 1]; ++icl)
+			for(auto nid: m_cls[icl]->members)
+				rbks[m_ndcs.partOf(nid)].emplace_back(nid, icl);
+	}, workers, 1);
+	// Index each partition from its buckets in the ranges order, so the
+	// clusters of each node are ordered as on the sequential indexing
+	parallelFor(pnum, [this, &buckets](size_t ip, unsigned) {
+		auto&  ndcs = m_ndcs.part(ip);
+		for(auto& rbks: buckets) {
+			for(const auto& mb: rbks[ip])
+				ndcs[mb.first].push_back(m_cls[mb.second]);
+			vector<Membership>().swap(rbks[ip]);  // Free the memory
+		}
+	}, workers, 1);
+}
+
+template <typename Count>
+void Collection<Count>::indexShares()
+{
+	if(!m_overlaps)
+		return;
+	parallelFor(m_cls.size(), [this](size_t icl, unsigned) {
+		Cluster<Count>* const  pcl = m_cls[icl];
+		auto&  shares = pcl->shares;
+		shares.clear();
+		shares.reserve(pcl->members.size());
+		for(auto nid: pcl->members)
+			shares.push_back(nodeShare(m_ndcs.at(nid), pcl));
+	}, workersNum(m_cls.size()));
+}
+
 template <typename Count>
 template <bool FIRST>
-void Collection<Count>::transfer(RawClusters& cls, NodeRClusters& ndrcs)
+void Collection<Count>::transfer(RawClusters& cls, NodeRClusters& ndrcs, bool retain)
 {
+	// Note: the shared clusters are retained for their origin
+	retain = retain || m_origin;
 	// Clear node clusters relations of the collection
-	m_ndcs.clear();
-	m_ndcs.rehash(0);
+	if(!retain) {
+		m_ndcs.clear();
+		m_ndcs.rehash(0);
+	}
 	// Prepare target containers
 	cls.reserve(m_cls.size());
-	ndrcs.reserve(m_ndcs.size());
+	ndrcs.reserve(ndcs().size());
 
 	for(auto cl: m_cls) {
-		cls.push_back(move(cl->members));
-		delete cl;
+		if(retain)
+			cls.push_back(cl->members);
+		else {
+			cls.push_back(move(cl->members));
+			delete cl;
+		}
 		auto& craw = cls.back();
 		for(auto nd: craw)
 			pairsel<FIRST>(ndrcs[nd]).push_back(&craw);
@@ -384,23 +1119,124 @@ void Collection<Count>::transfer(RawClusters& cls, NodeRClusters& ndrcs)
 		sort(pairsel<FIRST>(val.second).begin(), pairsel<FIRST>(val.second).end(), cmpBase<RawCluster*>);
 
 	// Clear collection clusters
-	m_cls.clear();
-	m_cls.shrink_to_fit();
+	if(!retain) {
+		m_cls.clear();
+		m_cls.shrink_to_fit();
+	}
+}
+
+template <typename Count>
+template <bool FIRST>
+void Collection<Count>::degrees(NodeRDegrees& nddgs) const
+{
+	if(nddgs.bucket_count() * nddgs.max_load_factor() < ndcs().size())
+		nddgs.reserve(ndcs().size());
+	for(const auto& ncs: ndcs()) {
+		const auto&  owners = ncs.second;
+		AccProb  shmax = 0;  // Max share of the node
+		for(size_t i = 0; i < owners.size(); ++i)
+			shmax = max(shmax, nodeShare(owners, i));
+		auto&  dgs = pairsel<FIRST>(nddgs[ncs.first]);
+		dgs.reserve(owners.size());
+		for(size_t i = 0; i < owners.size(); ++i)
+			dgs.emplace_back(owners[i]->index, nodeShare(owners, i) / shmax);
+		sort(dgs.begin(), dgs.end());
+	}
 }
 
 template <typename Count>
 void Collection<Count>::clearcounts() const noexcept
 {
-	for(auto cl: m_cls)
-		cl->counter.clear();
+	for(auto& cnt: m_counters)
+		cnt.clear();
+}
+
+template <typename Count>
+void Collection<Count>::prepstate() const
+{
+	if(m_counters.size() == m_cls.size())
+		return;
+	m_counters.resize(m_cls.size());
+	m_conts.resize(m_cls.size());
+}
+
+template <typename Count>
+size_t Collection<Count>::memsize() const noexcept
+{
+	size_t  mem = m_cls.capacity() * sizeof(Cluster<Count>*) + m_counters.capacity()
+		* sizeof(Counter<Count>) + m_conts.capacity() * sizeof(Count);
+	// Note: the shared clusters and node memberships are held by the origin
+	if(m_origin)
+		return mem;
+	mem += m_cls.size() * sizeof(Cluster<Count>);
+	for(auto pcl: m_cls)
+		mem += pcl->members.capacity() * sizeof(Id) + pcl->shares.capacity() * sizeof(AccProb);
+	// Note: each hashed node holds the pointer to the next one besides its value
+	mem += m_ndcs.bucket_count() * sizeof(void*) + m_ndcs.size()
+		* (sizeof(typename NodeClusters<Count>::value_type) + sizeof(void*));
+	for(const auto& ncs: m_ndcs)
+		mem += ncs.second.capacity() * sizeof(Cluster<Count>*) + sharesMem(ncs.second);
+	return mem;
+}
+
+template <typename Count>
+template <typename Dst>
+Collection<Dst> Collection<Count>::clone(size_t clsnum) const
+{
+	Collection<Dst>  cn;  // Return using NRVO, named return value optimization
+	if(!clsnum || clsnum > m_cls.size())
+		clsnum = m_cls.size();
+	cn.m_cls.reserve(clsnum);
+	for(size_t i = 0; i < clsnum; ++i) {
+		ClusterHolder<Dst>  chd(new Cluster<Dst>());
+		chd->members = m_cls[i]->members;
+		chd->index = m_cls[i]->index;
+		cn.m_cls.push_back(chd.release());
+	}
+	// Note: the node clusters are mapped by the cluster indices
+	cn.m_ndcs.reserve(ndcs().size());
+	for(const auto& ndcl: ndcs()) {
+		// Skip the nodes of the omitted clusters, which own them exclusively
+		if(ndcl.second.front()->index >= clsnum)
+			continue;
+		auto&  cls = cn.m_ndcs[ndcl.first];
+		cls.reserve(ndcl.second.size());
+		for(auto pcl: ndcl.second)
+			cls.push_back(cn.m_cls[pcl->index]);
+		copyShares(cls, ndcl.second);
+	}
+	cn.indexShares();
+	if(clsnum == m_cls.size())
+		cn.m_ndshash = m_ndshash;
+	else {
+		::AggHash  mbhash;
+		for(const auto& ndcl: cn.m_ndcs)
+			mbhash.add(ndcl.first);
+		cn.m_ndshash = mbhash.hash();
+	}
+	return cn;
+}
+
+template <typename Count>
+Collection<Count> Collection<Count>::share() const
+{
+	Collection  cn;  // Return using NRVO, named return value optimization
+	cn.m_origin = m_origin ? m_origin : this;
+	// Note: the cluster pointers are copied to be traversed uniformly
+	cn.m_cls = m_cls;
+	cn.m_ndshash = m_ndshash;
+	cn.prepstate();
+	return cn;
 }
 
 template <typename Count>
 PrcRec Collection<Count>::label(const CollectionT& gt, const CollectionT& cn  //, const RawIds& lostcls
-	, bool prob, bool weighted, const char* flname) //, bool verbose)
+	, bool prob, bool weighted, const char* flname, bool binary, ClsLabels* csls) //, bool verbose)
 {
+	gt.prepstate();
+	cn.prepstate();
 	// Initialized accessory data for evaluations if has not been done yet
-	// (nmi also initializes mbscont)
+	// (nmi also initializes the members contributions)
 	if(is_floating_point<Count>::value && !(gt.m_contsum && cn.m_contsum)) {  // Note: strict ! is fine here
 		// Evaluate members contributions
 		initconts(gt);
@@ -415,41 +1251,101 @@ PrcRec Collection<Count>::label(const CollectionT& gt, const CollectionT& cn  //
 	// ATTENTION: mark() (and gmatches() changes internal state of the collection parameter, so
 	// it should be called only once for each collection and with the same value of prob
 	// Note: it's more convenient for the subsequent processing to assign labels to the clusters
-	ClsLabels  csls;  // Clusters labels to be outputted
-	auto pr = gt.mark(cn, prob, weighted, &csls);
+	ClsLabels  lbs;  // Clusters labels to be outputted
+	if(!csls)
+		csls = &lbs;
+	auto pr = gt.mark(cn, prob, weighted, csls);
 
 	// Evaluate labels for each node by the node clusters and cluster labels
 
 	// Output the resulting clusters labels to the specified file if required
 	if(flname) {
 		// Create the output file
-		NamedFileWrapper  flbs(flname, "w");
-		if(flbs) {
-			fprintf(flbs, "# Clusters: %lu, Labels: %lu\n", csls.size(), gt.m_cls.size());
-			// Map labels to their indices
-			using LabelIndices = unordered_map<Cluster<Count>*, Id>;
-			LabelIndices  lids;
-			lids.reserve(gt.m_cls.size());
-            for(size_t i = 0; i < gt.m_cls.size(); ++i)
-				lids[gt.m_cls[i]] = i;
-			// Output clusters marked with label indices
-			for(auto cl: cn.m_cls) {
-				auto iclbs = csls.find(cl);
-				if(iclbs == csls.end()) {
-					fprintf(flbs, "-\n");
-					continue;
-				}
-				for(auto lb: iclbs->second)
-					fprintf(flbs, "%u ", lids.at(lb));
-				fputs("\n", flbs);
-			}
-		} else fprintf(stderr, "WARNING label(), labels output is omitted"
-			": '%s' file can't be created\n", flname);
+		NamedFileWrapper  flbs(flname, binary ? "wb" : "w");
+		if(!flbs)
+			fprintf(stderr, "WARNING label(), labels output is omitted"
+				": '%s' file can't be created\n", flname);
+		else if(!writeLabels(flbs, gt, cn, *csls, binary))
+			perror((string("WARNING label(), labels output failed to ") += flname).c_str());
 	}
 
 	return pr;
 }
 
+template <typename Count>
+void Collection<Count>::labelIndices(const CollectionT& cn, const ClsLabels& csls
+	, vector<uint64_t>& offsets, RawIds& marks)
+{
+	offsets.clear();
+	offsets.reserve(cn.m_cls.size() + 1);
+	offsets.push_back(0);
+	marks.clear();
+	marks.reserve(csls.size());
+	for(auto cl: cn.m_cls) {
+		const auto  iclbs = csls.find(cl);
+		if(iclbs != csls.end()) {
+			const size_t  ibeg = marks.size();
+			for(auto lb: iclbs->second)
+				marks.push_back(lb->index);
+			sort(marks.begin() + ibeg, marks.end());
+		}
+		offsets.push_back(marks.size());
+	}
+}
+
+template <typename Count>
+bool Collection<Count>::writeLabels(FILE* fout, const CollectionT& gt, const CollectionT& cn
+	, const ClsLabels& csls, bool binary)
+{
+	// Note: the labels are ordered by address, so they are outputted by the
+	// cluster indices to not depend on the clusters allocation
+	if(binary) {
+		ClbHeader  hdr;
+		memset(&hdr, 0, sizeof hdr);
+		memcpy(hdr.magic, ClbHeader::MAGIC, sizeof hdr.magic);
+		hdr.version = ClbHeader::VERSION;
+		hdr.idbytes = sizeof(Id);
+		hdr.clsnum = cn.m_cls.size();
+		hdr.lbsnum = gt.m_cls.size();
+		vector<uint64_t>  offsets;
+		RawIds  marks;  // Label indices of all clusters
+		labelIndices(cn, csls, offsets, marks);
+		hdr.mrksnum = marks.size();
+		return fwrite(&hdr, sizeof hdr, 1, fout) == 1
+			&& fwrite(offsets.data(), sizeof(uint64_t), offsets.size(), fout) == offsets.size()
+			&& fwrite(marks.data(), sizeof(Id), marks.size(), fout) == marks.size();
+	}
+
+	fprintf(fout, "# Clusters: %lu, Labels: %lu\n", csls.size(), gt.m_cls.size());
+	// Output clusters marked with label indices formatting them into the buffer
+	constexpr size_t  bufmax = 1 << 20;  // Size of the flushed buffer, 1 MB
+	vector<char>  buf;
+	buf.reserve(bufmax);
+	RawIds  clbs;  // Label indices of the cluster
+	for(auto cl: cn.m_cls) {
+		const auto  iclbs = csls.find(cl);
+		if(iclbs == csls.end())
+			buf.push_back('-');
+		else {
+			clbs.clear();
+			for(auto lb: iclbs->second)
+				clbs.push_back(lb->index);
+			sort(clbs.begin(), clbs.end());
+			for(auto lb: clbs) {
+				appendDecimal(buf, lb);
+				buf.push_back(' ');
+			}
+		}
+		buf.push_back('\n');
+		if(buf.size() >= bufmax) {
+			if(fwrite(buf.data(), 1, buf.size(), fout) != buf.size())
+				return false;
+			buf.clear();
+		}
+	}
+	return fwrite(buf.data(), 1, buf.size(), fout) == buf.size();
+}
+
 template <typename Count>
 PrcRec Collection<Count>::mark(const CollectionT& cn, bool prob, bool weighted, ClsLabels* csls) const
 {
@@ -474,29 +1370,36 @@ PrcRec Collection<Count>::mark(const CollectionT& cn, bool prob, bool weighted,
 	// the node base is not synchronized
 	Id lbmissed = 0;
 	AccProb  accw = 0;  // Accumulated weight of the labels or just their number (if !weighted)
+	const auto&  ndcs2 = cn.ndcs();
 
 	for(auto gtc: m_cls) {
 		Prob  gmatch = 0; // Greatest value of the match (F1 or partial probability)
+		const Count  gtcont = m_conts[gtc->index];  // Members contribution of the label
 		// Traverse all members (node ids)
-		for(auto nid: gtc->members) {
+		for(size_t im = 0; im < gtc->members.size(); ++im) {
+			const Id  nid = gtc->members[im];
 			// Find Matching clusters (containing the same member node id) in the foreign collection
-			const auto imcls = cn.m_ndcs.find(nid);
+			const auto imcls = ndcs2.find(nid);
 			// Consider the case of unequal node base, i.e. missed node
-			if(imcls == cn.m_ndcs.end())
+			if(imcls == ndcs2.end())
 				continue;
-			for(auto mcl: imcls->second) {
+			// Note: the share of the node in the label is evaluated only for the overlaps
+			const AccProb  gtshare = m_overlaps ? gtc->shares[im] : 1;
+			for(size_t i = 0; i < imcls->second.size(); ++i) {
+				Cluster<Count>* const  mcl = imcls->second[i];
+				auto&  mcnt = cn.m_counters[mcl->index];
 				// Greatest matches (Max F1 or partial probability) for each ground-truth cluster
 				// [of this collection, self] (label);
 				if(m_overlaps)
-					// In case of overlap contributes the smallest share (of the largest number of owners)
-					mcl->counter(gtc, AccProb(1)
-						/ max(m_ndcs.at(nid).size(), cn.m_ndcs.at(nid).size()));
-				else mcl->counter(gtc, 1);
+					// In case of overlap contributes the smallest share of the node,
+					// which is the share of the largest number of owners for the equal shares
+					mcnt(gtc, min(gtshare, nodeShare(imcls->second, i)));
+				else mcnt(gtc, 1);
 				// Note: only the max value for match is sufficient
 				// ATTENTION: F1 compares clusters per-pair, so it is much simpler and
 				// has another semantics of contribution for the multi-resolution case
-				const Prob  match = (gtc->*fmatch)(mcl->counter(), m_overlaps
-					? mcl->cont() : mcl->members.size());
+				const Prob  match = (gtc->*fmatch)(mcnt(), m_overlaps
+					? cn.m_conts[mcl->index] : mcl->members.size(), gtcont);
 				if(!less<Prob>(match, gmatch)) {
 					if(!equal<Prob>(match, gmatch)) {
 						gmatch = match;
@@ -542,15 +1445,15 @@ PrcRec Collection<Count>::mark(const CollectionT& cn, bool prob, bool weighted,
 		if(mnds.empty()) {
 			// The label marked a single cluster
 			auto& mcl = **mcands.begin();
-			AccProb  gm = mcl.counter();  // Matches
+			AccProb  gm = cn.m_counters[mcl.index]();  // Matches
 			if(weighted)
 				gm *= gtc->members.size();
-			prc += gm / static_cast<AccProb>(m_overlaps ? mcl.cont() : mcl.members.size());
-			rec += gm / static_cast<AccProb>(m_overlaps ? gtc->cont() : gtc->members.size());
+			prc += gm / static_cast<AccProb>(m_overlaps ? cn.m_conts[mcl.index] : mcl.members.size());
+			rec += gm / static_cast<AccProb>(m_overlaps ? gtcont : gtc->members.size());
 #if TRACE >= 3
 			printf("  > mark(), gmatch: %G, gm: %G, accumulated prc: %G (mcl cont: %G), rec: %G (gtc cont: %G)\n"
-				, gmatch, gm, prc, static_cast<AccProb>(m_overlaps ? mcl.cont() : mcl.members.size())
-				, rec, static_cast<AccProb>(m_overlaps ? gtc->cont() : gtc->members.size()));
+				, gmatch, gm, prc, static_cast<AccProb>(m_overlaps ? cn.m_conts[mcl.index] : mcl.members.size())
+				, rec, static_cast<AccProb>(m_overlaps ? gtcont : gtc->members.size()));
 #endif // TRACE
 		} else {
 			// The label marked multiple clusters, compared it's nodes with the
@@ -562,18 +1465,18 @@ PrcRec Collection<Count>::mark(const CollectionT& cn, bool prob, bool weighted,
 			if(m_overlaps) {
 				AccProb  accont = 0;  // Accumulated contribution
 				for(auto cl: mcands) {
-					accgm += cl->counter();
-					accont += cl->cont();
+					accgm += cn.m_counters[cl->index]();
+					accont += cn.m_conts[cl->index];
 				}
 #if TRACE >= 2
-				assert(!less<Prob>(min<AccProb>(accont, gtc->cont()), accgm)
+				assert(!less<Prob>(min<AccProb>(accont, gtcont), accgm)
 					&& "mark(), accgm ovp validation failed");
 #endif // TRACE
 				if(weighted)
 					accgm *= gtc->members.size();
 				prc += accgm / static_cast<AccProb>(accont);
 				// Note: mnds.size() <= mcands.size()
-				rec += accgm / static_cast<AccProb>(gtc->cont());
+				rec += accgm / static_cast<AccProb>(gtcont);
 			} else {
 				// Evaluate the number of matched nodes from the aggregated clusters (<= sum(cls_matches))
 				for(auto nid: gtc->members)
@@ -595,10 +1498,10 @@ PrcRec Collection<Count>::mark(const CollectionT& cn, bool prob, bool weighted,
 	fputs("\n", stderr);
 #endif // TRACE
 	if(lbmissed)
-		fprintf(stderr, "WARNING mark(), the number of non-matched labels: %u"
-			" (possible only when the node base is not synchronized)\n", lbmissed);
+		fprintf(stderr, "WARNING mark(), the number of non-matched labels: %lu"
+			" (possible only when the node base is not synchronized)\n", size_t(lbmissed));
 #if TRACE >= 2
-	fprintf(stderr, "  >> mark(), multi-cluster labels %u / %lu\n", nmlbs, m_cls.size());
+	fprintf(stderr, "  >> mark(), multi-cluster labels %lu / %lu\n", size_t(nmlbs), m_cls.size());
 #endif // TRACE
 #if VALIDATE >= 2
 	if(!weighted)
@@ -615,14 +1518,11 @@ void Collection<Count>::initconts(const CollectionT& cn) noexcept
 	if(cn.m_contsum)
 		return;
 
-	for(auto& ndcs: cn.m_ndcs) {
-		// ATTENTION: in case of fuzzy (unequal) overlaps the shares are unequal and
-		// should be stored in the Collection (ncs clusters member or a map)
-		const AccProb  ndshare = AccProb(1) / ndcs.second.size();
-		for(auto cl: ndcs.second)
-			cl->mbscont += ndshare;
-	}
-	// Mark that mbscont of clusters are used
+	// Note: the shares of fuzzy (unequal) overlaps are stored with the node owners
+	for(const auto& ncs: cn.ndcs())
+		for(size_t i = 0; i < ncs.second.size(); ++i)
+			cn.m_conts[ncs.second[i]->index] += nodeShare(ncs.second, i);
+	// Mark that the members contributions of clusters are used
 	cn.m_contsum = -1;
 }
 
@@ -635,8 +1535,10 @@ Prob Collection<Count>::f1(const CollectionT& cn1, const CollectionT& cn2, F1 ki
 		return 0;
 	}
 
+	cn1.prepstate();
+	cn2.prepstate();
 	// Initialized accessory data for evaluations if has not been done yet
-	// (nmi also initializes mbscont)
+	// (nmi also initializes the members contributions)
 	if(is_floating_point<Count>::value && !(cn1.m_contsum && cn2.m_contsum)) {  // Note: strict ! is fine here
 		// Evaluate members contributions
 		initconts(cn1);
@@ -713,7 +1615,7 @@ AccProb Collection<Count>::avggms(const Probs& gmats, bool weighted) const  // c
 			// Evaluate members considering their shared contributions
 			// ATTENTION: F1 compares clusters per-pair, so it is much simpler and
 			// has another semantics of contribution for the multi-resolution case
-			AccCont  ccont = m_overlaps ? (*icl)->cont() : (*icl)->members.size();
+			AccCont  ccont = m_overlaps ? m_conts[(*icl)->index] : (*icl)->members.size();
 #if VALIDATE >= 2
 			assert(ccont > 0 && "avggms(), the contribution should be positive");
 #endif // VALIDATE
@@ -758,34 +1660,41 @@ Probs Collection<Count>::gmatches(const CollectionT& cn, bool prob) const
 	// Function evaluating value of the match
 	auto fmatch = prob ? &Cluster<Count>::pprob : &Cluster<Count>::f1;
 
+	const auto&  ndcs2 = cn.ndcs();
 	// Traverse all clusters in the collection
 	for(auto cl: m_cls) {
 		Prob  gmatch = 0; // Greatest value of the match (F1 or partial probability)
-		//fprintf(stderr, "> gmatches() %#x (counter: %u (%#x), mbscont: %u) %lu mbs\n"
-		//	, cl, cl->counter(), cl->counter.origin(), cl->mbscont, cl->members.size());
+		const Count  clcont = m_conts[cl->index];  // Members contribution of the cluster
+		//fprintf(stderr, "> gmatches() %#x (counter: %u (%#x), cont: %u) %lu mbs\n"
+		//	, cl, m_counters[cl->index](), m_counters[cl->index].origin(), clcont, cl->members.size());
 		//for(auto v: cl->members)
 		//	printf(" %u", v);
 		//puts("");
 		// Traverse all members (node ids)
-		for(auto nid: cl->members) {
+		for(size_t im = 0; im < cl->members.size(); ++im) {
+			const Id  nid = cl->members[im];
 			// Find Matching clusters (containing the same member node id) in the foreign collection
-			const auto imcls = cn.m_ndcs.find(nid);
+			const auto imcls = ndcs2.find(nid);
 			// Consider the case of unequal node base, i.e. missed node
-			if(imcls == cn.m_ndcs.end())
+			if(imcls == ndcs2.end())
 				continue;
-			for(auto mcl: imcls->second) {
-				//fprintf(stderr, ">> gmatches() #%u nid, mcl %#x (counter: %u (%#x), mbscont: %u) %lu mbs\n"
-				//	, nid, mcl, mcl->counter(), mcl->counter.origin(), mcl->mbscont, mcl->members.size());
+			// Note: the share of the node in the cluster is evaluated only for the overlaps
+			const AccProb  clshare = m_overlaps ? cl->shares[im] : 1;
+			for(size_t i = 0; i < imcls->second.size(); ++i) {
+				Cluster<Count>* const  mcl = imcls->second[i];
+				auto&  mcnt = cn.m_counters[mcl->index];
+				//fprintf(stderr, ">> gmatches() #%u nid, mcl %#x (counter: %u (%#x), cont: %u) %lu mbs\n"
+				//	, nid, mcl, mcnt(), mcnt.origin(), cn.m_conts[mcl->index], mcl->members.size());
 				if(m_overlaps)
-					// In case of overlap contributes the smallest share (of the largest number of owners)
-					mcl->counter(cl, AccProb(1)
-						/ max(m_ndcs.at(nid).size(), cn.m_ndcs.at(nid).size()));
-				else mcl->counter(cl, 1);
+					// In case of overlap contributes the smallest share of the node,
+					// which is the share of the largest number of owners for the equal shares
+					mcnt(cl, min(clshare, nodeShare(imcls->second, i)));
+				else mcnt(cl, 1);
 				// Note: only the max value for match is sufficient
 				// ATTENTION: F1 compares clusters per-pair, so it is much simpler and
 				// has another semantics of contribution for the multi-resolution case
-				const Prob  match = (cl->*fmatch)(mcl->counter(), m_overlaps
-					? mcl->cont() : mcl->members.size());
+				const Prob  match = (cl->*fmatch)(mcnt(), m_overlaps
+					? cn.m_conts[mcl->index] : mcl->members.size(), clcont);
 				if(gmatch < match)  // Note: <  usage is fine here
 					gmatch = match;
 			}
@@ -898,18 +1807,18 @@ RawNmi Collection<Count>::nmi(const CollectionT& cn, bool expbase) const
 	for(const auto& icm: clsmm) {
 		// Evaluate information size (content) of the current cluster in the cn1
 		// infocont(Accumulated value of the current cluster from cn1, the number of nodes)
-		h1 -= infocont(icm.first->cont(), m_contsum);  // ndsnum(), cmmsum
+		h1 -= infocont(m_conts[icm.first->index], m_contsum);  // ndsnum(), cmmsum
 
 		// Travers row
 #ifdef TRACING_CLSMM_
-		fprintf(stderr, "%.3G:  ", AccProb(icm.first->cont()));
+		fprintf(stderr, "%.3G:  ", AccProb(m_conts[icm.first->index]));
 #endif // TRACING_CLSMM_
 		for(auto& icmr: icm.second) {
 #if VALIDATE >= 2
 			assert(icmr.val > 0 && "nmi(), matrix of clusters matching should contain only positive values");
 #endif // VALIDATE
 #ifdef TRACING_CLSMM_
-			fprintf(stderr, " %G[%.3G]", AccProb(icmr.val), AccProb(icmr.pos->cont()));
+			fprintf(stderr, " %G[%.3G]", AccProb(icmr.val), AccProb(cn.m_conts[icmr.pos->index]));
 #endif // TRACING_CLSMM_
 #if VALIDATE >= 2
 			// Evaluate mutual probability of the cluster (divide by multiplication of counts of both clusters)
@@ -917,7 +1826,7 @@ RawNmi Collection<Count>::nmi(const CollectionT& cn, bool expbase) const
 #endif // VALIDATE
 			// Accumulate total normalized mutual information
 			// Note: e base is used instead of 2 to have absolute entropy instead of bits length
-			//const auto lval = icmr.val / (icmr.pos->cont() * cprob);  // cprob; icm.first->mbscont
+			//const auto lval = icmr.val / (cn.m_conts[icmr.pos->index] * cprob);  // cprob; m_conts[icm.first->index]
 			//mi += mcprob * clog(lval);  // mi = h1 + h2 - h12;  Note: log(a/b) = log(a) - log(b)
 
 			// Note: in the original NMI: AccProb(icmr.val) / nodesNum [ = cmmsum]
@@ -935,7 +1844,7 @@ RawNmi Collection<Count>::nmi(const CollectionT& cn, bool expbase) const
 	// Evaluate information size cn2 clusters
 	AccProb  h2 = 0;  // H(cn2) - information size of the cn1 in exp base
 	for(const auto& c2: cn.m_cls)
-		h2 -= infocont(c2->cont(), cn.m_contsum);  // cn.ndsnum(), cmmsum
+		h2 -= infocont(cn.m_conts[c2->index], cn.m_contsum);  // cn.ndsnum(), cmmsum
 
 	Prob  mi = h1 + h2 - h12;
 #if VALIDATE >= 2
@@ -957,6 +1866,155 @@ RawNmi Collection<Count>::nmi(const CollectionT& cn, bool expbase) const
 	return rnmi;
 }
 
+template <typename Count>
+RawOnmi Collection<Count>::onmi(const CollectionT& cn1, const CollectionT& cn2, bool verbose)
+{
+	RawOnmi  ronmi;
+	if(!cn1.clsnum() || !cn2.clsnum())
+		return ronmi;
+
+	// Evaluate the node base as the union of nodes of both collections
+	Id  ndsnum = cn1.ndsnum();
+	if(!(cn1.m_ndshash && cn1.m_ndshash == cn2.m_ndshash && cn1.ndsnum() == cn2.ndsnum())) {
+		for(const auto& ncs: cn2.ndcs())
+			ndsnum += !cn1.ndcs().count(ncs.first);
+	}
+
+	const CondEntropy  ch12 = cn1.condh(cn2, ndsnum);
+	const CondEntropy  ch21 = cn2.condh(cn1, ndsnum);
+	// I(X:Y) = 1/2 * (H(X) - H(X|Y) + H(Y) - H(Y|X))
+	Prob  mi = (ch12.h - ch12.hc + ch21.h - ch21.hc) / 2;
+	if(fabs(mi) < precision_limit<Prob>())
+		mi = 0;
+	ronmi.mi = mi;
+	ronmi.h1 = ch12.h;
+	ronmi.h2 = ch21.h;
+	// NMI_lfk = 1 - 1/2 * (H(X|Y)_norm + H(Y|X)_norm)
+	ronmi.lfk = 1 - (ch12.hcn / cn1.clsnum() + ch21.hcn / cn2.clsnum()) / 2;
+#if TRACE <= 1
+	if(verbose)
+#endif // TRACE
+	fprintf(verbose ? stdout : stderr, "onmi(), %lu nodes,  mi: %G,  h1: %G (h1|2: %G),  h2: %G (h2|1: %G)"
+		",  NMI_lfk: %G\n", size_t(ndsnum), ronmi.mi, ch12.h, ch12.hc, ch21.h, ch21.hc, ronmi.lfk);
+	return ronmi;
+}
+
+template <typename Count>
+CondEntropy Collection<Count>::condh(const CollectionT& cn, Id ndsnum) const
+{
+	//! \brief Information content (entropy) of the nodes subset
+	//!
+	//! \param w AccId  - the number of nodes in the subset
+	//! \return AccProb  - resulting information content h(w, ndsnum)
+	const AccProb  ndsnorm = ndsnum;
+	auto infocont = [ndsnorm](AccId w) -> AccProb {
+		if(!w)
+			return 0;
+		const AccProb  prob = w / ndsnorm;
+		return -prob * log2(prob);
+	};
+	//! \brief Information content of the cluster, H(X_k)
+	//!
+	//! \param csize AccId  - the number of members in the cluster
+	//! \return AccProb  - resulting information content
+	auto clinfo = [infocont, ndsnum](AccId csize) -> AccProb {
+		return infocont(csize) + infocont(ndsnum - csize);
+	};
+
+	// Distinct sizes of the foreign clusters with their numbers ordered by
+	// the size descending to consider non-intersecting clusters
+	using SizeCount = pair<Id, Id>;
+	vector<SizeCount>  szcnts;
+	{
+		unordered_map<Id, Id>  cszs;
+		for(auto cl: cn.m_cls)
+			++cszs[cl->members.size()];
+		szcnts.assign(cszs.begin(), cszs.end());
+	}
+	sort(szcnts.begin(), szcnts.end(), [](const SizeCount& a, const SizeCount& b) noexcept {
+		return a.first > b.first;
+	});
+
+	// Intersection of the cluster with the foreign clusters, which is evaluated
+	// by each worker for each cluster of this collection
+	using ClsIsect = SparseMatrixRowVec<Cluster<Count>*, Id>;
+	const unsigned  workers = workersNum(m_cls.size(), 16);
+	vector<ClsIsect>  isects(workers);
+	// Results for each cluster to have the deterministic accumulation
+	vector<pair<AccProb, AccProb>>  clhs(m_cls.size());  // H(X_k), H(X_k|Y)
+
+	parallelFor(m_cls.size(), [&](size_t icl, unsigned wid) {
+		const auto  cl = m_cls[icl];
+		auto&  isect = isects[wid];
+		isect.clear();
+		for(auto nid: cl->members) {
+			const auto  imcls = cn.ndcs().find(nid);
+			// Consider the case of unequal node base, i.e. missed node
+			if(imcls == cn.ndcs().end())
+				continue;
+			for(auto mcl: imcls->second) {
+				auto  ii = fast_ifind(isect, mcl, bsObjOp<RowVecItem<Cluster<Count>*, Id>>);
+				if(ii == isect.end() || ii->pos != mcl)
+					ii = isect.emplace(ii, mcl, 0);
+				++ii->val;
+			}
+		}
+
+		const AccId  csize = cl->members.size();
+		const AccProb  hx = clinfo(csize);
+		AccProb  hxy = hx;  // H(X_k|Y), which is H(X_k) if the constraint is not satisfied for any Y_l
+
+		//! \brief Update H(X_k|Y) with the conditional entropy H(X_k|Y_l)
+		//!
+		//! \param ysize AccId  - the number of members in Y_l
+		//! \param mutual AccId  - the number of mutual members of X_k and Y_l
+		auto updcond = [&](AccId ysize, AccId mutual) {
+			const AccProb  ha = infocont(ndsnum + mutual - csize - ysize);  // Neither in X_k nor in Y_l
+			const AccProb  hb = infocont(ysize - mutual);  // Only in Y_l
+			const AccProb  hc = infocont(csize - mutual);  // Only in X_k
+			const AccProb  hd = infocont(mutual);  // Both in X_k and Y_l
+			// Omit the matches, where the mutual information is not greater than
+			// the mismatches (the constraint of Lancichinetti et al.)
+			if(ha + hd < hb + hc)
+				return;
+			const AccProb  hcond = ha + hb + hc + hd - clinfo(ysize);
+			if(hcond < hxy)
+				hxy = hcond;
+		};
+
+		for(const auto& ic: isect)
+			updcond(ic.pos->members.size(), ic.val);
+		// Non-intersecting clusters can satisfy the constraint only if the
+		// number of their non-members is less than a half of the nodes
+		for(const auto& szc: szcnts) {
+			if((csize + szc.first) * 2 <= ndsnum)
+				break;
+			// Check whether the non-intersecting clusters of this size exist
+			Id  nisect = 0;
+			for(const auto& ic: isect)
+				nisect += ic.pos->members.size() == szc.first;
+			if(nisect < szc.second)
+				updcond(szc.first, 0);
+		}
+		clhs[icl] = {hx, hxy};
+	}, workers);
+
+	CondEntropy  ch;  // Return using NRVO, named return value optimization
+	for(const auto& clh: clhs) {
+		ch.h += clh.first;
+		ch.hc += clh.second;
+		// Note: the cluster covering all nodes has zero entropy and is
+		// predicted fully by any cluster
+		if(clh.first > 0)
+			ch.hcn += clh.second / clh.first;
+	}
+#if TRACE >= 2
+	fprintf(stderr, "condh(), %lu clusters processed by %u workers, h: %G, hc: %G, hcn: %G\n"
+		, m_cls.size(), workers, ch.h, ch.hc, ch.hcn);
+#endif // TRACE
+	return ch;
+}
+
 template <typename Count>
 auto Collection<Count>::evalconts(const CollectionT& cn, ClustersMatching* pclsmm) const -> AccCont
 {
@@ -975,37 +2033,23 @@ auto Collection<Count>::evalconts(const CollectionT& cn, ClustersMatching* pclsm
 #endif // VALIDATE
 
 	// Reset member contributions if not zero
+	prepstate();
+	cn.prepstate();
 	clearconts();
 	cn.clearconts();
 
-    //! \brief Contribution from the member of clusters
-    //!
-    //! \param owners  - the number of owner clusters of the member
-    //! \return AccProb - resulting contribution to a single owner
-    // Note: in contribute equally to each upper cluster on each resolution, where
+    // Note: the member contributes entirely to each upper cluster on each resolution, where
     // only one relevant cluster on each resolution should exists. Multi-resolution
     // structure should have the same node base of each resolution, otherwise
     // overlapping evaluation is more fair. In fact overlaps is generalization of
     // the multi-resolution evaluation, but can't be directly applied to the
     // case of multi-resolution overlapping case, where 2-level (by levels and
 	// by overlaps in each level) evaluations are required.
-	auto mbcont = [](size_t owners) -> AccCont {
-		static_assert(!m_overlaps || is_floating_point<AccCont>::value
-			, "mbcont(), invalid types");
-		return m_overlaps ? AccCont(1) / owners : AccCont(1);
-	};
-
-    //! \brief  Update contribution of to the member-related clusters
-    //!
-    //! \param cls const ClusterPtrs&  - clusters to be updated
-    //! \return AccProb  - contributing value (share in case of overlaps in a single resolution)
-    // ATTENTION: Such evaluation is applicable only for non-fuzzy overlaps (equal sharing)
-	auto updateCont = [mbcont](const ClusterPtrs<Count>& cls) -> AccCont {
-		const AccCont  share = mbcont(cls.size());
-		for(auto cl: cls)
-			cl->mbscont += share;
-		return share;
-	};
+	//
+	// Note: the contribution of the member is its share in the cluster, which
+	// is unequal for the fuzzy overlaps and equals 1 for the multiple resolutions
+	static_assert(!m_overlaps || is_floating_point<AccCont>::value
+		, "evalconts(), invalid types");
 
 	ClustersMatching  clsmm = ClustersMatching(clsnum());  // Note: default max_load_factor is 1
 	// Total sum of all values of the clsmm matrix, i.e. the number of
@@ -1018,54 +2062,70 @@ auto Collection<Count>::evalconts(const CollectionT& cn, ClustersMatching* pclsm
 	//
 	// ATTENTION: For 2+ levels cmmsum equals mbsnum * levs_num, in case of overlaps
 	// it also > mbsnum.
-	// =>  .mbscont is ALWAYS required except the case of non-overlapping clustering
+	// =>  m_conts is ALWAYS required except the case of non-overlapping clustering
 	// on a single resolution
 
 	// Consider the case of unequal node base, contribution from the missed nodes
 	AccCont  econt1 = 0;  // Extra contribution from this collection
-	for(auto& ncs: m_ndcs) {
+	const auto&  ndcs1 = ndcs();
+	const auto&  ndcs2 = cn.ndcs();
+	for(const auto& ncs: ndcs1) {
 		// Note: always evaluate contributions to the clusters of this collection
 		const auto  cls1num = ncs.second.size();  // Note: equals to the number of resolutions for !m_overlaps
-		const AccCont  share1 = mbcont(cls1num);
 		// Evaluate contribution to the second collection if any
-		auto incs2 = cn.m_ndcs.find(ncs.first);
-		const auto  cls2num = incs2 != cn.m_ndcs.end() ? incs2->second.size() : 0;
+		const auto  incs2 = ndcs2.find(ncs.first);
+		const auto  cls2num = incs2 != ndcs2.end() ? incs2->second.size() : 0;
 		if(cls2num) {
-			AccCont  cont = (m_overlaps ? updateCont(incs2->second)
-				: mbcont(incs2->second.size())) * share1;  // Note: shares already divided by clsXnum
-			// ATTENTION: share1 != cont * cls2num for !m_overlaps (cls1num - the number of resolutions)
-			const AccCont  cont1sum = cont * cls2num;  // Total accumulative contribution from the cl
-			cmmsum += cont1sum * cls1num;
-			// Update clusters matching matrix
-			for(auto cl: ncs.second) {
-				cl->mbscont += cont1sum;
-				for(auto cl2: incs2->second) {
-					clsmm(cl, cl2) += cont;  // Note: contains only POSITIVE values
-					if(!m_overlaps)
-						cl2->mbscont += cont;
+			if(m_overlaps) {
+				// Note: the shares of the node sum up to 1 in each collection, so the
+				// matching is the product of the shares
+				for(size_t j = 0; j < cls2num; ++j)
+					cn.m_conts[incs2->second[j]->index] += nodeShare(incs2->second, j);
+				for(size_t i = 0; i < cls1num; ++i) {
+					Cluster<Count>* const  cl = ncs.second[i];
+					const AccCont  share1 = nodeShare(ncs.second, i);
+					m_conts[cl->index] += share1;
+					cmmsum += share1;
+					for(size_t j = 0; j < cls2num; ++j)
+						clsmm(cl, incs2->second[j]) += share1 * nodeShare(incs2->second, j);  // Note: contains only POSITIVE values
+				}
+			} else {
+				// ATTENTION: the node is contained in each resolution, so
+				// its total contribution is cls2num for the cl
+				const AccCont  cont1sum = cls2num;  // Total accumulative contribution from the cl
+				cmmsum += cont1sum * cls1num;
+				// Update clusters matching matrix
+				for(auto cl: ncs.second) {
+					m_conts[cl->index] += cont1sum;
+					for(auto cl2: incs2->second) {
+						clsmm(cl, cl2) += 1;  // Note: contains only POSITIVE values
+						cn.m_conts[cl2->index] += 1;
+					}
 				}
 			}
 		} else {
 			// Note: in this case cls2num and share2 are zero
-			econt1 += share1 * cls1num;
-			for(auto cl: ncs.second)
-				cl->mbscont += share1;
+			for(size_t i = 0; i < cls1num; ++i) {
+				const AccCont  share1 = nodeShare(ncs.second, i);
+				econt1 += share1;
+				m_conts[ncs.second[i]->index] += share1;
+			}
 		}
 
 	}
 	// Consider the case of unequal node base, contribution from the missed nodes
 	AccCont  econt2 = 0;  // Extra contribution from the cn
 	if((m_ndshash && cn.m_ndshash && m_ndshash != cn.m_ndshash) || ndsnum() != cn.ndsnum()) {
-		for(auto& ncs: cn.m_ndcs) {
+		for(const auto& ncs: ndcs2) {
 			// Skip processed nodes
-			if(m_ndcs.count(ncs.first))
+			if(ndcs1.count(ncs.first))
 				continue;
 			// Note: in this case cls1num and share1 are zero
-			const auto  cls2num = ncs.second.size();  // Note: equals to the number of resolutions for !m_overlaps
-			const AccCont  share2 = mbcont(cls2num);
-			econt2 += share2 * cls2num;
-			for(auto cl: ncs.second)
-				cl->mbscont += share2;
+			for(size_t j = 0; j < ncs.second.size(); ++j) {
+				const AccCont  share2 = nodeShare(ncs.second, j);
+				econt2 += share2;
+				cn.m_conts[ncs.second[j]->index] += share2;
+			}
 		}
 	} else if(!m_ndshash || !cn.m_ndshash)
 		fputs("WARNING evalconts(), collection(s) hashes were not evaluated (%lu, %lu)"
@@ -1088,10 +2148,10 @@ auto Collection<Count>::evalconts(const CollectionT& cn, ClustersMatching* pclsm
 	fprintf(stderr, "evalconts(), cls1 counts (%lu): ", m_cls.size());
 #endif // TRACE
 	m_contsum = econt1;
-	for(auto c1: m_cls) {
-		m_contsum += c1->cont();
+	for(auto cont: m_conts) {
+		m_contsum += cont;
 #ifdef TRACING_CLSCOUNTS_
-		fprintf(stderr, " %.3G", AccProb(c1->cont()));
+		fprintf(stderr, " %.3G", AccProb(cont));
 #endif // TRACING_CLSCOUNTS_
 	}
 
@@ -1099,10 +2159,10 @@ auto Collection<Count>::evalconts(const CollectionT& cn, ClustersMatching* pclsm
 	fprintf(stderr, "\nevalconts(), cls2 counts (%lu): ", cn.m_cls.size());
 #endif // TRACING_CLSCOUNTS_
 	cn.m_contsum = econt2;
-	for(const auto& c2: cn.m_cls) {
-		cn.m_contsum += c2->cont();
+	for(auto cont: cn.m_conts) {
+		cn.m_contsum += cont;
 #ifdef TRACING_CLSCOUNTS_
-		fprintf(stderr, " %.3G", AccProb(c2->cont()));
+		fprintf(stderr, " %.3G", AccProb(cont));
 #endif // TRACING_CLSCOUNTS_
 	}
 #ifdef TRACING_CLSCOUNTS_
@@ -1111,10 +2171,10 @@ auto Collection<Count>::evalconts(const CollectionT& cn, ClustersMatching* pclsm
 	if(m_overlaps
 	&& !(equalx<AccCont>(m_contsum - econt1, ndsnum(), ndsnum())
 	&& equalx<AccCont>(cn.m_contsum - econt2, cn.ndsnum(), cn.ndsnum()))) {  // consum equals to the number of nodes for the overlapping case
-		fprintf(stderr, "evalconts(), c1csum: %.3G (- %.3G lacked), nds1num: %u"
-			", c2csum: %.3G (- %.3G lacked), nds2num: %u,  cmmsum: %.3G\n"
-			, AccProb(m_contsum), AccProb(econt1), ndsnum()
-			, AccProb(cn.m_contsum), AccProb(econt2), cn.ndsnum(), AccProb(cmmsum));
+		fprintf(stderr, "evalconts(), c1csum: %.3G (- %.3G lacked), nds1num: %lu"
+			", c2csum: %.3G (- %.3G lacked), nds2num: %lu,  cmmsum: %.3G\n"
+			, AccProb(m_contsum), AccProb(econt1), size_t(ndsnum())
+			, AccProb(cn.m_contsum), AccProb(econt2), size_t(cn.ndsnum()), AccProb(cmmsum));
 		assert(0 && "evalconts(), consum validation failed");
 	}
 #endif // VALIDATE 2
@@ -1148,7 +2208,11 @@ void Collection<Count>::clearconts() const noexcept
 	// Reset member contributions if not zero
 	if(!m_contsum)  // Note: ! is fine here
 		return;
-	for(auto cl: m_cls)
-		cl->mbscont = 0;
+	for(auto& cont: m_conts)
+		cont = 0;
 	m_contsum = 0;
 }
+
+#ifdef ID64
+}  // id64
+#endif // ID64
@@ -18,15 +18,25 @@ extern "C" {
 #include <stdint.h>  // uintX_t
 
 
+// Note: the library is built for the 64-bit node ids if ID64 is defined
+#ifdef ID64
+typedef uint64_t  NodeId;  //!< Node Id type
+typedef unsigned __int128  AccNodeId;  //!< Accumulated Node Id type
+#else
 typedef uint32_t  NodeId;  //!< Node Id type
 typedef uint64_t  AccNodeId;  //!< Accumulated Node Id type
+#endif // ID64
 typedef float  LinkWeight;  ///< Link weight
 
 //! \brief Node relations
 typedef struct {
 	NodeId  num;  //!< The number of cluster nodes
 	NodeId*  ids;  //!< Node ids
-	LinkWeight*  weights;  //!< Node weights in this cluster, can be NULL which means equal weights = 1
+	//! Node weights in this cluster (fuzzy memberships), can be NULL which means
+	//! equal weights = 1. The weights of each node are normalized to its shares
+	//! summing up to 1, the zero weights mean non-membership. The collection
+	//! having all weights = 1 is evaluated as the non-weighted one
+	LinkWeight*  weights;
 } ClusterNodes;
 
 //! \brief Node collection (clusters)
@@ -35,6 +45,17 @@ typedef struct {
 	ClusterNodes*  nodes;  //!< Relations of nodes
 } ClusterCollection;
 
+//! \brief Node collection (clusters) in the CSR (Compressed Sparse Row) format,
+//! where the members of the cluster #i are ids[offsets[i] .. offsets[i+1])
+//! \note The buffers are owned by the caller, they are read once on the creation
+//! of the collection
+typedef struct {
+	NodeId  num;  //!< The number of clusters in a collection
+	const NodeId*  offsets;  //!< Offsets of the clusters in ids, num + 1 items starting from 0
+	const NodeId*  ids;  //!< Node ids of all clusters, offsets[num] items
+	const LinkWeight*  weights;  //!< Node weights aligned with ids, can be NULL which means equal weights = 1
+} CsrCollection;
+
 //! \brief F1 Kind
 typedef enum {
 	//! Not initialized
@@ -114,6 +135,212 @@ Probability omegaExt(const ClusterCollection cn1, const ClusterCollection cn2);
 //! \return Probability  - omega index
 Probability omegax(const ClusterCollection cn1, const ClusterCollection cn2, uint8_t ext, uint8_t sync, uint8_t makeunique);
 
+// Collection handles ----------------------------------------------------------
+//! \brief Opaque handle of the indexed collection of clusters, which is built
+//! once and reused across the evaluations
+//! \note The evaluation of the handles is reentrant: the handles can be
+//! evaluated concurrently from multiple threads, where each concurrent
+//! evaluation of a handle uses its replica created on demand and retained for
+//! the subsequent evaluations. A handle should not be released while it is evaluated.
+//! The collections having weights distinct from 1 are evaluated as the overlapping (fuzzy) ones
+//! considering the node shares, the same holds for the non-weighted collection
+//! evaluated against the weighted one.
+typedef struct XmsCollection*  XmsCollectionHandle;
+
+//! \brief Create the indexed collection from the raw collection of clusters
+//! \note The raw collection is not referred after the creation
+//!
+//! \param rcn const ClusterCollection  - raw collection of clusters (node relations)
+//! \param makeunique uint8_t  - ensure that clusters contain unique members by
+//! removing the duplicates
+//! \return XmsCollectionHandle  - handle of the collection or NULL on failure
+XmsCollectionHandle xms_collection_create(const ClusterCollection rcn, uint8_t makeunique);
+
+//! \brief Create the indexed collection from the flat CSR buffers
+//! \note The CSR rows are read in place without the per-cluster marshalling,
+//! the node ids are copied once into the collection, so the buffers can be
+//! released after the creation
+//!
+//! \param rcn const CsrCollection  - raw collection of clusters in the CSR format
+//! \param makeunique uint8_t  - ensure that clusters contain unique members by
+//! removing the duplicates
+//! \return XmsCollectionHandle  - handle of the collection or NULL on failure
+XmsCollectionHandle xms_collection_create_csr(const CsrCollection rcn, uint8_t makeunique);
+
+//! \brief Release the collection
+//!
+//! \param hcn XmsCollectionHandle  - handle of the collection, can be NULL
+void xms_collection_free(XmsCollectionHandle hcn);
+
+//! \brief Specified F1 evaluation of the Greatest (Max) Match for the indexed
+//! collections, see f1x()
+//!
+//! \param hcn1 XmsCollectionHandle  - first collection (ground-truth)
+//! \param hcn2 XmsCollectionHandle  - second collection
+//! \param kind F1Kind  - kind of F1 to be evaluated
+//! \param[out] rec Probability*  - recall of hcn2 relative to the ground-truth hcn1,
+//! can be NULL
+//! \param[out] prc Probability*  - precision of hcn2 relative to the ground-truth hcn1,
+//! can be NULL
+//! \param mkind MatchKind  - matching kind
+//! \param sync uint8_t  - synchronize node base of the collections by complementing
+//! each of them with the lacking nodes forming a single-cluster for the evaluation
+//! \param verbose uint8_t  - print intermediate results to the stdout
+//! \return Probability  - resulting F1_gm or NaN on the invalid arguments
+Probability xms_f1(XmsCollectionHandle hcn1, XmsCollectionHandle hcn2, F1Kind kind
+	, Probability* rec, Probability* prc, MatchKind mkind, uint8_t sync, uint8_t verbose);
+
+//! \brief (Extended) Omega Index evaluation for the indexed collections, see omegax()
+//! \note The weighted collections are evaluated by the weighted Omega Index,
+//! where the co-memberships of the nodes are formed by their shares
+//!
+//! \param hcn1 XmsCollectionHandle  - first collection
+//! \param hcn2 XmsCollectionHandle  - second collection
+//! \param ext uint8_t  - evaluate extended omega index
+//! \param sync uint8_t  - synchronize node base of the collections by complementing
+//! each of them with the lacking nodes forming a single-cluster for the evaluation
+//! \return Probability  - omega index or NaN on the invalid arguments
+Probability xms_omega(XmsCollectionHandle hcn1, XmsCollectionHandle hcn2, uint8_t ext, uint8_t sync);
+
+//! \brief The number of clusters in the collection
+//!
+//! \param hcn XmsCollectionHandle  - handle of the collection
+//! \return NodeId  - the number of clusters, 0 for NULL
+NodeId xms_collection_size(XmsCollectionHandle hcn);
+
+//! \brief Whether the collection is weighted (fuzzy)
+//!
+//! \param hcn XmsCollectionHandle  - handle of the collection
+//! \return uint8_t  - the collection has weights distinct from 1, 0 for NULL
+uint8_t xms_collection_weighted(XmsCollectionHandle hcn);
+
+//! \brief NMI values for all normalizations
+typedef struct {
+	Probability  max;  //!< NMI_max, normalized by the max information content
+	Probability  sqrt;  //!< NMI_sqrt, normalized by the geometric mean of the information contents
+	Probability  avg;  //!< NMI_avg, normalized by the arithmetic mean of the information contents
+	Probability  min;  //!< NMI_min, normalized by the min information content
+} NmiValues;
+
+//! \brief NMI evaluation for the indexed collections
+//! \note Undirected (symmetric) evaluation
+//!
+//! \param hcn1 XmsCollectionHandle  - first collection
+//! \param hcn2 XmsCollectionHandle  - second collection
+//! \param[out] nmis NmiValues*  - NMI for all normalizations, can be NULL
+//! \param expbase uint8_t  - use ln (exp base) or log2 (Shannon entropy, bits)
+//! for the information measuring
+//! \param sync uint8_t  - synchronize node base of the collections by complementing
+//! each of them with the lacking nodes forming a single-cluster for the evaluation
+//! \return Probability  - NMI_max or NaN on the invalid arguments or if the
+//! collections have no mutual information
+Probability xms_nmi(XmsCollectionHandle hcn1, XmsCollectionHandle hcn2, NmiValues* nmis
+	, uint8_t expbase, uint8_t sync);
+
+//! \brief Overlapping NMI evaluation (McDaid's and LFK normalizations) for the
+//! indexed collections
+//! \note Undirected (symmetric) evaluation
+//!
+//! \param hcn1 XmsCollectionHandle  - first collection
+//! \param hcn2 XmsCollectionHandle  - second collection
+//! \param[out] lfk Probability*  - NMI_lfk by Lancichinetti, Fortunato and Kertesz,
+//! can be NULL
+//! \param sync uint8_t  - synchronize node base of the collections by complementing
+//! each of them with the lacking nodes forming a single-cluster for the evaluation
+//! \return Probability  - ONMI_max by McDaid et al. or NaN on the invalid arguments
+Probability xms_onmi(XmsCollectionHandle hcn1, XmsCollectionHandle hcn2, Probability* lfk
+	, uint8_t sync);
+
+//! \brief Label the clusters with the ground-truth cluster indices and evaluate
+//! the F1 of the labeling
+//! \note The labels of each cluster of hcn are outputted in the CSR format:
+//! the ordered ground-truth cluster indices of the cluster #i are
+//! labels[offsets[i] .. offsets[i+1]). The complementary clusters formed on the
+//! synchronization are omitted.
+//!
+//! \param hgt XmsCollectionHandle  - ground-truth collection (labels)
+//! \param hcn XmsCollectionHandle  - labeled collection
+//! \param prob uint8_t  - Partial Probabilities or F1 (harmonic) matching policy
+//! \param weighted uint8_t  - weight labels by the number of instances or treat
+//! each label equally
+//! \param[out] prc Probability*  - precision of the labeling, can be NULL
+//! \param[out] rec Probability*  - recall of the labeling, can be NULL
+//! \param[out] offsets NodeId*  - offsets of the labels of each cluster,
+//! xms_collection_size(hcn) + 1 items, can be NULL
+//! \param[out] labels NodeId*  - labels of all clusters, lbscap items, can be NULL;
+//! the labels are not written if lbscap is insufficient
+//! \param lbscap NodeId  - capacity of the labels buffer
+//! \param[out] lbsnum NodeId*  - the total number of labels of all clusters, can be NULL
+//! \param sync uint8_t  - synchronize node base of the collections by complementing
+//! each of them with the lacking nodes forming a single-cluster for the evaluation
+//! \return Probability  - F1 of the labeling, i.e. harmonic mean of its precision
+//! and recall, or NaN on the invalid arguments
+Probability xms_label(XmsCollectionHandle hgt, XmsCollectionHandle hcn, uint8_t prob
+	, uint8_t weighted, Probability* prc, Probability* rec, NodeId* offsets
+	, NodeId* labels, NodeId lbscap, NodeId* lbsnum, uint8_t sync);
+
+//! \brief Measures of the combined evaluation, flags
+typedef enum {
+	MEASURE_NONE = 0,
+	MEASURE_NMI = 1,  //!< NMI for all normalizations
+	MEASURE_ONMI = 2,  //!< Overlapping NMI
+	MEASURE_F1 = 4,  //!< F1 of the greatest match
+	MEASURE_LABEL = 8,  //!< F1 of the labeling
+	MEASURE_OMEGA = 0x10  //!< (Extended) Omega Index
+} Measure;
+
+//! \brief Combined evaluation of multiple measures: the requested measures with
+//! their parameters and the resulting values
+typedef struct {
+	// Parameters
+	uint32_t  measures;  //!< Evaluating measures, a bit mask of the Measure flags
+	F1Kind  f1kind;  //!< Kind of F1 for MEASURE_F1
+	MatchKind  mkind;  //!< Matching kind for MEASURE_F1
+	uint8_t  expbase;  //!< Use ln (exp base) or log2 for MEASURE_NMI
+	uint8_t  lbprob;  //!< Partial Probabilities or F1 matching policy for MEASURE_LABEL
+	uint8_t  lbweighted;  //!< Weight labels by the number of instances for MEASURE_LABEL
+	uint8_t  ext;  //!< Evaluate the extended Omega Index for MEASURE_OMEGA
+	// Results, NaN for the non-evaluated measures
+	NmiValues  nmi;  //!< NMI for all normalizations
+	Probability  onmi;  //!< ONMI_max
+	Probability  onmilfk;  //!< ONMI_lfk
+	Probability  f1;  //!< F1 of the greatest match
+	Probability  f1prc;  //!< Precision of the greatest match
+	Probability  f1rec;  //!< Recall of the greatest match
+	Probability  lbf1;  //!< F1 of the labeling
+	Probability  lbprc;  //!< Precision of the labeling
+	Probability  lbrec;  //!< Recall of the labeling
+	Probability  omega;  //!< (Extended) Omega Index
+} Measures;
+
+//! \brief Evaluate multiple measures of the indexed collections sharing their
+//! indexes and node base synchronization
+//!
+//! \param hcn1 XmsCollectionHandle  - first collection (ground-truth)
+//! \param hcn2 XmsCollectionHandle  - second collection
+//! \param[in,out] msrs Measures*  - evaluating measures and the resulting values
+//! \param sync uint8_t  - synchronize node base of the collections by complementing
+//! each of them with the lacking nodes forming a single-cluster for the evaluation
+//! \return uint32_t  - the successfully evaluated measures, a bit mask of the Measure flags
+uint32_t xms_evaluate(XmsCollectionHandle hcn1, XmsCollectionHandle hcn2, Measures* msrs
+	, uint8_t sync);
+
+//! \brief Evaluate multiple candidate collections against the ground-truth
+//! concurrently by the internal pool of threads, see xms_evaluate()
+//! \note The calling thread is one of the workers
+//!
+//! \param hgt XmsCollectionHandle  - ground-truth collection
+//! \param hcns const XmsCollectionHandle*  - candidate collections, num items
+//! \param num size_t  - the number of candidate collections
+//! \param params const Measures*  - evaluating measures with their parameters
+//! \param[out] results Measures*  - resulting measures of each candidate, num items
+//! \param sync uint8_t  - synchronize node base of the collections by complementing
+//! each of them with the lacking nodes forming a single-cluster for the evaluation
+//! \param threads uint16_t  - the number of threads, 0 means the number of CPUs
+//! \return size_t  - the number of candidates having all requested measures evaluated
+size_t xms_evaluate_batch(XmsCollectionHandle hgt, const XmsCollectionHandle* hcns, size_t num
+	, const Measures* params, Measures* results, uint8_t sync, uint16_t threads);
+
 #ifdef __cplusplus
 };
 #endif // __cplusplus
@@ -29,6 +29,18 @@ using std::numeric_limits;
 using std::domain_error;
 
 // Type Declarations ---------------------------------------------------
+//! \brief Whether the type is integral including the 128-bit extension,
+//! which is required to accumulate the 64-bit ids
+//!
+//! \tparam T  - the type to be checked
+template <typename T>
+struct isAccIntegral: std::integral_constant<bool, is_integral<T>::value>  {};
+
+#ifdef __SIZEOF_INT128__
+template <>
+struct isAccIntegral<unsigned __int128>: std::true_type  {};
+#endif // __SIZEOF_INT128__
+
 //! \brief Aggregation hash of ids
 //! \pre Template types should be integral
 //!
@@ -37,7 +49,7 @@ using std::domain_error;
 //! should have at least twice magnitude of the Id type (i.e. squared)
 template <typename Id=uint32_t, typename AccId=uint64_t>
 class AggHash {
-	static_assert(is_integral<Id>::value && is_integral<AccId>::value
+	static_assert(is_integral<Id>::value && isAccIntegral<AccId>::value
 		&& sizeof(AccId) >= 2*sizeof(Id), "AggHash, types constraints are violated");
 
 	// ATTENTION: type of the m_size should not be less than of m_idsum to
@@ -58,10 +70,22 @@ public:
 	using IdT = Id;  //!< Type of the member ids
 	using AccIdT = AccId;  //!< Type of the accumulated Ids and accumulated squares of Ids
 
+	//! Max id that can be aggregated without the overflow on the correction
+	constexpr static Id  idmax = numeric_limits<Id>::max() - idcor;
+
 	//! \brief Default constructor
 	AggHash() noexcept
 	: m_size(0), m_idsum(0), m_id2sum(0) {}
 
+	//! \brief Constructor from the aggregated values
+	//! \note Used to restore the stored hash
+	//!
+	//! \param size AccId  - the number of the aggregated ids
+	//! \param idsum AccId  - sum of the aggregated ids
+	//! \param id2sum AccId  - sum of squares of the aggregated ids
+	AggHash(AccId size, AccId idsum, AccId id2sum) noexcept
+	: m_size(size), m_idsum(idsum), m_id2sum(id2sum) {}
+
 	//! \brief Add id to the aggregation
 	//! \note In case correction is used and id becomes out of range (initial id > IDMAX - IDCORR)
 	//! 	then an exception is thrown, which crashes the whole application, which is OK
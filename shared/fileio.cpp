@@ -10,10 +10,17 @@
 
 #include <cassert>
 #include <system_error>  // error_code
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <zlib.h>
 //#include <stdexcept>
 
 #ifdef __unix__
 #include <sys/stat.h>
+#include <sys/mman.h>  // mmap
+#include <fcntl.h>  // open
+#include <unistd.h>  // close
 #endif // __unix__
 
 #define INCLUDE_STL_FS
@@ -38,7 +45,8 @@ size_t NamedFileWrapper::size() const noexcept
 	struct stat  filest;
 	int fd = fileno(m_file);
 	if(fd != -1 && !fstat(fd, &filest))
-		return filest.st_size;
+		// Note: the size of pipes and sockets is not meaningful
+		return S_ISREG(filest.st_mode) ? filest.st_size : cmsbytes;
 #endif // __unix
 	error_code  err;
 	cmsbytes = fs::file_size(m_name, err);
@@ -60,7 +68,7 @@ size_t NamedFileWrapper::size() const noexcept
 NamedFileWrapper& NamedFileWrapper::reset(const char* filename, const char* mode)
 {
 	if(filename) {
-		m_file.reset(fopen(filename, mode));
+		m_file.reset(openFile(filename, mode), !isStdStream(filename));
 		m_name = filename;
 	} else m_file.reset();
 	return *this;
@@ -168,9 +176,472 @@ bool StringBuffer::readline(FILE* input)
 	return true;  // More lines can be read
 }
 
+// Gzip Decompression ----------------------------------------------------------
+namespace daoc {
+
+using std::thread;
+using std::mutex;
+using std::unique_lock;
+using std::condition_variable;
+
+//! \brief Whether the content starts with the gzip magic
+//!
+//! \param data const void*  - the content
+//! \param size size_t  - the content size
+//! \return bool  - the content is gzip compressed
+static bool isGzip(const void* data, size_t size) noexcept
+{
+	const uint8_t* const  bytes = static_cast<const uint8_t*>(data);
+	return size >= 2 && bytes[0] == 0x1F && bytes[1] == 0x8B;
+}
+
+//! \brief Whether the data following the gzip member is a zero padding
+//! \note The padding is ignored as by gzip instead of the next member decoding
+//!
+//! \param data const uint8_t*  - the remained input
+//! \param size size_t  - the remained input size
+//! \return bool  - the data is empty or consists of the zero bytes only
+static bool gzipPadding(const uint8_t* data, size_t size) noexcept
+{
+	for(const uint8_t* const  end = data + size; data != end; ++data)
+		if(*data)
+			return false;
+	return true;
+}
+
+//! \brief Estimate the decompressed size of the gzip file
+//! \note The trailer holds the size modulo 2^32 of the last gzip member
+//!
+//! \param trailer const uint8_t*  - the last 4 bytes of the file
+//! \param fsize size_t  - the compressed file size
+//! \return size_t  - the estimated decompressed size
+static size_t gzipContentSize(const uint8_t* trailer, size_t fsize) noexcept
+{
+	const size_t  isize = trailer[0] | trailer[1] << 8 | trailer[2] << 16
+		| size_t(trailer[3]) << 24;
+	// Note: the text of ids is typically compressed 3-5 times, the trailer
+	// size is not actual for the files >= 4 GB
+	return isize >= fsize ? isize : fsize * 4;
+}
+
+class GzipStream {
+	constexpr static size_t  inpsize = 256 << 10;  //!< Compressed input block size, 256 KB
+
+	FILE*  m_file;  //!< Compressed input file
+	vector<char>  m_ring;  //!< Ring buffer of the decompressed data
+	size_t  m_head;  //!< Total number of the consumed bytes
+	size_t  m_tail;  //!< Total number of the decompressed bytes
+	string  m_err;  //!< Decompression error
+	bool  m_done;  //!< The decompression is completed
+	bool  m_stop;  //!< The decompression should be terminated
+	mutex  m_mutex;
+	condition_variable  m_cvdata;  //!< Decompressed data is available
+	condition_variable  m_cvspace;  //!< Free space is available in the ring
+	thread  m_worker;  //!< Decompression thread
+public:
+    //! \brief Constructor, starts the decompression
+    //!
+    //! \param file FILE*  - compressed input file
+    //! \param prefix vector<char>&&  - input data already read from the file
+    //! \param ringsize size_t  - ring buffer size
+	GzipStream(FILE* file, vector<char>&& prefix, size_t ringsize)
+	: m_file(file), m_ring(ringsize), m_head(0), m_tail(0), m_err(), m_done(false)
+	, m_stop(false), m_mutex(), m_cvdata(), m_cvspace(), m_worker()
+	{
+		m_worker = thread(&GzipStream::inflateInput, this, move(prefix));
+	}
+
+	GzipStream(const GzipStream&)=delete;
+	GzipStream& operator= (const GzipStream&)=delete;
+
+    //! \brief Destructor, terminates the decompression
+	~GzipStream()
+	{
+		{
+			unique_lock<mutex>  lock(m_mutex);
+			m_stop = true;
+		}
+		m_cvspace.notify_one();
+		m_worker.join();
+	}
+
+    //! \brief Read the decompressed data, blocks until the data is available
+    //!
+    //! \param dst char*  - destination buffer
+    //! \param size size_t  - max number of bytes to be read
+    //! \return size_t  - the number of read bytes, 0 on the end of the input
+	size_t read(char* dst, size_t size)
+	{
+		unique_lock<mutex>  lock(m_mutex);
+		m_cvdata.wait(lock, [this] { return m_head != m_tail || m_done; });
+		if(m_head == m_tail && !m_err.empty())
+			throw std::ios_base::failure(m_err);
+		size = std::min(size, m_tail - m_head);
+		// Note: the data can be wrapped around the ring end
+		const size_t  ipos = m_head % m_ring.size();
+		const size_t  part = std::min(size, m_ring.size() - ipos);
+		memcpy(dst, m_ring.data() + ipos, part);
+		memcpy(dst + part, m_ring.data(), size - part);
+		m_head += size;
+		lock.unlock();
+		m_cvspace.notify_one();
+		return size;
+	}
+private:
+    //! \brief Decompress the input into the ring buffer (worker thread)
+    //!
+    //! \param prefix vector<char>  - input data already read from the file
+	void inflateInput(vector<char> prefix)
+	{
+		z_stream  zs;
+		memset(&zs, 0, sizeof zs);
+		// Note: +32 enables the automatic gzip/zlib header detection
+		if(inflateInit2(&zs, 15 + 32) != Z_OK) {
+			finish("ERROR GzipStream, zlib initialization failed\n");
+			return;
+		}
+		vector<uint8_t>  inp(std::max(inpsize, prefix.size()));
+		memcpy(inp.data(), prefix.data(), prefix.size());
+		size_t  insize = prefix.size();
+		int  res = Z_OK;
+		do {
+			if(!insize)
+				insize = fread(inp.data(), 1, inp.size(), m_file);
+			if(!insize) {
+				if(ferror(m_file) || res != Z_STREAM_END)
+					res = Z_DATA_ERROR;  // Truncated input
+				break;
+			}
+			zs.next_in = inp.data();
+			zs.avail_in = insize;
+			insize = 0;
+			while(zs.avail_in) {
+				// Note: concatenated gzip members form a valid gzip file
+				if(res == Z_STREAM_END) {
+					if(gzipPadding(zs.next_in, zs.avail_in)) {
+						zs.avail_in = 0;
+						break;
+					}
+					inflateReset(&zs);
+				}
+				// Wait for the free space in the ring
+				size_t  space;
+				{
+					unique_lock<mutex>  lock(m_mutex);
+					m_cvspace.wait(lock, [this] {
+						return m_tail - m_head < m_ring.size() || m_stop; });
+					if(m_stop)
+						break;
+					const size_t  ipos = m_tail % m_ring.size();
+					space = std::min(m_ring.size() - (m_tail - m_head), m_ring.size() - ipos);
+					zs.next_out = reinterpret_cast<Bytef*>(m_ring.data() + ipos);
+				}
+				// Note: the free space of the ring is not accessed by the reader
+				zs.avail_out = space;
+				res = inflate(&zs, Z_NO_FLUSH);
+				if(res != Z_OK && res != Z_STREAM_END && res != Z_BUF_ERROR)
+					break;
+				{
+					unique_lock<mutex>  lock(m_mutex);
+					m_tail += space - zs.avail_out;
+				}
+				m_cvdata.notify_one();
+			}
+		} while(!m_stop && (res == Z_OK || res == Z_STREAM_END || res == Z_BUF_ERROR));
+		inflateEnd(&zs);
+		if(m_stop || res == Z_STREAM_END)
+			finish();
+		else finish(string("ERROR GzipStream, decompression failed: ")
+			.append(zs.msg ? zs.msg : res == Z_DATA_ERROR ? "truncated or invalid data"
+				: "zlib error") += "\n");
+	}
+
+    //! \brief Complete the decompression
+    //!
+    //! \param err=string() string  - error message if any
+	void finish(string err=string())
+	{
+		{
+			unique_lock<mutex>  lock(m_mutex);
+			m_err = move(err);
+			m_done = true;
+		}
+		m_cvdata.notify_one();
+	}
+};
+
+constexpr size_t  GzipStream::inpsize;
+
+}  // daoc
+
+constexpr size_t  LineReader::blockmin;
+constexpr size_t  LineReader::blockmax;
+
+LineReader::LineReader(FILE* input, size_t blocksize)
+: m_file(input), m_gzip(), m_buf(), m_pos(0), m_end(0), m_length(0), m_size(-1)
+, m_eof(!input)
+{
+	if(blocksize < blockmin)
+		blocksize = blockmin;
+	else if(blocksize > blockmax)
+		blocksize = blockmax;
+#ifdef __unix__
+	struct stat  filest;
+	if(input && !fstat(fileno(input), &filest) && S_ISREG(filest.st_mode))
+		m_size = filest.st_size;
+#endif // __unix__
+	// Reduce the buffer for the small regular files
+	if(m_size != size_t(-1) && m_size < blocksize)
+		blocksize = m_size + 1;  // Note: +1 to hit EOF on the first block reading
+	m_buf.resize(blocksize + 1);  // Note: +1 for the reserved terminator
+
+	// Detect the gzip input by the first loaded block
+	if(!input || !load() || !isGzip(m_buf.data(), m_end))
+		return;
+	uint8_t  trailer[4];
+#ifdef __unix__
+	if(m_size != size_t(-1) && m_size >= sizeof trailer
+	&& pread(fileno(input), trailer, sizeof trailer, m_size - sizeof trailer) == sizeof trailer)
+		m_size = gzipContentSize(trailer, m_size);
+	else m_size = -1;
+#endif // __unix__
+	// Note: the decompressed data are typically much larger than the compressed file
+	if(m_buf.size() < blockmin + 1)
+		m_buf.resize(blockmin + 1);
+	// Note: the ring holds two blocks to decompress the next block while the current
+	// one is parsed
+	m_gzip.reset(new GzipStream(input, vector<char>(m_buf.data(), m_buf.data() + m_end)
+		, 2 * (m_buf.size() - 1)));
+	m_end = 0;
+	m_eof = false;
+}
+
+LineReader::~LineReader()=default;
+
+size_t LineReader::fetch(char* dst, size_t size)
+{
+	if(m_gzip)
+		return m_gzip->read(dst, size);
+#ifdef __unix__
+	ssize_t  nread;
+	do nread = read(fileno(m_file), dst, size);
+	while(nread == -1 && errno == EINTR);
+	if(nread == -1) {
+		perror("ERROR LineReader::fetch(), file reading error");
+		nread = 0;
+	}
+#else
+	const size_t  nread = fread(dst, 1, size, m_file);
+	if(ferror(m_file))
+		perror("ERROR LineReader::fetch(), file reading error");
+#endif // __unix__
+	return nread;
+}
+
+size_t LineReader::load()
+{
+	const size_t  nread = fetch(m_buf.data() + m_end, m_buf.size() - 1 - m_end);
+	if(!nread)
+		m_eof = true;
+	m_end += nread;
+	return nread;
+}
+
+char* LineReader::readline()
+{
+	// Note: the scanning is resumed from the end of the already scanned data
+	for(size_t  ibeg = m_pos; ;) {
+		char* const  data = m_buf.data();
+		char*  eol = static_cast<char*>(memchr(data + ibeg, '\n', m_end - ibeg));
+		if(eol || m_eof) {
+			if(!eol) {
+				// The last line is not terminated by '\n'
+				if(m_pos == m_end) {
+					m_length = 0;
+					return nullptr;
+				}
+				eol = data + m_end;  // Note: the reserved byte is used
+			}
+			*eol = 0;
+			char* const  line = data + m_pos;
+			m_length = eol - line;
+			m_pos = std::min<size_t>(eol + 1 - data, m_end);
+			return line;
+		}
+		// Carry the partial line to the buffer begin or extend the buffer for the long line
+		if(m_pos) {
+			m_end -= m_pos;
+			memmove(data, data + m_pos, m_end);
+			m_pos = 0;
+		} else if(m_end + 1 == m_buf.size())
+			m_buf.resize(m_buf.size() * 2);
+		ibeg = m_end;
+		load();
+	}
+}
+
+MappedFile::MappedFile(const char* filename)
+: m_data(nullptr), m_size(0), m_mapped(false), m_buf(), m_name(filename ? filename : "")
+{
+	if(!filename)
+		return;
+#ifdef __unix__
+	const int  fd = open(filename, O_RDONLY);
+	if(fd == -1)
+		return;
+	struct stat  filest;
+	if(!fstat(fd, &filest) && S_ISREG(filest.st_mode)) {
+		m_size = filest.st_size;
+		if(!m_size) {
+			close(fd);
+			m_data = "";
+			return;
+		}
+		void* const  addr = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		close(fd);  // Note: the mapping remains valid after the descriptor closing
+		if(addr != MAP_FAILED) {
+			madvise(addr, m_size, MADV_SEQUENTIAL);
+			m_data = static_cast<const char*>(addr);
+			m_mapped = true;
+			inflateContent();
+			return;
+		}
+#if TRACE >= 2
+		perror("MappedFile(), the file mapping failed, reading the file");
+#endif // TRACE
+		m_size = 0;
+	} else close(fd);
+#endif // __unix__
+	// Read the whole content if the file can't be mapped
+	FileWrapper  file(fopen(filename, "rb"));
+	if(!file)
+		return;
+	constexpr size_t  blocksize = 1 << 20;  // 1 MB
+	size_t  nread;
+	do {
+		m_buf.resize(m_size + blocksize);
+		nread = fread(m_buf.data() + m_size, 1, blocksize, file);
+		m_size += nread;
+	} while(nread == blocksize);
+	if(ferror(file)) {
+		perror(("ERROR MappedFile(), reading failed of " + m_name).c_str());
+		m_buf.clear();
+		m_size = 0;
+		return;
+	}
+	m_buf.resize(m_size);
+	m_data = m_size ? m_buf.data() : "";
+	inflateContent();
+}
+
+void MappedFile::inflateContent()
+{
+	if(!isGzip(m_data, m_size))
+		return;
+	const uint8_t* const  src = reinterpret_cast<const uint8_t*>(m_data);
+	StringBufferBase  content(m_size >= 4 ? gzipContentSize(src + m_size - 4, m_size) : m_size);
+	z_stream  zs;
+	memset(&zs, 0, sizeof zs);
+	// Note: +32 enables the automatic gzip/zlib header detection
+	int  res = inflateInit2(&zs, 15 + 32);
+	zs.next_in = const_cast<Bytef*>(src);
+	size_t  inprest = m_size;  // The remained input
+	size_t  outsize = 0;  // The number of decompressed bytes
+	// Note: zlib counters are 32 bit, so the input and output are fed by parts
+	constexpr size_t  partmax = std::numeric_limits<uInt>::max();
+	while(res == Z_OK || res == Z_STREAM_END) {
+		if(res == Z_STREAM_END) {
+			// Note: concatenated gzip members form a valid gzip file, the zero
+			// padding is skipped (the input parts are contiguous)
+			if(gzipPadding(zs.next_in, zs.avail_in + inprest))
+				break;
+			inflateReset(&zs);
+		}
+		if(!zs.avail_in) {
+			zs.avail_in = std::min(inprest, partmax);
+			inprest -= zs.avail_in;
+		}
+		if(outsize == content.size())
+			content.resize(content.size() * 2 + (1 << 20));
+		zs.next_out = reinterpret_cast<Bytef*>(content.data() + outsize);
+		zs.avail_out = std::min(content.size() - outsize, partmax);
+		const size_t  avail = zs.avail_out;
+		res = inflate(&zs, Z_NO_FLUSH);
+		outsize += avail - zs.avail_out;
+	}
+	inflateEnd(&zs);
+	if(res != Z_STREAM_END) {
+		fprintf(stderr, "ERROR MappedFile(), decompression failed of %s: %s\n", m_name.c_str()
+			, zs.msg ? zs.msg : res == Z_BUF_ERROR ? "truncated input" : "zlib error");
+		clear();
+		errno = EIO;
+		return;
+	}
+	content.resize(outsize);
+	content.shrink_to_fit();
+	clear();
+	m_buf = move(content);
+	m_size = outsize;
+	m_data = m_size ? m_buf.data() : "";
+}
+
+MappedFile::MappedFile(MappedFile&& mf) noexcept
+: m_data(mf.m_data), m_size(mf.m_size), m_mapped(mf.m_mapped)
+, m_buf(move(mf.m_buf)), m_name(move(mf.m_name))
+{
+	mf.m_data = nullptr;
+	mf.m_size = 0;
+	mf.m_mapped = false;
+}
+
+MappedFile& MappedFile::operator= (MappedFile&& mf) noexcept
+{
+	if(this != &mf) {
+		clear();
+		m_data = mf.m_data;
+		m_size = mf.m_size;
+		m_mapped = mf.m_mapped;
+		m_buf = move(mf.m_buf);
+		m_name = move(mf.m_name);
+		mf.m_data = nullptr;
+		mf.m_size = 0;
+		mf.m_mapped = false;
+	}
+	return *this;
+}
+
+MappedFile::~MappedFile()
+{
+	clear();
+}
+
+void MappedFile::clear() noexcept
+{
+#ifdef __unix__
+	if(m_mapped)
+		munmap(const_cast<char*>(m_data), m_size);
+#endif // __unix__
+	m_data = nullptr;
+	m_size = 0;
+	m_mapped = false;
+	m_buf.clear();
+}
+
 // File I/O functions ----------------------------------------------------------
 namespace daoc {
 
+bool isStreamed(const char* filename) noexcept
+{
+	if(isStdStream(filename))
+		return true;
+#ifdef __unix__
+	struct stat  filest;
+	return filename && !stat(filename, &filest) && !S_ISREG(filest.st_mode);
+#else
+	return false;
+#endif // __unix
+}
+
 void ensureDir(const string& dir)
 {
 #if TRACE >= 3
@@ -193,13 +664,21 @@ void ensureDir(const string& dir)
 			+= "' already exists as a non-directory path\n");
 }
 
-void parseCnlHeader(NamedFileWrapper& fcls, StringBuffer& line, size_t& clsnum
-	, size_t& ndsnum, [[maybe_unused]] bool verbose)
+//! \brief Parse attributes of the CNL header line
+//!
+//! \param line char*  - the header line starting with '#', which is modified
+//! \param[out] clsnum size_t&  - resulting number of clusters if specified
+//! \param[out] ndsnum size_t&  - resulting number of nodes if specified
+//! \param verbose bool  - print information about the header parsing issue to the stdout
+//! \return bool  - the line is the header rather than a continuous comment
+static bool parseCnlHeaderLine(char* line, size_t& clsnum, size_t& ndsnum
+	, [[maybe_unused]] bool verbose)
 {
+	char*  ctx = nullptr;  // Tokenization context, the files are loaded concurrently
     //! Parse count value
     //! \return  - id value of 0 in case of parsing errors
-	auto parseCount = []() noexcept -> size_t {
-		char* tok = strtok(nullptr, " \t,");  // Note: the value can't be ended with ':'
+	auto parseCount = [&ctx]() noexcept -> size_t {
+		char* tok = strtok_r(nullptr, " \t,", &ctx);  // Note: the value can't be ended with ':'
 		//errno = 0;
 		const auto val = strtoul(tok, nullptr, 10);
 		if(errno)
@@ -208,12 +687,69 @@ void parseCnlHeader(NamedFileWrapper& fcls, StringBuffer& line, size_t& clsnum
 		return val;
 	};
 
-	errno = 0;  // Reset errno
-	// Process the header, which is a special initial comment
 	// The target header is:  # Clusters: <cls_num>[,] Nodes: <cls_num>
 	constexpr char  clsmark[] = "clusters";
 	constexpr char  ndsmark[] = "nodes";
 	constexpr char  attrnameDelim[] = " \t:,";
+
+	// Tokenize the line
+	char *tok = strtok_r(line + 1, attrnameDelim, &ctx);  // Note: +1 to skip the leading '#'
+	// Skip comment without the string continuation and continuous comment
+	if(!tok || tok[0] == '#')
+		return false;
+	uint8_t  attrs = 0;  // The number of read attributes
+	do {
+		// Lowercase the token
+		for(char* pos = tok; *pos; ++pos)
+			*pos = tolower(*pos);
+
+		// Identify the attribute and read it's value
+		if(!strcmp(tok, clsmark)) {
+			clsnum = parseCount();
+			++attrs;
+#if TRACE >= 2
+			fprintf(stderr, "parseCnlHeader(), clusters: %lu\n", clsnum);
+#endif // TRACE
+		} else if(!strcmp(tok, ndsmark)) {
+			ndsnum = parseCount();
+			++attrs;
+#if TRACE >= 2
+			fprintf(stderr, "parseCnlHeader(), nodes: %lu\n", ndsnum);
+#endif // TRACE
+		} else {
+#if TRACE >= 1
+#if TRACE < 2
+		if(verbose)
+#endif // TRACE 2
+			fprintf(
+#if TRACE >= 2
+			stderr
+#else
+			stdout
+#endif // TRACE 2
+			, "WARNING parseCnlHeader(), the header parsing is omitted"
+				" because of the unexpected attribute: %s\n", tok);
+#endif // TRACE 1
+			break;
+		}
+	} while((tok = strtok_r(nullptr, attrnameDelim, &ctx)) && attrs < 2);
+
+	// Validate and correct the number of clusters if required
+	// Note: it's better to reallocate a container a few times than too much overconsume the memory
+	if(ndsnum && clsnum > ndsnum) {
+		fprintf(stderr, "WARNING parseCnlHeader(), clsnum (%lu) typically should be"
+			" less than ndsnum (%lu)\n", clsnum, ndsnum);
+		clsnum = ndsnum;
+		//assert(0 && "parseCnlHeader(), clsnum typically should be less than ndsnum");
+	}
+	return true;
+}
+
+void parseCnlHeader(NamedFileWrapper& fcls, StringBuffer& line, size_t& clsnum
+	, size_t& ndsnum, bool verbose)
+{
+	errno = 0;  // Reset errno
+	// Process the header, which is a special initial comment
 #if TRACE >= 2
 	size_t  lnum = 0;  // The number of lines read
 #endif // TRACE
@@ -221,73 +757,266 @@ void parseCnlHeader(NamedFileWrapper& fcls, StringBuffer& line, size_t& clsnum
 #if TRACE >= 2
 		++lnum;
 #endif // TRACE
-		// Skip empty lines
-		if(line.empty())
+		// Skip empty lines considering the CRLF line endings
+		if(line.empty() || (line[0] == '\r' && line.length() <= 2))
 			continue;
 		// Consider only subsequent comments
 		if(line[0] != '#')
 			break;
-
-		// Tokenize the line
-		char *tok = strtok(line + 1, attrnameDelim);  // Note: +1 to skip the leading '#'
-		// Skip comment without the string continuation and continuous comment
-		if(!tok || tok[0] == '#')
+		if(!parseCnlHeaderLine(line, clsnum, ndsnum, verbose))
 			continue;
-		uint8_t  attrs = 0;  // The number of read attributes
-		do {
-			// Lowercase the token
-			for(char* pos = tok; *pos; ++pos)
-				*pos = tolower(*pos);
-
-			// Identify the attribute and read it's value
-			if(!strcmp(tok, clsmark)) {
-				clsnum = parseCount();
-				++attrs;
+		// Get following line for the unified subsequent processing
+		line.readline(fcls);
+		break;
+	}
 #if TRACE >= 2
-				fprintf(stderr, "parseCnlHeader(), clusters: %lu\n", clsnum);
+	fprintf(stderr, "parseCnlHeader(), processed %lu lines of '%s'\n"
+		, lnum, fcls.name().c_str());
 #endif // TRACE
-			} else if(!strcmp(tok, ndsmark)) {
-				ndsnum = parseCount();
-				++attrs;
+}
+
+char* parseCnlHeader(LineReader& lines, size_t& clsnum, size_t& ndsnum, bool verbose)
+{
+	errno = 0;  // Reset errno
+	// Process the header, which is a special initial comment
 #if TRACE >= 2
-				fprintf(stderr, "parseCnlHeader(), nodes: %lu\n", ndsnum);
+	size_t  lnum = 0;  // The number of lines read
 #endif // TRACE
-			} else {
-#if TRACE >= 1
-#if TRACE < 2
-			if(verbose)
-#endif // TRACE 2
-				fprintf(
+	char*  line;
+	while((line = lines.readline())) {
 #if TRACE >= 2
-				stderr
-#else
-				stdout
-#endif // TRACE 2
-				, "WARNING parseCnlHeader(), the header parsing is omitted"
-					" because of the unexpected attribute: %s\n", tok);
-#endif // TRACE 1
-				break;
-			}
-		} while((tok = strtok(nullptr, attrnameDelim)) && attrs < 2);
-
-		// Validate and correct the number of clusters if required
-		// Note: it's better to reallocate a container a few times than too much overconsume the memory
-		if(ndsnum && clsnum > ndsnum) {
-			fprintf(stderr, "WARNING parseCnlHeader(), clsnum (%lu) typically should be"
-				" less than ndsnum (%lu)\n", clsnum, ndsnum);
-			clsnum = ndsnum;
-			//assert(0 && "parseCnlHeader(), clsnum typically should be less than ndsnum");
-		}
+		++lnum;
+#endif // TRACE
+		// Skip empty lines considering the CRLF line endings
+		if(!lines.length() || (lines.length() == 1 && *line == '\r'))
+			continue;
+		// Consider only subsequent comments
+		if(line[0] != '#')
+			break;
+		if(!parseCnlHeaderLine(line, clsnum, ndsnum, verbose))
+			continue;
 		// Get following line for the unified subsequent processing
-		line.readline(fcls);
+		line = lines.readline();
 		break;
 	}
+#if TRACE >= 2
+	fprintf(stderr, "parseCnlHeader(), processed %lu lines\n", lnum);
+#endif // TRACE
+	return line;
+}
+
+void parseCnlHeader(const MappedFile& fcls, size_t& clsnum, size_t& ndsnum, bool verbose)
+{
+	errno = 0;  // Reset errno
+	// Process the header, which is a special initial comment
+	string  line;  // Modifiable copy of the processing line
+#if TRACE >= 2
+	size_t  lnum = 0;  // The number of lines read
+#endif // TRACE
+	for(const char *pos = fcls.data(), *end = pos + fcls.size(); pos != end;) {
+		const char*  eol = static_cast<const char*>(memchr(pos, '\n', end - pos));
+		eol = eol ? eol + 1 : end;
+#if TRACE >= 2
+		++lnum;
+#endif // TRACE
+		const char* const  lbeg = pos;
+		pos = eol;
+		// Skip empty lines considering the CRLF line endings
+		if(*lbeg == '\n' || (*lbeg == '\r' && eol - lbeg <= 2))
+			continue;
+		// Consider only subsequent comments
+		if(*lbeg != '#')
+			break;
+		line.assign(lbeg, eol);
+		if(parseCnlHeaderLine(&line[0], clsnum, ndsnum, verbose))
+			break;
+	}
 #if TRACE >= 2
 	fprintf(stderr, "parseCnlHeader(), processed %lu lines of '%s'\n"
 		, lnum, fcls.name().c_str());
 #endif // TRACE
 }
 
+//! \brief Fingerprint of the file to validate its sidecar
+struct FileStamp {
+	uint64_t  size;  //!< File size
+	uint64_t  mtime;  //!< Modification time, ns
+};
+
+//! \brief Fetch the fingerprint of the regular file
+//!
+//! \param filename const char*  - the file name
+//! \param[out] stamp FileStamp&  - resulting fingerprint
+//! \return bool  - the file is regular and its fingerprint is fetched
+static bool fileStamp(const char* filename, FileStamp& stamp) noexcept
+{
+#ifdef __unix__
+	struct stat  filest;
+	if(stat(filename, &filest) || !S_ISREG(filest.st_mode))
+		return false;
+	stamp.size = filest.st_size;
+	stamp.mtime = uint64_t(filest.st_mtim.tv_sec) * 1000000000 + filest.st_mtim.tv_nsec;
+	return true;
+#else
+	return false;
+#endif // __unix__
+}
+
+//! Sidecar header of the CNL counts
+constexpr char  cntHeader[] = "# CNL counts: size mtime_ns clusters nodes\n";
+
+bool loadCnlCounts(const char* filename, size_t& clsnum, size_t& ndsnum)
+{
+	FileStamp  stamp;
+	if(!fileStamp(filename, stamp))
+		return false;
+	FileWrapper  fcnt(fopen((string(filename) += ".cnt").c_str(), "r"));
+	if(!fcnt)
+		return false;
+	char  header[sizeof cntHeader];
+	unsigned long long  size, mtime, cls, nds;
+	if(!fgets(header, sizeof header, fcnt) || strcmp(header, cntHeader)
+	|| fscanf(fcnt, "%llu %llu %llu %llu", &size, &mtime, &cls, &nds) != 4
+	|| size != stamp.size || mtime != stamp.mtime) {
+#if TRACE >= 2
+		fprintf(stderr, "loadCnlCounts(), the sidecar of %s is outdated\n", filename);
+#endif // TRACE
+		return false;
+	}
+	clsnum = cls;
+	ndsnum = nds;
+	return true;
+}
+
+void saveCnlCounts(const char* filename, size_t clsnum, size_t ndsnum)
+{
+	FileStamp  stamp;
+	if(!fileStamp(filename, stamp))
+		return;
+	const string  cntname = string(filename) += ".cnt";
+	FileWrapper  fcnt(fopen(cntname.c_str(), "w"));
+	if(!fcnt || fprintf(fcnt, "%s%llu %llu %llu %llu\n", cntHeader
+	, static_cast<unsigned long long>(stamp.size), static_cast<unsigned long long>(stamp.mtime)
+	, static_cast<unsigned long long>(clsnum), static_cast<unsigned long long>(ndsnum)) < 0)
+		perror(("WARNING saveCnlCounts(), the sidecar can't be saved: " + cntname).c_str());
+}
+
+string tempName(const string& filename)
+{
+	// Note: the name is distinct for the threads of the process
+	string  tmpname = filename + ".tmp" + to_string(std::hash<std::thread::id>()(
+		std::this_thread::get_id()));
+#ifdef __unix__
+	tmpname.append("-") += to_string(getpid());
+#endif // __unix__
+	return tmpname;
+}
+
+uint64_t contentHash(const char* data, size_t size) noexcept
+{
+	constexpr uint64_t  prime = 0x9E3779B97F4A7C15;  // Golden ratio multiplier
+	auto mix = [prime](uint64_t h, uint64_t word) noexcept -> uint64_t {
+		h = (h ^ word) * prime;
+		return h << 31 | h >> 33;
+	};
+	// Note: independent lanes are used to process the words at the memory bandwidth
+	uint64_t  lanes[4] = {size, prime, ~size, ~prime};
+	size_t  i = 0;
+	for(; i + sizeof lanes <= size; i += sizeof lanes)
+		for(unsigned j = 0; j < 4; ++j) {
+			uint64_t  word;
+			memcpy(&word, data + i + j * sizeof word, sizeof word);
+			lanes[j] = mix(lanes[j], word);
+		}
+	uint64_t  tail = 0;
+	memcpy(&tail, data + i, size - i < sizeof tail ? size - i : sizeof tail);
+	uint64_t  h = mix(lanes[0], tail);
+	for(i += sizeof tail; i < size; ++i)
+		h = mix(h, static_cast<uint8_t>(data[i]));
+	for(unsigned j = 1; j < 4; ++j)
+		h = mix(h, lanes[j]);
+	return h ^ h >> 29;
+}
+
+string snapshotName(const char* cachedir, const char* filename, const char* suffix)
+{
+	FileStamp  stamp;
+	if(!fileStamp(filename, stamp))
+		return string();
+	error_code  err;
+	const string  srcpath = fs::canonical(filename, err).string();
+	if(err)
+		return string();
+	char  hexhash[17];
+	snprintf(hexhash, sizeof hexhash, "%016llx", static_cast<unsigned long long>(
+		contentHash(srcpath.data(), srcpath.size())));
+	return (path(cachedir) / (fs::path(filename).filename().string()
+		+ '.' + hexhash + suffix)).string();
+}
+
+//! Header of the snapshot key
+constexpr char  snapKeyHeader[] = "# Snapshot key: size mtime_ns content_hash path\n";
+
+//! Max granularity of the file modification time (FAT), ns
+constexpr uint64_t  mtimeGranularity = 2000000000;
+
+bool snapshotActual(const string& snapname, const char* filename, MappedFile& content)
+{
+	FileStamp  stamp;
+	FileStamp  keystamp;
+	const string  keyname = snapname + ".key";
+	if(!fileStamp(filename, stamp) || !fileStamp(keyname.c_str(), keystamp))
+		return false;
+	error_code  err;
+	const string  srcpath = fs::canonical(filename, err).string();
+	FileWrapper  fkey(fopen(keyname.c_str(), "r"));
+	if(err || !fkey)
+		return false;
+	char  header[sizeof snapKeyHeader];
+	unsigned long long  size, mtime, hash;
+	// Note: the path is the remained line, which is validated by its length and content
+	string  keypath(srcpath.size() + 2, '\0');
+	bool  actual = fgets(header, sizeof header, fkey) && !strcmp(header, snapKeyHeader)
+		&& fscanf(fkey, "%llu %llu %llx ", &size, &mtime, &hash) == 3
+		&& fgets(&keypath[0], keypath.size(), fkey)
+		&& size == stamp.size && mtime == stamp.mtime
+		&& keypath.compare(0, srcpath.size() + 1, srcpath + '\n') == 0;
+	// Note: the content is mapped and hashed only if its modification could be missed
+	if(actual && stamp.mtime + mtimeGranularity >= keystamp.mtime) {
+		if(!content)
+			content = MappedFile(filename);
+		actual = content && hash == contentHash(content.data(), content.size());
+	}
+#if TRACE >= 2
+	if(!actual)
+		fprintf(stderr, "snapshotActual(), the snapshot %s is outdated\n", snapname.c_str());
+#endif // TRACE
+	return actual;
+}
+
+void saveSnapshotKey(const string& snapname, const char* filename, uint64_t chash)
+{
+	FileStamp  stamp;
+	error_code  err;
+	const string  srcpath = fs::canonical(filename, err).string();
+	if(err || !fileStamp(filename, stamp))
+		return;
+	// Note: the key is written to the temporary file and renamed to be replaced atomically
+	const string  keyname = snapname + ".key";
+	const string  tmpname = tempName(keyname);
+	bool  done;
+	{
+		FileWrapper  fkey(fopen(tmpname.c_str(), "w"));
+		done = fkey && fprintf(fkey, "%s%llu %llu %016llx %s\n", snapKeyHeader
+			, static_cast<unsigned long long>(stamp.size), static_cast<unsigned long long>(stamp.mtime)
+			, static_cast<unsigned long long>(chash), srcpath.c_str()) > 0;
+	}
+	if(!done || rename(tmpname.c_str(), keyname.c_str())) {
+		perror(("WARNING saveSnapshotKey(), the snapshot key can't be saved: " + keyname).c_str());
+		remove(tmpname.c_str());
+	}
+}
+
 size_t estimateCnlNodes(size_t filesize, float membership) noexcept
 {
 	if(membership <= 0) {
@@ -20,9 +20,15 @@
 #include <utility>  // move
 #include <string>
 #include <vector>
+#include <memory>  // unique_ptr
 #include <unordered_set>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>  // is_unsigned
+#include <algorithm>  // sort, inplace_merge, unique
+#include <mutex>
 // For the template definitions
-#include <cstring>  // strtok
+#include <cstring>  // strtok_r
 #include <cmath>  // sqrt
 
 #ifdef INCLUDE_STL_FS
@@ -129,6 +135,37 @@ public:
     }
 };
 
+//! \brief Whether the file name designates the standard stream (stdin or stdout)
+//!
+//! \param filename const char*  - the file name
+//! \return bool  - the file name is "-"
+inline bool isStdStream(const char* filename) noexcept
+{
+	return filename && filename[0] == '-' && !filename[1];
+}
+
+//! \brief Whether the input is streamed (stdin, named pipe, socket), i.e. it
+//! can be read only sequentially and its size is not known in advance
+//!
+//! \param filename const char*  - the file name
+//! \return bool  - the input is not a regular file
+bool isStreamed(const char* filename) noexcept;
+
+//! \brief Open the file or fetch the standard stream for "-"
+//!
+//! \param filename const char*  - the file name, "-" designates stdin for the
+//! 	reading modes and stdout otherwise
+//! \param mode const char*  - opening mode, the same as fopen() has
+//! \return FILE*  - the opened file or nullptr on failure
+inline FILE* openFile(const char* filename, const char* mode) noexcept
+{
+	if(!filename || !mode)
+		return nullptr;
+	if(isStdStream(filename))
+		return mode[0] == 'r' ? stdin : stdout;
+	return fopen(filename, mode);
+}
+
 //! \brief Wrapper around the FILE* that holds also the filename giving ability
 //! to reopen it and perform meaningful
 // Note: we can't inherit from the FileWrapper because semantic of reset differs
@@ -143,10 +180,11 @@ public:
     //! \brief Constructor
     //! \pre Parent directory must exists
     //!
-    //! \param filename const char*  - new file name to be opened
+    //! \param filename const char*  - new file name to be opened, "-" designates
+    //! 	stdin or stdout depending on the mode, which are not closed
     //! \param mode const char*  - opening mode, the same as fopen() has
 	NamedFileWrapper(const char* filename, const char* mode)
-	: m_file(filename && mode ? fopen(filename, mode) : nullptr)
+	: m_file(openFile(filename, mode), !isStdStream(filename))
 	, m_name(filename ? filename : "")  {}
 
     //! \brief Copy constructor
@@ -178,7 +216,7 @@ public:
 
     //! \brief File size
     //!
-    //! \return size_t  - file size or -1 on error
+    //! \return size_t  - file size or -1 on error or for the streamed input
     size_t size() const noexcept;
 
     //! \brief Implicit conversion to the file descriptor
@@ -192,7 +230,7 @@ public:
     //! \return NamedFileWrapper&  - the reopened file or closed (if can't be opened)
     NamedFileWrapper& reopen(const char* mode)
     {
-		m_file.reset(freopen(nullptr, mode, m_file));  // m_name.c_str()
+		m_file.reset(freopen(nullptr, mode, m_file), !isStdStream(m_name.c_str()));  // m_name.c_str()
 		return *this;
     }
 
@@ -273,6 +311,351 @@ public:
 	bool readline(FILE* input);
 };
 
+//! \brief Decompressor of the gzip stream, which inflates the input on a
+//! dedicated thread into a ring buffer
+class GzipStream;
+
+//! \brief Block-buffered reader of the file lines
+//! \note Large blocks are read at once, lines are located by memchr() and
+//! returned as views of the block, the partial line is carried to the next block.
+//! The file position is not requested, so non-seekable streams (pipes,
+//! stdin) are supported. Gzip input is detected by the magic and
+//! decompressed transparently on a dedicated thread.
+//! \attention The file should not be read by the stdio functions concurrently
+class LineReader {
+	FILE*  m_file;  //!< Input file
+	std::unique_ptr<GzipStream>  m_gzip;  //!< Decompressor of the gzip input if any
+	StringBufferBase  m_buf;  //!< Block buffer, the last byte is reserved for the terminator
+	size_t  m_pos;  //!< Begin of the unprocessed data in the buffer
+	size_t  m_end;  //!< End of the loaded data in the buffer
+	size_t  m_length;  //!< Length of the last read line
+	size_t  m_size;  //!< Estimated size of the (decompressed) content, -1 if unknown
+	bool  m_eof;  //!< The whole file is loaded
+public:
+	constexpr static size_t  blockmin = 1 << 20;  //!< Min block size, 1 MB
+	constexpr static size_t  blockmax = 8 << 20;  //!< Max block size, 8 MB
+
+    //! \brief Constructor
+    //! \note The block size is reduced to the file size for the small regular files
+    //!
+    //! \param input FILE*  - the file to be read
+    //! \param blocksize=4<<20 size_t  - the number of bytes read at once,
+    //! 	E [blockmin, blockmax]
+	explicit LineReader(FILE* input, size_t blocksize=4 << 20);
+
+    //! \brief Copy constructor
+    //! \note The buffered content should have a single owner
+	LineReader(const LineReader&)=delete;
+
+    //! \brief Copy assignment
+    //! \note The buffered content should have a single owner
+	LineReader& operator= (const LineReader&)=delete;
+
+    //! \brief Destructor
+	~LineReader();
+
+    //! \brief Read the next line
+    //! \attention The returned line is valid only until the next call
+    //!
+    //! \return char*  - the null-terminated line without the trailing '\n',
+    //! 	which can be modified (tokenized), or nullptr if all lines are read
+	char* readline();
+
+    //! \brief Length of the last read line
+    //!
+    //! \return size_t  - the number of chars excluding the terminating '\n' and 0
+	size_t length() const noexcept  { return m_length; }
+
+    //! \brief Estimated size of the content
+    //! \note The decompressed size of the gzip file is estimated from its
+    //! trailer, which is exact for the single-member files < 4 GB
+    //!
+    //! \return size_t  - the number of bytes or -1 if unknown (non-regular files)
+	size_t size() const noexcept  { return m_size; }
+
+    //! \brief Whether the input is gzip compressed
+	bool compressed() const noexcept  { return bool(m_gzip); }
+private:
+    //! \brief Load the next block appending it to the unprocessed data
+    //! \post m_eof is set if no more data is available
+    //!
+    //! \return size_t  - the number of loaded bytes
+	size_t load();
+
+    //! \brief Read the raw (or decompressed) input
+    //!
+    //! \param dst char*  - destination buffer
+    //! \param size size_t  - the number of bytes to be read
+    //! \return size_t  - the number of read bytes, 0 on the end of the input
+	size_t fetch(char* dst, size_t size);
+};
+
+//! \brief Read-only view of the whole file content, which is memory mapped
+//! when possible
+//! \note The content is read into the allocated buffer when the file can't be
+//! mapped (non-regular files or mapping errors) or is gzip compressed (the
+//! decompressed content is held)
+//! \attention The content is not null-terminated
+class MappedFile {
+	const char*  m_data;  //!< File content, nullptr if the file is not opened
+	size_t  m_size;  //!< The number of bytes in the content
+	bool  m_mapped;  //!< The content is memory mapped rather than allocated
+	StringBufferBase  m_buf;  //!< Content holder if the file is not mapped
+	string  m_name;  //!< File name
+public:
+    //! \brief Default Constructor
+	MappedFile() noexcept
+	: m_data(nullptr), m_size(0), m_mapped(false), m_buf(), m_name()  {}
+
+    //! \brief Constructor
+    //! \note errno is set on the file opening failure
+    //!
+    //! \param filename const char*  - name of the file to be opened
+	explicit MappedFile(const char* filename);
+
+    //! \brief Copy constructor
+    //! \note Any file mapping should have a single owner
+	MappedFile(const MappedFile&)=delete;
+
+	//! \brief Move constructor
+	MappedFile(MappedFile&& mf) noexcept;
+
+    //! \brief Copy assignment
+    //! \note Any file mapping should have a single owner
+	MappedFile& operator= (const MappedFile&)=delete;
+
+	//! \brief Move assignment
+	MappedFile& operator= (MappedFile&& mf) noexcept;
+
+    //! \brief Destructor
+	~MappedFile();
+
+    //! \brief Whether the file is opened
+	operator bool() const noexcept  { return m_data; }
+
+    //! \brief File name
+    //!
+    //! \return const string&  - file name
+	const string& name() const noexcept  { return m_name; }
+
+    //! \brief File content
+    //!
+    //! \return const char*  - the content, which is not null-terminated
+	const char* data() const noexcept  { return m_data; }
+
+    //! \brief File size
+    //!
+    //! \return size_t  - the number of bytes in the content
+	size_t size() const noexcept  { return m_size; }
+
+    //! \brief Whether the content is memory mapped
+	bool mapped() const noexcept  { return m_mapped; }
+private:
+    //! \brief Release the held content
+	void clear() noexcept;
+
+    //! \brief Replace the gzip compressed content with the decompressed one
+    //! \post The file is closed (the content is released) on the decompression errors
+	void inflateContent();
+};
+
+// Parsing functions -----------------------------------------------------------
+//! \brief Overflow of the node id type by the loading ids
+//! \note The input can be reloaded with the wider ids on this exception
+struct IdOverflow: std::overflow_error {
+	using std::overflow_error::overflow_error;
+};
+
+//! \brief Whether the char is a delimiter of the CNL members
+//! \note '\r' is a delimiter to handle CRLF line endings
+//!
+//! \param c char  - the char to be checked
+//! \return bool  - the char is a delimiter
+constexpr bool isCnlSpace(char c) noexcept
+{
+	return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+//! \brief Skip the delimiters of the CNL members
+//!
+//! \param pos const char*  - the scanning position
+//! \param end const char*  - the end of the scanning range
+//! \return const char*  - the first non-delimiter position or end
+inline const char* skipCnlSpaces(const char* pos, const char* end) noexcept
+{
+	while(pos != end && isCnlSpace(*pos))
+		++pos;
+	return pos;
+}
+
+//! \brief Find the end of the CNL token
+//!
+//! \param pos const char*  - the token begin
+//! \param end const char*  - the end of the scanning range
+//! \return const char*  - the position after the last token char
+inline const char* cnlTokenEnd(const char* pos, const char* end) noexcept
+{
+	while(pos != end && !isCnlSpace(*pos))
+		++pos;
+	return pos;
+}
+
+//! \brief Scan the decimal id from the CNL member token skipping the share
+//! (":<share>") or any other non-numeric suffix of the token
+//!
+//! \tparam Id  - unsigned id type
+//!
+//! \param[in,out] pos const char*&  - the token begin, which is set to the token end
+//! \param end const char*  - the end of the scanning range
+//! \return Id  - the scanned id
+template <typename Id>
+Id scanId(const char*& pos, const char* end);
+
+//! \brief Append the unsigned value in the variable-length (LEB128) encoding
+//!
+//! \tparam T  - unsigned value type
+//!
+//! \param buf vector<uint8_t>&  - the buffer to be extended
+//! \param val T  - the value to be encoded
+//! \return void
+template <typename T>
+void appendVarint(vector<uint8_t>& buf, T val);
+
+//! \brief Scan the unsigned value in the variable-length (LEB128) encoding
+//!
+//! \tparam T  - unsigned value type
+//!
+//! \param[in,out] pos const uint8_t*&  - the encoded value begin, which is set
+//! 	to the next value
+//! \param end const uint8_t*  - the end of the scanning range
+//! \return T  - the decoded value
+template <typename T>
+T scanVarint(const uint8_t*& pos, const uint8_t* end);
+
+//! \brief Append the unsigned value formatted as a decimal number
+//! \note Replaces printf("%lu") for the bulk output of the formatted values
+//!
+//! \tparam T  - unsigned value type
+//!
+//! \param buf vector<char>&  - the buffer to be extended
+//! \param val T  - the value to be formatted
+//! \return void
+template <typename T>
+void appendDecimal(vector<char>& buf, T val);
+
+// String ids interning --------------------------------------------------------
+//! \brief Open-addressing table of the string tokens (node ids), which are
+//! enumerated densely in the order of their first occurrence
+//! \note The table is not thread-safe, the tokens are interned into the local
+//! tables concurrently and then merged into the shared IdInterner
+//!
+//! \tparam Id  - unsigned id type
+template <typename Id>
+class StrIds {
+	static_assert(std::is_unsigned<Id>::value, "StrIds, Id should be an unsigned type");
+
+	//! \brief Slot of the hash table
+	struct Slot {
+		uint64_t  hash;  //!< Token hash
+		Id  ref;  //!< Token id + 1, 0 for the empty slot
+	};
+
+	vector<Slot>  m_slots;  //!< Hash table of the power of 2 size, load factor <= 1/2
+	vector<char>  m_chars;  //!< Concatenated tokens
+	vector<size_t>  m_offs;  //!< Offsets of the tokens by id including the end offset
+	vector<uint64_t>  m_hashes;  //!< Hashes of the tokens by id
+public:
+    //! \brief Default constructor
+	StrIds(): m_slots(), m_chars(), m_offs(1, 0), m_hashes()  {}
+
+    //! \brief Hash of the token
+    //!
+    //! \param tok const char*  - the token
+    //! \param len size_t  - the token length
+    //! \return uint64_t  - the token hash
+	static uint64_t hash(const char* tok, size_t len) noexcept;
+
+    //! \brief Intern the token
+    //!
+    //! \param tok const char*  - the token
+    //! \param len size_t  - the token length
+    //! \param hash uint64_t  - the token hash, see hash()
+    //! \return Id  - the token id
+	Id intern(const char* tok, size_t len, uint64_t hash);
+
+    //! \brief Intern the token
+    //!
+    //! \param tok const char*  - the token
+    //! \param len size_t  - the token length
+    //! \return Id  - the token id
+	Id intern(const char* tok, size_t len)  { return intern(tok, len, hash(tok, len)); }
+
+    //! \brief The number of interned tokens
+	size_t size() const noexcept  { return m_hashes.size(); }
+
+    //! \brief The interned token
+    //!
+    //! \param id Id  - the token id, < size()
+    //! \return const char*  - the token begin, which is not null-terminated
+	const char* token(Id id) const noexcept  { return m_chars.data() + m_offs[id]; }
+
+    //! \brief The interned token length
+    //!
+    //! \param id Id  - the token id, < size()
+    //! \return size_t  - the token length
+	size_t length(Id id) const noexcept  { return m_offs[id + 1] - m_offs[id]; }
+
+    //! \brief The interned token hash
+    //!
+    //! \param id Id  - the token id, < size()
+    //! \return uint64_t  - the token hash
+	uint64_t hash(Id id) const noexcept  { return m_hashes[id]; }
+
+    //! \brief Release all tokens
+	void clear() noexcept;
+private:
+    //! \brief Double the hash table
+	void grow();
+};
+
+//! \brief Interner of the string tokens (node ids) into the dense ids, which is
+//! shared by the loading clusterings and node base
+//! \note The interning is thread-safe
+//!
+//! \tparam Id  - unsigned id type
+template <typename Id>
+class IdInterner {
+	StrIds<Id>  m_ids;  //!< Interned tokens
+	mutable std::mutex  m_mutex;  //!< Guard of the interned tokens
+public:
+    //! \brief Default constructor
+	IdInterner(): m_ids(), m_mutex()  {}
+
+    //! \brief Intern the token
+    //!
+    //! \param tok const char*  - the token
+    //! \param len size_t  - the token length
+    //! \return Id  - the token id
+	Id intern(const char* tok, size_t len);
+
+    //! \brief Intern the tokens of the local table in their order
+    //! \note The shared ids are deterministic if the local tables are merged
+    //! in the input order
+    //!
+    //! \param local const StrIds<Id>&  - the local table
+    //! \return vector<Id>  - shared ids indexed by the local ids
+	vector<Id> merge(const StrIds<Id>& local);
+
+    //! \brief The number of interned tokens
+	size_t size() const;
+
+    //! \brief The interned token
+    //!
+    //! \param id Id  - the token id
+    //! \return string  - the token
+	string name(Id id) const;
+};
+
 #ifndef NO_FILEIO  // Turn off file I/O
 
 // File I/O functions declaration ----------------------------------------------
@@ -294,6 +677,97 @@ void ensureDir(const string& dir);
 void parseCnlHeader(NamedFileWrapper& fcls, StringBuffer& line, size_t& clsnum
 	, size_t& ndsnum, bool verbose=false);
 
+//! \brief  Parse the header of CNL file read by lines and validate the results
+//! \post clsnum <= ndsnum if ndsnum > 0. 0 means not specified
+//!
+//! \param lines LineReader&  - the reading file
+//! \param[out] clsnum size_t&  - resulting number of clusters if specified, 0 in case of parsing errors
+//! \param[out] ndsnum size_t&  - resulting number of nodes if specified, 0 in case of parsing errors
+//! \param verbose=false bool  - print information about the header parsing issue to the stdout
+//! \return char*  - the first line following the header or nullptr if all lines are read
+char* parseCnlHeader(LineReader& lines, size_t& clsnum, size_t& ndsnum, bool verbose=false);
+
+//! \brief  Parse the header of the CNL content and validate the results
+//! \post clsnum <= ndsnum if ndsnum > 0. 0 means not specified
+//!
+//! \param fcls const MappedFile&  - the CNL content
+//! \param[out] clsnum size_t&  - resulting number of clusters if specified, 0 in case of parsing errors
+//! \param[out] ndsnum size_t&  - resulting number of nodes if specified, 0 in case of parsing errors
+//! \param verbose=false bool  - print information about the header parsing issue to the stdout
+//! \return void
+void parseCnlHeader(const MappedFile& fcls, size_t& clsnum, size_t& ndsnum
+	, bool verbose=false);
+
+//! \brief Load the exact counts of the CNL file from its sidecar file
+//! (<filename>.cnt) if the sidecar is actual
+//! \note The sidecar is actual if the size and modification time of the CNL
+//! file match the stored ones
+//!
+//! \param filename const char*  - the CNL file name
+//! \param[out] clsnum size_t&  - the number of clusters
+//! \param[out] ndsnum size_t&  - the number of unique nodes
+//! \return bool  - the counts are loaded from the actual sidecar
+bool loadCnlCounts(const char* filename, size_t& clsnum, size_t& ndsnum);
+
+//! \brief Save the exact counts of the CNL file to its sidecar file (<filename>.cnt)
+//! \note The saving is omitted for non-regular files, the failure is reported
+//! but not thrown since the sidecar is just a cache
+//!
+//! \param filename const char*  - the CNL file name
+//! \param clsnum size_t  - the number of clusters
+//! \param ndsnum size_t  - the number of unique nodes
+//! \return void
+void saveCnlCounts(const char* filename, size_t clsnum, size_t ndsnum);
+
+//! \brief Name of the temporary file to be renamed to the specified file
+//! on its completion, which is distinct for the concurrent threads and processes
+//!
+//! \param filename const string&  - the target file name
+//! \return string  - the temporary file name
+string tempName(const string& filename);
+
+//! \brief Hash of the file content to fingerprint the cached snapshots
+//!
+//! \param data const char*  - the content
+//! \param size size_t  - the number of bytes in the content
+//! \return uint64_t  - the content hash
+uint64_t contentHash(const char* data, size_t size) noexcept;
+
+//! \brief Name of the cached snapshot of the file
+//! \note The name is formed from the file name and hash of its canonical path,
+//! so distinct files with the same name do not share the snapshot
+//!
+//! \param cachedir const char*  - the cache directory
+//! \param filename const char*  - the source file name
+//! \param suffix const char*  - suffix of the snapshot name including its extension,
+//! 	which distinguishes the snapshots of the same file built with distinct options
+//! \return string  - the snapshot name or an empty string if the source file is not
+//! 	a regular file and can not be fingerprinted
+string snapshotName(const char* cachedir, const char* filename, const char* suffix);
+
+//! \brief Whether the cached snapshot corresponds to the source file
+//! \note The snapshot is actual if the path, size and modification time of the
+//! source file match the ones stored in the snapshot key (<snapname>.key).
+//! The content hash is verified (rereading the whole content) only if the source
+//! file was modified shortly before the key saving, since such a modification
+//! may retain the modification time under the coarse file system timestamps.
+//!
+//! \param snapname const string&  - the snapshot name
+//! \param filename const char*  - the source file name
+//! \param content MappedFile&  - content of the source file, which is mapped
+//! 	on the hash verification if it is not opened yet
+//! \return bool  - the snapshot is actual
+bool snapshotActual(const string& snapname, const char* filename, MappedFile& content);
+
+//! \brief Save the key of the cached snapshot (<snapname>.key)
+//! \note The failure is reported but not thrown since the snapshot is just a cache
+//!
+//! \param snapname const string&  - the snapshot name
+//! \param filename const char*  - the source file name
+//! \param chash uint64_t  - content hash of the source file
+//! \return void
+void saveSnapshotKey(const string& snapname, const char* filename, uint64_t chash);
+
 //! \brief Load all unique nodes from the CNL file with optional filtering by the cluster size
 //!
 //! \tparam Id  - Node id type
@@ -308,10 +782,13 @@ void parseCnlHeader(NamedFileWrapper& fcls, StringBuffer& line, size_t& clsnum
 //! \param cmin=0 size_t  - min allowed cluster size
 //! \param cmax=0 size_t  - max allowed cluster size, 0 means any size
 //! \param verbose=true bool  - print the number of loaded nodes to the stdout
-//! \return unordered_set<Id>  - the loaded collection of nodes
+//! \param strids=nullptr IdInterner<Id>*  - interner of the string node ids,
+//! 	the members are numeric ids if nullptr
+//! \return vector<Id>  - the loaded ordered unique node ids
 template <typename Id, typename AccId>
-unordered_set<Id> loadNodes(NamedFileWrapper& file, float membership=1
-	, AggHash<Id, AccId>* ahash=nullptr, size_t cmin=0, size_t cmax=0, bool verbose=true);
+vector<Id> loadNodes(NamedFileWrapper& file, float membership=1
+	, AggHash<Id, AccId>* ahash=nullptr, size_t cmin=0, size_t cmax=0, bool verbose=true
+	, IdInterner<Id>* strids=nullptr);
 
 //! \brief Estimate the number of nodes from the CNL file size
 //!
@@ -335,12 +812,185 @@ size_t estimateClusters(size_t ndsnum, float membership=1.f) noexcept;
 //! \return constexpr const char*  - resulting c-string
 constexpr const char* toYesNo(bool val) noexcept  { return val ? "yes" : "no"; }
 
+#endif  // NO_FILEIO
+
+// Parsing templates definition ------------------------------------------------
+template <typename Id>
+Id scanId(const char*& pos, const char* end)
+{
+	static_assert(std::is_unsigned<Id>::value, "scanId(), Id should be an unsigned type");
+	const char* const  tok = pos;
+	constexpr Id  idmax = std::numeric_limits<Id>::max();
+	// Note: the comparison of the unsigned difference replaces two comparisons
+	// of the char range
+	Id  val = 0;
+	bool  overflow = false;
+	for(unsigned dig; pos != end && (dig = unsigned(*pos) - '0') <= 9; ++pos) {
+		// Note: the overflow is detected before the accumulation, so all ids of
+		// the full Id range are accepted
+		if(val > (idmax - dig) / 10)
+			overflow = true;
+		else val = val * 10 + dig;
+	}
+	if(pos == tok)
+		throw std::invalid_argument(string("ERROR scanId(), the id is expected instead of: '")
+			.append(tok, cnlTokenEnd(tok, end)) += "'\n");
+	if(overflow)
+		throw IdOverflow(string("ERROR scanId(), the id value is too large: ")
+			.append(tok, pos) += "\n");
+	// Skip the share part if exists
+	pos = cnlTokenEnd(pos, end);
+	return val;
+}
+
+template <typename T>
+void appendVarint(vector<uint8_t>& buf, T val)
+{
+	static_assert(std::is_unsigned<T>::value, "appendVarint(), T should be an unsigned type");
+	for(; val >= 0x80; val >>= 7)
+		buf.push_back(uint8_t(val) | 0x80);
+	buf.push_back(val);
+}
+
+template <typename T>
+T scanVarint(const uint8_t*& pos, const uint8_t* end)
+{
+	static_assert(std::is_unsigned<T>::value, "scanVarint(), T should be an unsigned type");
+	T  val = 0;
+	for(unsigned  shift = 0; pos != end && shift < sizeof(T) * 8; shift += 7) {
+		const uint8_t  byte = *pos++;
+		val |= T(byte & 0x7F) << shift;
+		if(!(byte & 0x80))
+			return val;
+	}
+	throw std::out_of_range("ERROR scanVarint(), the value is truncated or too large\n");
+}
+
+template <typename T>
+void appendDecimal(vector<char>& buf, T val)
+{
+	static_assert(std::is_unsigned<T>::value, "appendDecimal(), T should be an unsigned type");
+	char  digs[std::numeric_limits<T>::digits10 + 1];
+	char* const  end = digs + sizeof digs;
+	char*  pos = end;
+	do {
+		*--pos = '0' + val % 10;
+		val /= 10;
+	} while(val);
+	buf.insert(buf.end(), pos, end);
+}
+
+// String ids interning templates definition -----------------------------------
+template <typename Id>
+uint64_t StrIds<Id>::hash(const char* tok, size_t len) noexcept
+{
+	constexpr uint64_t  prime = 0x9E3779B97F4A7C15;  // Golden ratio multiplier
+	uint64_t  h = len * prime;
+	uint64_t  word;
+	for(; len >= sizeof word; tok += sizeof word, len -= sizeof word) {
+		memcpy(&word, tok, sizeof word);
+		h = (h ^ word) * prime;
+		h ^= h >> 32;
+	}
+	word = 0;
+	memcpy(&word, tok, len);
+	h = (h ^ word) * prime;
+	return h ^ h >> 29;
+}
+
+template <typename Id>
+Id StrIds<Id>::intern(const char* tok, size_t len, uint64_t hash)
+{
+	if(m_hashes.size() * 2 >= m_slots.size())
+		grow();
+	const size_t  mask = m_slots.size() - 1;
+	for(size_t i = hash & mask;; i = (i + 1) & mask) {
+		Slot&  slot = m_slots[i];
+		if(!slot.ref) {
+			// Note: the id is stored incremented
+			const size_t  id = m_hashes.size();
+			if(id >= std::numeric_limits<Id>::max())
+				throw IdOverflow("ERROR intern(), the number of distinct ids exceeds "
+					+ std::to_string(std::numeric_limits<Id>::max()) + "\n");
+			slot.hash = hash;
+			slot.ref = id + 1;
+			m_chars.insert(m_chars.end(), tok, tok + len);
+			m_offs.push_back(m_chars.size());
+			m_hashes.push_back(hash);
+			return id;
+		}
+		if(slot.hash == hash && length(slot.ref - 1) == len
+		&& !memcmp(token(slot.ref - 1), tok, len))
+			return slot.ref - 1;
+	}
+}
+
+template <typename Id>
+void StrIds<Id>::clear() noexcept
+{
+	m_slots.clear();
+	m_chars.clear();
+	m_offs.assign(1, 0);
+	m_hashes.clear();
+}
+
+template <typename Id>
+void StrIds<Id>::grow()
+{
+	// Note: the tokens are not compared on the rehashing since they are unique
+	vector<Slot>  slots(std::max<size_t>(m_slots.size() * 2, 64), Slot{0, 0});
+	const size_t  mask = slots.size() - 1;
+	for(size_t id = 0; id < m_hashes.size(); ++id) {
+		size_t  i = m_hashes[id] & mask;
+		while(slots[i].ref)
+			i = (i + 1) & mask;
+		slots[i] = Slot{m_hashes[id], Id(id + 1)};
+	}
+	m_slots = move(slots);
+}
+
+template <typename Id>
+Id IdInterner<Id>::intern(const char* tok, size_t len)
+{
+	const uint64_t  hash = StrIds<Id>::hash(tok, len);
+	std::lock_guard<std::mutex>  lock(m_mutex);
+	return m_ids.intern(tok, len, hash);
+}
+
+template <typename Id>
+vector<Id> IdInterner<Id>::merge(const StrIds<Id>& local)
+{
+	vector<Id>  ids;
+	ids.reserve(local.size());
+	std::lock_guard<std::mutex>  lock(m_mutex);
+	for(size_t i = 0; i < local.size(); ++i)
+		ids.push_back(m_ids.intern(local.token(i), local.length(i), local.hash(i)));
+	return ids;
+}
+
+template <typename Id>
+size_t IdInterner<Id>::size() const
+{
+	std::lock_guard<std::mutex>  lock(m_mutex);
+	return m_ids.size();
+}
+
+template <typename Id>
+string IdInterner<Id>::name(Id id) const
+{
+	std::lock_guard<std::mutex>  lock(m_mutex);
+	return string(m_ids.token(id), m_ids.length(id));
+}
+
+#ifndef NO_FILEIO  // Turn off file I/O
+
 // File I/O templates definition -----------------------------------------------
 template <typename Id, typename AccId>
-unordered_set<Id> loadNodes(NamedFileWrapper& file, float membership
-	, AggHash<Id, AccId>* ahash, size_t cmin, size_t cmax, bool verbose)
+vector<Id> loadNodes(NamedFileWrapper& file, float membership
+	, AggHash<Id, AccId>* ahash, size_t cmin, size_t cmax, bool verbose
+	, IdInterner<Id>* strids)
 {
-	unordered_set<Id>  nodebase;  // Node base;  Note: returned using NRVO optimization
+	vector<Id>  nodebase;  // Node base;  Note: returned using NRVO optimization
 
 	if(!file)
 		return nodebase;
@@ -349,15 +999,14 @@ unordered_set<Id> loadNodes(NamedFileWrapper& file, float membership
 	size_t  clsnum = 0;  // The number of clusters
 	size_t  ndsnum = 0;  // The number of nodes
 
-	// Note: strings defined out of the cycle to avoid reallocations
-	StringBuffer  line;  // Reading line
+	// Note: lines are read by large blocks without the file position requests
+	LineReader  lines(file);
 	// Parse header and read the number of clusters if specified
-	// Note: line includes terminating '\n'
-	parseCnlHeader(file, line, clsnum, ndsnum, verbose);
+	char*  line = parseCnlHeader(lines, clsnum, ndsnum, verbose);
 
 	// Estimate the number of nodes in the file if not specified
 	if(!ndsnum) {
-		size_t  cmsbytes = file.size();
+		size_t  cmsbytes = lines.size();
 		if(cmsbytes != size_t(-1))  // File length fetching failed
 			ndsnum = estimateCnlNodes(cmsbytes, membership);
 		else if(clsnum)
@@ -373,22 +1022,34 @@ unordered_set<Id> loadNodes(NamedFileWrapper& file, float membership
 	// Preallocate space for nodes
 	if(ndsnum)
 		nodebase.reserve(ndsnum);
+	// The nodes are accumulated and the unordered tail is periodically sorted
+	// and merged with the ordered unique head, which bounds the memory consumption
+	constexpr size_t  tailmin = 1 << 16;  // Min size of the tail to be merged
+	size_t  nsorted = 0;  // The number of the ordered unique ids in the head
+	auto compact = [&nodebase, &nsorted]() {
+		const auto  itail = nodebase.begin() + nsorted;
+		std::sort(itail, nodebase.end());
+		std::inplace_merge(nodebase.begin(), itail, nodebase.end());
+		nodebase.erase(std::unique(nodebase.begin(), nodebase.end()), nodebase.end());
+		nsorted = nodebase.size();
+	};
 
 	// Load clusters
-	// ATTENTION: without '\n' delimiter the terminating '\n' is read as an item
-	constexpr char  mbdelim[] = " \t\n";  // Delimiter for the members
+	// Note: the lines do not contain the terminating '\n', '\r' is a delimiter for CRLF
+	constexpr char  mbdelim[] = " \t\r";  // Delimiter for the members
+	StrIds<Id>  tokids;  // Local ids of the string tokens
 	vector<Id>  cnds;  // Cluster nodes. Note: a dedicated container is required to filter clusters by size
 	cnds.reserve(sqrt(ndsnum));  // Note: typically cluster size does not increase the square root of the number of nodes
 #if TRACE >= 2
 	size_t  totmbs = 0;  // The number of read member nodes from the file including repetitions
 	size_t  fclsnum = 0;  // The number of read clusters from the file
 #endif // TRACE
-	do {
+	for(; line; line = lines.readline()) {
 #if TRACE >= 3
-		// Note: line includes terminating '\n'
-		fprintf(stderr, "%lu> %s", fclsnum, static_cast<const char*>(line));
+		fprintf(stderr, "%lu> %s\n", fclsnum, line);
 #endif // TRACE
-		char *tok = strtok(line, mbdelim);  // const_cast<char*>(line.data())
+		char*  ctx = nullptr;  // Tokenization context, the files are loaded concurrently
+		char *tok = strtok_r(line, mbdelim, &ctx);
 
 		// Skip comments
 		if(!tok || tok[0] == '#')
@@ -396,7 +1057,7 @@ unordered_set<Id> loadNodes(NamedFileWrapper& file, float membership
 		// Skip the cluster id if present
 		if(tok[strlen(tok) - 1] == '>') {
 			const char* cidstr = tok;
-			tok = strtok(nullptr, mbdelim);
+			tok = strtok_r(nullptr, mbdelim, &ctx);
 			// Skip empty clusters, which actually should not exist
 			if(!tok) {
 				fprintf(stderr, "WARNING loadNodes(), empty cluster"
@@ -409,29 +1070,51 @@ unordered_set<Id> loadNodes(NamedFileWrapper& file, float membership
 			// but potentially can be considered in NMI and F1 evaluation.
 			// In the latter case abs diff of shares instead of co occurrence
 			// counting should be performed.
-			Id  nid = strtoul(tok, nullptr, 10);
+			// Note: the string tokens are interned locally to be merged at once
+			Id  nid;
+			if(strids)
+				nid = tokids.intern(tok, strlen(tok));
+			else {
+				// Note: strtoul saturates on the overflow, which is detected by the hashing range check
+				const auto  val = strtoul(tok, nullptr, 10);
+				if(val > AggHash<Id, AccId>::idmax)
+					throw IdOverflow(string("ERROR loadNodes(), the node id is too large: ")
+						.append(tok) += "\n");
+				nid = val;
 #if VALIDATE >= 2
-			if(!nid && tok[0] != '0') {
-				fprintf(stderr, "WARNING loadNodes(), conversion error of '%s' into 0: %s\n"
-					, tok, strerror(errno));
-				continue;
-			}
+				if(!nid && tok[0] != '0') {
+					fprintf(stderr, "WARNING loadNodes(), conversion error of '%s' into 0: %s\n"
+						, tok, strerror(errno));
+					continue;
+				}
 #endif // VALIDATE
+			}
 #if TRACE >= 2
 			++totmbs;  // Update the total number of read members
 #endif // TRACE
 			cnds.push_back(nid);
-		} while((tok = strtok(nullptr, mbdelim)));
+		} while((tok = strtok_r(nullptr, mbdelim, &ctx)));
 #if TRACE >= 2
 		++fclsnum;  // The number of valid read lines, i.e. clusters
 #endif // TRACE
 
 		// Filter read cluster by size
-		if(cnds.size() >= cmin && (!cmax || cnds.size() <= cmax))
-			nodebase.insert(cnds.begin(), cnds.end());
+		if(cnds.size() >= cmin && (!cmax || cnds.size() <= cmax)) {
+			nodebase.insert(nodebase.end(), cnds.begin(), cnds.end());
+			if(nodebase.size() - nsorted >= std::max(nsorted, tailmin))
+				compact();
+		}
 		// Prepare outer vars for the next iteration
 		cnds.clear();
-	} while(line.readline(file));
+	}
+	compact();
+	// Replace the local ids of the string tokens with the shared ones
+	if(strids) {
+		const auto  ids = strids->merge(tokids);
+		for(auto& nid: nodebase)
+			nid = ids[nid];
+		std::sort(nodebase.begin(), nodebase.end());
+	}
 //	// Rehash the nodes decreasing the allocated space if required
 //	if(nodebase.size() <= nodebase.bucket_count() * nodebase.max_load_factor() / 3)
 //		nodebase.reserve(nodebase.size());
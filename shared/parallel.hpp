@@ -0,0 +1,142 @@
+//! \brief Lightweight parallel execution primitives.
+//! The Dao (Deterministic Agglomerative Overlapping) of Clustering library:
+//! Robust & Fine-grained Deterministic Clustering for Large Networks.
+//!
+//! \license Apache License, Version 2.0: http://www.apache.org/licenses/LICENSE-2.0.html
+//! > 	Simple explanation: https://tldrlegal.com/license/apache-license-2.0-(apache-2.0)
+//!
+//! Copyright (c)
+//! \authr Artem Lutov
+//! \email luart@ya.ru
+//! \date 2019-03-12
+
+#ifndef PARALLEL_HPP
+#define PARALLEL_HPP
+
+#include <cstddef>  // size_t
+#include <thread>
+#include <atomic>
+#include <vector>
+#include <exception>  // exception_ptr
+#include <algorithm>  // min
+
+#include "macrodef.h"  // TRACE, VALIDATE
+
+
+namespace daoc {
+
+using std::thread;
+using std::atomic;
+using std::exception_ptr;
+
+//! \brief Serial processing scope of the calling thread, where workersNum()
+//! yields a single worker
+//! \note The workers of the parallel loop are in this scope, so the nested
+//! processing is serial and does not oversubscribe the CPUs
+class SerialScope {
+	bool  m_prev;  //!< The scope state of the thread before this scope
+public:
+    //! \brief Constructor entering the scope
+    //!
+    //! \param enter=true bool  - enter the scope, otherwise the state is retained
+	explicit SerialScope(bool enter=true) noexcept: m_prev(serial())
+	{
+		if(enter)
+			serial() = true;
+	}
+
+	SerialScope(const SerialScope&)=delete;
+	SerialScope& operator=(const SerialScope&)=delete;
+
+    //! \brief Destructor restoring the previous state of the thread
+	~SerialScope()  { serial() = m_prev; }
+
+    //! \brief Whether the calling thread is in the serial scope
+    //!
+    //! \return bool&  - the scope state of the thread
+	static bool& serial() noexcept
+	{
+		thread_local bool  serial = false;
+		return serial;
+	}
+};
+
+//! \brief The number of workers to process the specified number of items
+//! \note Small workloads are processed by a single (calling) thread to avoid
+//! the threading overhead, the nested workloads are processed serially
+//!
+//! \param items size_t  - the number of items to be processed
+//! \param minitems=64 size_t  - min number of items per worker
+//! \return unsigned  - the number of workers, >= 1
+inline unsigned workersNum(size_t items, size_t minitems=64) noexcept
+{
+	if(SerialScope::serial())
+		return 1;
+	unsigned  cpus = thread::hardware_concurrency();
+	if(!cpus)
+		cpus = 1;
+	if(!minitems)
+		minitems = 1;
+	return std::max<size_t>(std::min<size_t>(cpus, items / minitems), 1);
+}
+
+//! \brief Parallel for loop over the range [0, num) with the dynamic scheduling
+//! of the items chunks
+//! \note The calling thread is one of the workers. The first exception raised
+//! by a worker is propagated to the caller after all workers are finished.
+//!
+//! \tparam F  - functor void(size_t i, unsigned wid), where i is the item index
+//! 	and wid E [0, workers) is the index of the worker
+//!
+//! \param num size_t  - the number of items to be processed
+//! \param func F&&  - processing functor
+//! \param workers unsigned  - the number of workers, >= 1, see workersNum()
+//! \param chunk=0 size_t  - the number of items fetched by a worker at once,
+//! 	0 means automatic selection
+//! \return void
+template <typename F>
+void parallelFor(size_t num, F&& func, unsigned workers, size_t chunk=0)
+{
+	if(!num)
+		return;
+	if(workers <= 1 || num <= 1) {
+		for(size_t i = 0; i < num; ++i)
+			func(i, 0);
+		return;
+	}
+	if(!chunk)
+		// Note: small chunks balance the skewed workloads (large clusters)
+		chunk = std::max<size_t>(num / (workers * 16), 1);
+
+	atomic<size_t>  inext(0);  // Next item to be fetched
+	exception_ptr  err;  // The first raised exception
+	atomic<bool>  failed(false);
+	auto worker = [&](unsigned wid) {
+		SerialScope  scope;  // Process the nested workloads serially
+		try {
+			for(size_t ib = inext.fetch_add(chunk); ib < num && !failed
+			; ib = inext.fetch_add(chunk)) {
+				const size_t  ie = std::min(ib + chunk, num);
+				for(size_t i = ib; i < ie; ++i)
+					func(i, wid);
+			}
+		} catch(...) {
+			if(!failed.exchange(true))
+				err = std::current_exception();
+		}
+	};
+
+	std::vector<thread>  threads;
+	threads.reserve(workers - 1);
+	for(unsigned wid = 1; wid < workers; ++wid)
+		threads.emplace_back(worker, wid);
+	worker(0);
+	for(auto& th: threads)
+		th.join();
+	if(err)
+		std::rethrow_exception(err);
+}
+
+}  // daoc
+
+#endif // PARALLEL_HPP
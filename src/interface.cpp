@@ -18,8 +18,20 @@
 
 using std::overflow_error;
 using std::invalid_argument;
+using std::is_sorted;
+using std::sort;
+using std::unique;
+using std::fill;
+using std::remove_if;
+using std::max_element;
+using std::min;
+using std::max;
 using namespace daoc;
 
+#ifdef ID64
+namespace id64 {
+#endif // ID64
+
 
 // Omega Index related types and functions -------------------------------------
 Id mutualnum(const RawClusterPtrs* a, const RawClusterPtrs* b, const Id nmax) noexcept
@@ -151,15 +163,109 @@ bool xumatch(Match m) noexcept
 	return m == Match::UNWEIGHTED || m == Match::COMBINED;
 }
 
+// Note: definitions of the static constexpr members are required for their ODR-use in C++14
+constexpr char  CnbHeader::MAGIC[4];
+constexpr uint16_t  CnbHeader::VERSION;
+constexpr uint8_t  CnbHeader::CNB_DELTA;
+constexpr uint8_t  CnbHeader::CNB_UNIQUE;
+constexpr uint8_t  CnbHeader::CNB_INDEX;
+constexpr char  ClbHeader::MAGIC[4];
+constexpr uint16_t  ClbHeader::VERSION;
+
+// Members deduplication -------------------------------------------------------
+size_t SeenIds::dedup(RawIds& members, Id& idmax)
+{
+	if(members.empty()) {
+		idmax = 0;
+		return 0;
+	}
+	idmax = *max_element(members.begin(), members.end());
+	m_mbsnum += members.size();
+	const size_t  msize = members.size();
+	if(idmax >= m_stamps.size()) {
+		// Note: the stamps are bounded to be proportional to the processed members
+		const size_t  stampsmax = max<size_t>(m_mbsnum * 4, 1 << 16);
+		if(idmax >= stampsmax) {
+			// Deduplicate sparse ids by the sorting
+			sort(members.begin(), members.end());
+			members.erase(unique(members.begin(), members.end()), members.end());
+			return msize - members.size();
+		}
+		m_stamps.resize(min<size_t>(max<size_t>(size_t(idmax) + 1, m_stamps.size() * 2)
+			, stampsmax), 0);
+	}
+	// Reset the stamps on the generation overflow
+	if(!++m_gen) {
+		fill(m_stamps.begin(), m_stamps.end(), 0);
+		m_gen = 1;
+	}
+	uint32_t* const  stamps = m_stamps.data();
+	const uint32_t  gen = m_gen;
+	members.erase(remove_if(members.begin(), members.end(), [stamps, gen](Id nid) noexcept {
+		if(stamps[nid] == gen)
+			return true;
+		stamps[nid] = gen;
+		return false;
+	}), members.end());
+	return msize - members.size();
+}
+
+// Node base -------------------------------------------------------------------
+void NodeBase::assign(RawIds&& ids)
+{
+	m_ids = move(ids);
+	if(!is_sorted(m_ids.begin(), m_ids.end()))
+		sort(m_ids.begin(), m_ids.end());
+	m_ids.erase(unique(m_ids.begin(), m_ids.end()), m_ids.end());
+	m_ids.shrink_to_fit();
+	m_bits.clear();
+	m_eytz.clear();
+	if(m_ids.empty())
+		return;
+
+	// Use the bitmap if it is not larger than the Eytzinger layout
+	const size_t  words = size_t(m_ids.back()) / 64 + 1;  // The number of bitmap words
+	if(words * sizeof(uint64_t) <= (m_ids.size() + 1) * sizeof(Id)) {
+		m_bits.assign(words, 0);
+		for(auto nid: m_ids)
+			m_bits[nid / 64] |= uint64_t(1) << nid % 64;
+	} else {
+		m_eytz.resize(m_ids.size() + 1);
+		size_t  i = 0;
+		fillEytzinger(1, i);
+	}
+#if TRACE >= 2
+	fprintf(stderr, "assign(), %lu nodes are indexed by the %s using %lu bytes\n", m_ids.size()
+		, m_bits.empty() ? "Eytzinger layout" : "bitmap"
+		, m_bits.empty() ? m_eytz.size() * sizeof(Id) : m_bits.size() * sizeof(uint64_t));
+#endif // TRACE
+}
+
+void NodeBase::clear() noexcept
+{
+	m_ids = RawIds();
+	m_bits = vector<uint64_t>();
+	m_eytz = RawIds();
+}
+
+void NodeBase::fillEytzinger(size_t k, size_t& i) noexcept
+{
+	// Note: in-order traversal of the implicit binary tree yields the ordered ids
+	if(k >= m_eytz.size())
+		return;
+	fillEytzinger(2 * k, i);
+	m_eytz[k] = m_ids[i++];
+	fillEytzinger(2 * k + 1, i);
+}
+
 #ifndef NO_FILEIO
 NodeBase NodeBase::load(const char* filename, float membership
-	, ::AggHash* ahash, size_t cmin, size_t cmax, bool verbose)
+	, ::AggHash* ahash, size_t cmin, size_t cmax, bool verbose, Interner* strids)
 {
 	NodeBase  nb;  // Return using NRVO optimization
 	NamedFileWrapper  finp(filename, "r");
 	if(finp)
-		static_cast<UniqIds&>(nb) = loadNodes<Id, AccId>(finp, membership
-			, ahash, cmin, cmax, verbose);
+		nb.assign(loadNodes<Id, AccId>(finp, membership, ahash, cmin, cmax, verbose, strids));
 	else perror((string("WARNING load(), can't open ") += filename).c_str());
 
 	return nb;
@@ -203,3 +309,7 @@ AccProb amean(AccProb a, AccProb b) noexcept
 {
 	return (a + b) / 2;
 }
+
+#ifdef ID64
+}  // id64
+#endif // ID64
@@ -12,6 +12,8 @@
 #include <string>
 #include <vector>
 #include <unordered_set>
+#include <mutex>
+#include <atomic>
 // For the template definitions
 #include <cmath>  // sqrt
 #include <algorithm>  // sort
@@ -24,48 +26,123 @@ using std::move;
 using std::string;
 using std::vector;
 using std::unordered_set;
+using std::unique_ptr;
+using std::mutex;
+using std::lock_guard;
+using std::atomic;
+
+#ifdef ID64
+namespace id64 {
+#endif // ID64
 
 // Accessory routines ----------------------------------------------------------
 
-// Note: a dedicated declaration id required to define default parameters
+//! \brief Whether the raw collection has weighted clusters
+//! \note The unit weights are equivalent to the omitted ones, so such collections
+//! are evaluated as the non-weighted (multi-resolution) ones
+//!
+//! \param rcn const ClusterCollection  - raw collection of clusters
+//! \return bool  - some specified weights are distinct from 1
+static bool weightedClusters(const ClusterCollection rcn) noexcept
+{
+	if(rcn.nodes)
+		for(NodeId i = 0; i < rcn.num; ++i) {
+			const auto&  ndrels = rcn.nodes[i];
+			if(ndrels.weights)
+				for(NodeId j = 0; j < ndrels.num; ++j)
+					if(ndrels.weights[j] != 1)
+						return true;
+		}
+	return false;
+}
+
+//! \brief Remove the duplicated members with their weights retaining the first
+//! occurrences
+//!
+//! \param members RawIds&  - members of the cluster
+//! \param weights Shares&  - weights of the members
+//! \return size_t  - the number of removed duplicates
+static size_t dedupWeighted(RawIds& members, Shares& weights)
+{
+	unordered_set<Id>  seen;
+	seen.reserve(members.size());
+	size_t  num = 0;  // The number of unique members
+	for(size_t i = 0; i < members.size(); ++i)
+		if(seen.insert(members[i]).second) {
+			members[num] = members[i];
+			weights[num++] = weights[i];
+		}
+	const size_t  ndups = members.size() - num;
+	members.resize(num);
+	weights.resize(num);
+	return ndups;
+}
+
+//! \brief Append the share of the node in its last owner cluster
+//! \note The shares are held only by the overlapping (fuzzy) collections
+//!
+//! \param ncs SharedClusters<Count>&  - owner clusters of the node
+//! \param share Prob  - the (non-normalized) share
+//! \return void
+template <typename Count>
+inline void addShare(ClusterPtrs<Count>&, Prob) noexcept  {}
+
+template <typename Count>
+inline void addShare(SharedClusters<Count>& ncs, Prob share)  { ncs.shares.push_back(share); }
+
+//! \brief Normalize the shares of the node
+//!
+//! \param ncs SharedClusters<Count>&  - owner clusters of the node
+//! \return void
+template <typename Count>
+inline void normShares(ClusterPtrs<Count>&) noexcept  {}
+
+template <typename Count>
+inline void normShares(SharedClusters<Count>& ncs)  { ncs.normalize(); }
+
 //! \brief Load collection from the provided raw collection
-//! \note This is an accessory routine for C API
+//! \note This is an accessory routine for C API. The weights of the clusters
+//! are loaded only to the overlapping (fuzzy) collection as the node shares
+//! normalized to sum up to 1 for each node, the zero weights mean non-membership
 //! \pre All clusters in the collection are expected to be unique and not validated for
 //! the mutual match until makeunique is set;
 //! (reduce == (nodebase->ndsnum() < rcn.num)) || nodebase->ndsnum() == rcn.num
 //!
+//! \tparam Count  - arithmetic counting type
+//!
 //! \param rcn const ClusterCollection  - raw collection of clusters
-//! \param makeunique=false bool  - ensure that clusters contain unique members by
+//! \param makeunique bool  - ensure that clusters contain unique members by
 //! removing the duplicates
-//! \param membership=1 float  - expected membership of the nodes, >0, typically >= 1.
+//! \param membership float  - expected membership of the nodes, >0, typically >= 1.
 //! Used only for the node container preallocation to estimate the number of nodes
 //! if not specified in the file header
-//! \param ahash=nullptr AggHash*  - resulting hash of the loaded
+//! \param ahash AggHash*  - resulting hash of the loaded
 //! member ids base (unique ids only are hashed, not all ids) if not nullptr
-//! \param const nodebase=nullptr NodeBaseI*  - node base to filter-out or complement nodes if required
-//! \param reduce=false bool  - whether to reduce collections by removing the non-matching nodes
+//! \param const nodebase NodeBaseI*  - node base to filter-out or complement nodes if required
+//! \param reduce bool  - whether to reduce collections by removing the non-matching nodes
 //! or extend collections by appending those nodes them to a single "noise" cluster
-//! \param lostcls=nullptr RawIds*  - indices of the lost clusters during the node base
+//! \param lacking RawIds*  - ordered nodes of the node base lacking in the collection,
+//! which are moved to the "noise" cluster on the extension, or nullptr to probe
+//! the node base for them
+//! \param lostcls RawIds*  - indices of the lost clusters during the node base
 //! synchronization
-//! \param verbose=false bool  - print the number of loaded nodes to the stdout
-//! \return CollectionT  - the collection is loaded successfully
-Collection<Id> loadCollection(const ClusterCollection rcn, bool makeunique=false
-	, float membership=1, ::AggHash* ahash=nullptr, const NodeBaseI* nodebase=nullptr
-	, bool reduce=false, RawIds* lostcls=nullptr, bool verbose=false);
-
-Collection<Id> loadCollection(const ClusterCollection rcn, bool makeunique, float membership
-	, ::AggHash* ahash, const NodeBaseI* nodebase, bool reduce, RawIds* lostcls, bool verbose)
+//! \param verbose bool  - print the number of loaded nodes to the stdout
+//! \return Collection<Count>  - the collection is loaded successfully
+template <typename Count>
+Collection<Count> loadClusters(const ClusterCollection rcn, bool makeunique, float membership
+	, ::AggHash* ahash, const NodeBaseI* nodebase, bool reduce, RawIds* lacking
+	, RawIds* lostcls, bool verbose)
 {
-	Collection<Id>  cn;  // Return using NRVO, named return value optimization
+	Collection<Count>  cn;  // Return using NRVO, named return value optimization
 
 #ifdef DEBUG
 	// Note: asserts break libraries (=> may crash a webservice), and, hence, should be avoided in the release mode
-	assert(((reduce == (nodebase->ndsnum() < rcn.num)) || nodebase->ndsnum() == rcn.num)
+	assert((!nodebase || (reduce == (nodebase->ndsnum() < rcn.num)) || nodebase->ndsnum() == rcn.num)
 		&& "Nodebase is not synced with the reduce argument");
 #else
-	if(!((reduce == (nodebase->ndsnum() < rcn.num)) || nodebase->ndsnum() == rcn.num)) {
-		fprintf(stderr, "ERROR: loadCollection(). Nodebase is not synced with the reduce argument (reduce: %u, nodebase: %u, rcn: %u)\n"
-			, reduce, nodebase->ndsnum(), rcn.num);
+	if(nodebase && !((reduce == (nodebase->ndsnum() < rcn.num)) || nodebase->ndsnum() == rcn.num)) {
+		fprintf(stderr, "ERROR: loadCollection(). Nodebase is not synced with the reduce argument (reduce: %u, nodebase: %lu, rcn: %lu)\n"
+			, reduce, size_t(nodebase->ndsnum()), size_t(rcn.num));
 		return cn;
 	}
 #endif // DEBUG
@@ -76,7 +153,10 @@ Collection<Id> loadCollection(const ClusterCollection rcn, bool makeunique, floa
 	}
 
 	// Preallocate space for the clusters and nodes
-	size_t  nsnum = rcn.num * 2;  // The (estimated) number of nodes
+	size_t  nsnum = 0;  // The (estimated) number of nodes
+	for(NodeId i = 0; i < rcn.num; ++i)
+		nsnum += rcn.nodes[i].num;
+	nsnum /= membership > 0 ? membership : 1;
 	if(cn.m_cls.capacity() < rcn.num)  //  * cn.m_cls.max_load_factor()
 		cn.m_cls.reserve(rcn.num);
 	if(cn.m_ndcs.bucket_count() * cn.m_ndcs.max_load_factor() < nsnum)
@@ -91,19 +171,25 @@ Collection<Id> loadCollection(const ClusterCollection rcn, bool makeunique, floa
 #endif // TRACE
 
 	// Parse clusters
-	ClusterHolder<Id>  chd(new Cluster<Id>());
+	// Note: the weights are omitted for the multi-resolution (crisp) collection
+	const bool  weighted = is_floating_point<Count>::value && weightedClusters(rcn);
+	Shares  weights;  // Weights of the members of the loading cluster
+	size_t  wrongws = 0;  // The number of omitted members having invalid weights
+	ClusterHolder<Count>  chd(new Cluster<Count>());
 	for(NodeId i = 0; i < rcn.num; ++i) {
-		Cluster<Id>* const  pcl = chd.get();
+		Cluster<Count>* const  pcl = chd.get();
 		auto& members = pcl->members;
 		const auto& ndrels = rcn.nodes[i];
 		members.reserve(ndrels.num);
+		if(weighted)
+			weights.reserve(ndrels.num);
 		for(NodeId j = 0; j < ndrels.num; ++j) {
 #ifdef DEBUG
 			assert(ndrels.ids && "Invalid (non-allocated) node relations");
 #else
 			if(!ndrels.ids) {
 				fputs("ERROR: loadCollection(). Invalid (non-allocated) node relations\n", stderr);
-				cn = Collection<Id>();
+				cn = Collection<Count>();
 				return cn;
 			}
 #endif // DEBUG
@@ -111,56 +197,79 @@ Collection<Id> loadCollection(const ClusterCollection rcn, bool makeunique, floa
 			// Filter out nodes if required
 			if(nodebase && reduce && !nodebase->nodeExists(did))
 				continue;
+			if(weighted) {
+				const Prob  weight = ndrels.weights ? ndrels.weights[j] : 1;
+				// Note: the zero weight means non-membership
+				if(!(weight > 0) || !std::isfinite(weight)) {
+					wrongws += weight < 0 || !std::isfinite(weight);
+					continue;
+				}
+				weights.push_back(weight);
+			}
 			members.push_back(did);
-			auto& ncs = cn.m_ndcs[did];
-			ncs.push_back(pcl);
 		}
 		if(!members.empty()) {
-			members.shrink_to_fit();  // Free over reserved space
 			if(makeunique) {
 				// Ensure or validate that members are unique
-				std::sort(members.begin(), members.end());
-				const auto im = unique(members.begin(), members.end());
-				//const auto im = adjacent_find(members.begin(), members.end());
-				if(im != members.end()) {
+				Id  idmax;
+				const size_t  ndups = weighted ? dedupWeighted(members, weights)
+					: SeenIds::local().dedup(members, idmax);
+				if(ndups)
 					fprintf(stderr, "WARNING loadCollection(), #%lu cluster contained %lu duplicated members, corrected.\n"
-						, cn.m_cls.size(), distance(im, members.end()));
-					// Remove associated clusters
-					for(auto jm = im; jm != members.end(); ++jm)
-						cn.m_ndcs[*jm].pop_back();
-					// Remove the tail of duplicated node ids
-					members.erase(im, members.end());
-					//fprintf(stderr, "WARNING loadCollection(), #%lu cluster contains duplicated member #%lu: %u\n"
-					//	, cn.m_cls.size(), distance(members.begin(), im), *im);
-					//throw invalid_argument("loadCollection(), the cluster contains duplicated members\n");
-				}
+						, cn.m_cls.size(), ndups);
 			}
 			members.shrink_to_fit();  // Free over reserved space
+			// Note: the node memberships are recorded after the deduplication
+			for(size_t j = 0; j < members.size(); ++j) {
+				auto&  ncs = cn.m_ndcs[members[j]];
+				ncs.push_back(pcl);
+				if(weighted)
+					addShare(ncs, weights[j]);
+			}
 			//for(auto v: members)
 			//	printf(" %u", v);
 			//puts("");
+			pcl->index = cn.m_cls.size();
 			cn.m_cls.push_back(chd.release());
 			// Start filling a new cluster
-			chd.reset(new Cluster<Id>());
+			chd.reset(new Cluster<Count>());
 		} else if(lostcls)
 			lostcls->push_back(lostcls->size() + cn.m_cls.size());
+		weights.clear();
 	}
+	if(wrongws)
+		fprintf(stderr, "WARNING loadCollection(), %lu members having negative or non-finite"
+			" weights are omitted\n", wrongws);
+	// Normalize the node shares, the complementary nodes have a single owner
+	if(weighted)
+		for(auto& ncs: cn.m_ndcs)
+			normShares(ncs.second);
 
 	// Extend collection with a single "noise" cluster containing missed nodes if required
 	if(nodebase && !reduce && cn.m_ndcs.size() < nodebase->ndsnum()) {
-		// Fetch complementary nodes
+		// Fetch complementary nodes unless they are merged from the node ids
 		RawIds nids;
-		nids.reserve(nodebase->ndsnum() - cn.m_ndcs.size());
-		for(auto nid: nodebase->nodes())
-			if(!cn.m_ndcs.count(nid))
-				nids.push_back(nid);
+		if(lacking)
+			nids = move(*lacking);
+		else {
+			nids.reserve(nodebase->ndsnum() - cn.m_ndcs.size());
+			for(auto nid: nodebase->nodes())
+				if(!cn.m_ndcs.count(nid))
+					nids.push_back(nid);
+		}
+#if VALIDATE >= 2
+		assert(nids.size() == nodebase->ndsnum() - cn.m_ndcs.size()
+			&& "Lacking nodes are not synced with the node base");
+#endif // VALIDATE
 		// Add complementary nodes to the
-		Cluster<Id>* const  pcl = chd.get();
+		Cluster<Count>* const  pcl = chd.get();
 		pcl->members.insert(pcl->members.end(), nids.begin(), nids.end());
 		for(auto nid: nids)
 			cn.m_ndcs[nid].push_back(pcl);
+		pcl->index = cn.m_cls.size();
 		cn.m_cls.push_back(chd.release());
 	}
+	cn.indexShares();
 
 	// Save some space if it is essential
 	if(cn.m_cls.size() < cn.m_cls.capacity() / 2)
@@ -191,66 +300,218 @@ Collection<Id> loadCollection(const ClusterCollection rcn, bool makeunique, floa
 		, cn.m_ndshash, rcn.num);
 #elif TRACE >= 1
 	if(verbose)
-		printf("loadCollection(), loaded %lu clusters %lu nodes from %u raw node relations\n", cn.m_cls.size()
-			, cn.m_ndcs.size(), rcn.num);
+		printf("loadCollection(), loaded %lu clusters %lu nodes from %lu raw node relations\n", cn.m_cls.size()
+			, cn.m_ndcs.size(), size_t(rcn.num));
 #endif
 
 	return cn;
 }
 
+// Note: a dedicated declaration id required to define default parameters
+//! \brief Load the multi-resolution collection from the provided raw collection,
+//! see loadClusters()
+//!
+//! \param rcn const ClusterCollection  - raw collection of clusters
+//! \param makeunique=false bool  - ensure that clusters contain unique members by
+//! removing the duplicates
+//! \param membership=1 float  - expected membership of the nodes
+//! \param ahash=nullptr AggHash*  - resulting hash of the loaded member ids base
+//! \param const nodebase=nullptr NodeBaseI*  - node base to filter-out or complement nodes if required
+//! \param reduce=false bool  - whether to reduce or extend collections
+//! \param lacking=nullptr RawIds*  - ordered nodes of the node base lacking in the collection
+//! \param lostcls=nullptr RawIds*  - indices of the lost clusters during the node base
+//! synchronization
+//! \param verbose=false bool  - print the number of loaded nodes to the stdout
+//! \return Collection<Id>  - the collection is loaded successfully
+Collection<Id> loadCollection(const ClusterCollection rcn, bool makeunique=false
+	, float membership=1, ::AggHash* ahash=nullptr, const NodeBaseI* nodebase=nullptr
+	, bool reduce=false, RawIds* lacking=nullptr, RawIds* lostcls=nullptr, bool verbose=false);
+
+Collection<Id> loadCollection(const ClusterCollection rcn, bool makeunique, float membership
+	, ::AggHash* ahash, const NodeBaseI* nodebase, bool reduce, RawIds* lacking, RawIds* lostcls
+	, bool verbose)
+{
+	return loadClusters<Id>(rcn, makeunique, membership, ahash, nodebase, reduce, lacking
+		, lostcls, verbose);
+}
+
 /// \brief Fetch nodes from the raw collection of clusters
 ///
 /// \param cn const ClusterCollection  - raw collection of clusters
-/// \return UniqIds  - cluster nodes
-UniqIds fetchNodes(const ClusterCollection cn)
+/// \return RawIds  - ordered unique cluster nodes
+RawIds fetchNodes(const ClusterCollection cn)
 {
-	UniqIds nodes;  // Uses NRVO return value optimization
-	nodes.reserve(cn.num * 2);
+	RawIds nodes;  // Uses NRVO return value optimization
 
 	if(cn.nodes) {
+		size_t  mbsnum = 0;  // The number of members
+		for(NodeId i = 0; i < cn.num; ++i)
+			if(cn.nodes[i].ids)
+				mbsnum += cn.nodes[i].num;
+		nodes.reserve(mbsnum);
 		for(NodeId i = 0; i < cn.num; ++i) {
 			const auto& ndrs = cn.nodes[i];
 			if(!ndrs.ids) {
-				fprintf(stderr, "WARNING %s(), the empty node ids (nominally: %u ids) is omitted\n", __FUNCTION__, ndrs.num);
+				fprintf(stderr, "WARNING %s(), the empty node ids (nominally: %lu ids) is omitted\n", __FUNCTION__, size_t(ndrs.num));
 				continue;
 			}
-			for(NodeId j = 0; j < ndrs.num; ++j)
-				nodes.insert(nodes.end(), ndrs.ids[j]);
+			nodes.insert(nodes.end(), ndrs.ids, ndrs.ids + ndrs.num);
 		}
-	} else fprintf(stderr, "WARNING %s(), the empty input collection (nominally: %u nodes) is omitted\n", __FUNCTION__, cn.num);
+		sort(nodes.begin(), nodes.end());
+		nodes.erase(unique(nodes.begin(), nodes.end()), nodes.end());
+	} else fprintf(stderr, "WARNING %s(), the empty input collection (nominally: %lu nodes) is omitted\n", __FUNCTION__, size_t(cn.num));
 
 	return nodes;
 }
 
+/// \brief Merge the ordered unique nodes of two collections in a single pass
+///
+/// \param nds1 const RawIds&  - ordered unique nodes of the first collection
+/// \param nds2 const RawIds&  - ordered unique nodes of the second collection
+/// \param lacking1 RawIds*  - resulting ordered nodes of the second collection
+/// lacking in the first one if not nullptr
+/// \param lacking2 RawIds*  - resulting ordered nodes of the first collection
+/// lacking in the second one if not nullptr
+/// \param nodes=nullptr RawIds*  - resulting ordered nodes of the node base if not nullptr
+/// \param reduced=false bool  - whether the node base is the intersection or the union
+/// \return void
+void mergeNodes(const RawIds& nds1, const RawIds& nds2, RawIds* lacking1, RawIds* lacking2
+	, RawIds* nodes=nullptr, bool reduced=false)
+{
+	auto  in1 = nds1.begin();
+	auto  in2 = nds2.begin();
+	while(in1 != nds1.end() && in2 != nds2.end()) {
+		if(*in1 < *in2) {
+			if(lacking2)
+				lacking2->push_back(*in1);
+			if(nodes && !reduced)
+				nodes->push_back(*in1);
+			++in1;
+		} else if(*in2 < *in1) {
+			if(lacking1)
+				lacking1->push_back(*in2);
+			if(nodes && !reduced)
+				nodes->push_back(*in2);
+			++in2;
+		} else {
+			if(nodes)
+				nodes->push_back(*in1);
+			++in1;
+			++in2;
+		}
+	}
+	// Note: at most one of the tails is non-empty
+	if(lacking2)
+		lacking2->insert(lacking2->end(), in1, nds1.end());
+	if(lacking1)
+		lacking1->insert(lacking1->end(), in2, nds2.end());
+	if(nodes && !reduced) {
+		nodes->insert(nodes->end(), in1, nds1.end());
+		nodes->insert(nodes->end(), in2, nds2.end());
+	}
+}
+
 /// \brief Fetch nodebase from collection of clusters, reduced (intersection) or extended (union) one
 ///
 /// \param cn1 ClusterCollection const  - first raw collection of clusters
 /// \param cn2 ClusterCollection const  - second raw collection of clusters
 /// \param reduced=false bool  - whether reduce or extend tham
+/// \param lacking1=nullptr RawIds*  - resulting ordered nodes of the extended node base
+/// lacking in the first collection if not nullptr
+/// \param lacking2=nullptr RawIds*  - resulting ordered nodes of the extended node base
+/// lacking in the second collection if not nullptr
 /// \return NodeBase  - resulting nodebase
-NodeBase fetchNodebase(const ClusterCollection cn1, const ClusterCollection cn2, bool reduced=false)
-{
-	NodeBase nodes;  // Uses NRVO return value optimization
-	if(reduced) {
-		UniqIds  nds1 = fetchNodes(cn1);
-		UniqIds  nds2 = fetchNodes(cn2);
-		nodes.reserve(abs(static_cast<long>(nds1.size()) - static_cast<long>(nds2.size())));
-		for(auto nid: nds1)
-			if(!nds2.count(nid))
-				nodes.insert(nodes.end(), nid);
-		for(auto nid: nds2)
-			if(!nds1.count(nid))
-				nodes.insert(nodes.end(), nid);
+NodeBase fetchNodebase(const ClusterCollection cn1, const ClusterCollection cn2, bool reduced=false
+	, RawIds* lacking1=nullptr, RawIds* lacking2=nullptr)
+{
+	const RawIds  nds1 = fetchNodes(cn1);
+	const RawIds  nds2 = fetchNodes(cn2);
+	RawIds  nodes;  // Ordered node ids of the node base
+	nodes.reserve(reduced ? min(nds1.size(), nds2.size()) : max(nds1.size(), nds2.size()));
+	mergeNodes(nds1, nds2, lacking1, lacking2, &nodes, reduced);
 #if VALIDATE >= 2
-		assert((nodes.ndsnum() <= min(nds1.size(), nds2.size())) && "Unexpected size of resulting nodes");
+	assert((!reduced || nodes.size() <= min(nds1.size(), nds2.size())) && "Unexpected size of resulting nodes");
 #endif // VALIDATE
-	} else for(const auto& cn: {cn1, cn2}) {
-		const auto partnds = fetchNodes(cn);
-		nodes.insert(partnds.begin(), partnds.end());
-	}
-	return nodes;
+	// Note: the ordered unique ids are not reordered by the node base
+	return NodeBase(move(nodes));
+}
+
+//! \brief Hash of the node ids
+//!
+//! \param nodes const RawIds&  - unique node ids
+//! \return ::AggHash  - aggregated hash of the nodes
+::AggHash nodesHash(const RawIds& nodes)
+{
+	::AggHash  ndhash;  // Uses NRVO return value optimization
+	for(auto nid: nodes)
+		ndhash.add(nid);
+	return ndhash;
 }
 
+//! \brief Complement of the collection with the nodes of the node base lacking
+//! in the collection, which form a single "noise" cluster removed on the destruction
+//! \note The complemented collection corresponds to the one loaded by
+//! loadCollection() with the extended (not reduced) node base
+//! \tparam Count  - arithmetic counting type
+template <typename Count>
+class CollectionComplement {
+	Collection<Count>&  m_cn;  //!< Complemented collection
+	Cluster<Count>*  m_pcl;  //!< Complementary cluster if any
+	size_t  m_ndshash;  //!< Original nodes hash of the collection
+public:
+    //! \brief Constructor
+    //!
+    //! \param cn Collection<Count>&  - the collection to be complemented
+    //! \param nids RawIds&&  - ordered nodes of the node base lacking in the collection
+    //! \param ndhash const ::AggHash&  - aggregated hash of the collection nodes
+	CollectionComplement(Collection<Count>& cn, RawIds&& nids, const ::AggHash& ndhash)
+	: m_cn(cn), m_pcl(nullptr), m_ndshash(cn.m_ndshash)
+	{
+		if(nids.empty())
+			return;
+		// Note: the ordering makes the complementary cluster deterministic
+		m_pcl = new Cluster<Count>();
+		m_pcl->members = move(nids);
+		// Note: the complementary nodes have a single owner
+		if(Collection<Count>::m_overlaps)
+			m_pcl->shares.assign(m_pcl->members.size(), 1);
+		::AggHash  mbhash = ndhash;
+		for(auto nid: m_pcl->members) {
+			cn.m_ndcs[nid].push_back(m_pcl);
+			mbhash.add(nid);
+		}
+		m_pcl->index = cn.m_cls.size();
+		cn.m_cls.push_back(m_pcl);
+		cn.m_ndshash = mbhash.hash();
+	}
+
+    //! \brief Copy constructor, the complementary cluster has a single owner
+	CollectionComplement(const CollectionComplement&)=delete;
+
+    //! \brief Copy assignment, the complementary cluster has a single owner
+	CollectionComplement& operator=(const CollectionComplement&)=delete;
+
+    //! \brief Destructor, removes the complementary cluster
+	~CollectionComplement()
+	{
+		if(!m_pcl)
+			return;
+		// Note: the complementary nodes belong only to the complementary cluster
+		for(auto nid: m_pcl->members)
+			m_cn.m_ndcs.erase(nid);
+		m_cn.m_cls.pop_back();
+		delete m_pcl;
+		m_cn.m_ndshash = m_ndshash;
+	}
+};
+
+#ifdef ID64
+}  // id64
+
+// Note: the C API functions are defined in the global namespace to retain their C linkage
+using namespace id64;
+#endif // ID64
+
 // Interface implementation ----------------------------------------------------
 Probability f1p(const ClusterCollection cn1, const ClusterCollection cn2)
 {
@@ -278,13 +539,23 @@ Probability f1x(const ClusterCollection cn1, const ClusterCollection cn2, F1Kind
 			, cn1.num, cn2.num);
 #endif // TRACE
 	assert(rec && prc && "Invalid output arguments");
+	// Note: the weighted collections are evaluated as the overlapping (fuzzy) ones
+	if(weightedClusters(cn1) || weightedClusters(cn2)) {
+		const unique_ptr<XmsCollection, decltype(&xms_collection_free)>  hcn1(
+			xms_collection_create(cn1, makeunique), xms_collection_free);
+		const unique_ptr<XmsCollection, decltype(&xms_collection_free)>  hcn2(
+			xms_collection_create(cn2, makeunique), xms_collection_free);
+		return xms_f1(hcn1.get(), hcn2.get(), kind, rec, prc, mkind, sync, verbose);
+	}
 	// Load nodes
 	const bool reduce = false;  // Whether to reduce or extend collections of clusters
 	Probability res = 0;
 	if(sync) {
-		NodeBase ndbase = fetchNodebase(cn1, cn2, reduce);
-		Collection<Id>  c1 = loadCollection(cn1, makeunique, 1, nullptr, &ndbase, reduce);
-		Collection<Id>  c2 = loadCollection(cn2, makeunique, 1, nullptr, &ndbase, reduce);
+		RawIds  lacking1;  // Nodes of the node base lacking in the first collection
+		RawIds  lacking2;  // Nodes of the node base lacking in the second collection
+		NodeBase ndbase = fetchNodebase(cn1, cn2, reduce, &lacking1, &lacking2);
+		Collection<Id>  c1 = loadCollection(cn1, makeunique, 1, nullptr, &ndbase, reduce, &lacking1);
+		Collection<Id>  c2 = loadCollection(cn2, makeunique, 1, nullptr, &ndbase, reduce, &lacking2);
 		res = Collection<Id>::f1(c1, c2, static_cast<F1>(kind), *rec, *prc, static_cast<Match>(mkind), verbose);
 	} else {
 		Collection<Id>  c1 = loadCollection(cn1);
@@ -312,11 +583,21 @@ Probability omegax(const ClusterCollection cn1, const ClusterCollection cn2, uin
 	RawClusters  cls2;
 	NodeRClusters  ndrcs;
 
+	// Note: the weighted collections are evaluated as the overlapping (fuzzy) ones
+	if(weightedClusters(cn1) || weightedClusters(cn2)) {
+		const unique_ptr<XmsCollection, decltype(&xms_collection_free)>  hcn1(
+			xms_collection_create(cn1, makeunique), xms_collection_free);
+		const unique_ptr<XmsCollection, decltype(&xms_collection_free)>  hcn2(
+			xms_collection_create(cn2, makeunique), xms_collection_free);
+		return xms_omega(hcn1.get(), hcn2.get(), ext, sync);
+	}
 	const bool reduce = false;  // Whether to reduce or expand collections of clusters
 	if(sync) {
-		NodeBase ndbase = fetchNodebase(cn1, cn2, reduce);
-		Collection<Id>  c1 = loadCollection(cn1, makeunique, 1, nullptr, &ndbase, reduce);
-		Collection<Id>  c2 = loadCollection(cn2, makeunique, 1, nullptr, &ndbase, reduce);
+		RawIds  lacking1;  // Nodes of the node base lacking in the first collection
+		RawIds  lacking2;  // Nodes of the node base lacking in the second collection
+		NodeBase ndbase = fetchNodebase(cn1, cn2, reduce, &lacking1, &lacking2);
+		Collection<Id>  c1 = loadCollection(cn1, makeunique, 1, nullptr, &ndbase, reduce, &lacking1);
+		Collection<Id>  c2 = loadCollection(cn2, makeunique, 1, nullptr, &ndbase, reduce, &lacking2);
 		c1.template transfer<true>(cls1, ndrcs);
 		c2.template transfer<false>(cls2, ndrcs);
 	} else {
@@ -328,3 +609,614 @@ Probability omegax(const ClusterCollection cn1, const ClusterCollection cn2, uin
 	return ext ? omega<true>(ndrcs, cls1, cls2)
 		: omega<false>(ndrcs, cls1, cls2);
 }
+
+// Collection handles ----------------------------------------------------------
+//! Instances of the handle collection
+//! \note The origin collection is evaluated when it is idle, otherwise its
+//! replica is evaluated. The replicas are cloned from the origin on demand,
+//! which reads only the members and memberships of the clusters, so the
+//! structural modifications of the origin (the node base synchronization)
+//! are performed under the guard of the handle.
+//! \tparam Count  - arithmetic counting type
+template <typename Count>
+struct HandleInstances {
+	Collection<Count>  cn;  //!< Indexed collection, the origin of the replicas
+	vector<unique_ptr<Collection<Count>>>  replicas;  //!< Replicas of the collection for the concurrent evaluations
+	vector<Collection<Count>*>  idle;  //!< Idle (non-evaluated) instances of the collection
+
+    //! \brief Constructor
+    //!
+    //! \param cn Collection<Count>&&  - the indexed collection
+	explicit HandleInstances(Collection<Count>&& cn)
+	: cn(move(cn)), replicas(), idle{&this->cn}  {}
+};
+
+//! Indexed collection of the handle
+//! \note The weighted collection has only the overlapping (fuzzy) instances.
+//! The non-weighted collection has the multi-resolution (crisp) instances and
+//! the fuzzy ones converted on demand for the evaluation against the weighted
+//! collections.
+struct XmsCollection {
+	const Id  clsnum;  //!< The number of clusters in the collection
+	const RawIds  nodes;  //!< Ordered node ids of the collection for the node base synchronization
+	const ::AggHash  ndhash;  //!< Aggregated hash of the nodes
+	unique_ptr<HandleInstances<Id>>  crisp;  //!< Instances of the non-weighted collection
+	unique_ptr<HandleInstances<AccProb>>  fuzzy;  //!< Overlapping instances of the collection
+	mutex  guard;  //!< Guard of the instances and the origins structure
+
+    //! \brief Constructor of the non-weighted collection
+    //!
+    //! \param cn Collection<Id>&&  - the indexed collection
+	explicit XmsCollection(Collection<Id>&& cn)
+	: clsnum(cn.clsnum()), nodes(cn.sortedNodes()), ndhash(nodesHash(nodes))
+	, crisp(new HandleInstances<Id>(move(cn))), fuzzy(), guard()  {}
+
+    //! \brief Constructor of the weighted collection
+    //!
+    //! \param cn Collection<AccProb>&&  - the indexed collection
+	explicit XmsCollection(Collection<AccProb>&& cn)
+	: clsnum(cn.clsnum()), nodes(cn.sortedNodes()), ndhash(nodesHash(nodes))
+	, crisp(), fuzzy(new HandleInstances<AccProb>(move(cn))), guard()  {}
+
+    //! \brief Instances of the collection
+    //! \pre The guard is locked
+    //!
+    //! \tparam Count  - arithmetic counting type
+    //! \return HandleInstances<Count>&  - the instances
+	template <typename Count>
+	HandleInstances<Count>& instances();
+};
+
+template <>
+HandleInstances<Id>& XmsCollection::instances<Id>()
+{
+	return *crisp;
+}
+
+template <>
+HandleInstances<AccProb>& XmsCollection::instances<AccProb>()
+{
+	// Note: the complementary cluster of the evaluating crisp origin is omitted
+	if(!fuzzy)
+		fuzzy.reset(new HandleInstances<AccProb>(crisp->cn.template clone<AccProb>(clsnum)));
+	return *fuzzy;
+}
+
+//! \brief Exclusive lease of an instance of the handle collection for the evaluation
+//! \tparam Count  - arithmetic counting type
+template <typename Count>
+class CollectionLease {
+	XmsCollection&  m_hcn;  //!< Handle of the collection
+	HandleInstances<Count>*  m_ins;  //!< Instances of the collection
+	Collection<Count>*  m_cn;  //!< Leased instance of the collection
+public:
+    //! \brief Constructor, leases an idle instance or clones the origin
+    //!
+    //! \param hcn XmsCollection&  - handle of the collection
+	explicit CollectionLease(XmsCollection& hcn): m_hcn(hcn), m_ins(nullptr), m_cn(nullptr)
+	{
+		lock_guard<mutex>  lock(hcn.guard);
+		m_ins = &hcn.template instances<Count>();
+		auto&  ins = *m_ins;
+		if(!ins.idle.empty()) {
+			m_cn = ins.idle.back();
+			ins.idle.pop_back();
+			return;
+		}
+		// Note: the origin can be synchronized by another evaluation, so its
+		// complementary cluster is omitted
+		unique_ptr<Collection<Count>>  replica(new Collection<Count>(ins.cn.clone(hcn.clsnum)));
+		// Note: the idle instances can not exceed the replicas, so the
+		// returning of the lease does not reallocate them
+		ins.idle.reserve(ins.replicas.size() + 2);
+		ins.replicas.push_back(move(replica));
+		m_cn = ins.replicas.back().get();
+	}
+
+    //! \brief Copy constructor, the lease is exclusive
+	CollectionLease(const CollectionLease&)=delete;
+
+    //! \brief Copy assignment, the lease is exclusive
+	CollectionLease& operator=(const CollectionLease&)=delete;
+
+    //! \brief Destructor, returns the instance to the idle ones
+	~CollectionLease()
+	{
+		lock_guard<mutex>  lock(m_hcn.guard);
+		m_ins->idle.push_back(m_cn);
+	}
+
+    //! \brief The leased collection
+    //!
+    //! \return Collection<Count>&  - the collection
+	Collection<Count>& operator*() const noexcept  { return *m_cn; }
+
+    //! \brief Handle of the leased collection
+    //!
+    //! \return XmsCollection&  - the handle
+	XmsCollection& handle() const noexcept  { return m_hcn; }
+};
+
+//! \brief Operands of the evaluation of the collection handles
+//! \note The handle instances are leased exclusively, so the evaluation is
+//! reentrant. The evaluation state is cleared and the node bases are
+//! synchronized if required.
+//! \tparam Count  - arithmetic counting type
+template <typename Count>
+class HandlesEval {
+	CollectionLease<Count>  m_cn1;  //!< First collection
+	CollectionLease<Count>  m_cn2;  //!< Second collection
+	unique_ptr<CollectionComplement<Count>>  m_cmp1;  //!< Complement of the first collection
+	unique_ptr<CollectionComplement<Count>>  m_cmp2;  //!< Complement of the second collection
+public:
+	using CollectionT = Collection<Count>;
+
+    //! \brief Constructor
+    //! \pre The handles are valid
+    //!
+    //! \param hcn1 XmsCollectionHandle  - first collection
+    //! \param hcn2 XmsCollectionHandle  - second collection
+    //! \param sync bool  - synchronize node base of the collections
+	HandlesEval(XmsCollectionHandle hcn1, XmsCollectionHandle hcn2, bool sync)
+	: m_cn1(*hcn1), m_cn2(*hcn2), m_cmp1(), m_cmp2()
+	{
+		(*m_cn1).clearstate();
+		(*m_cn2).clearstate();
+		if(!sync)
+			return;
+		// Note: the lacking nodes are merged from the ordered nodes of the
+		// handles, which are not modified by the synchronization
+		RawIds  lacking1;  // Nodes of the second collection lacking in the first one
+		RawIds  lacking2;  // Nodes of the first collection lacking in the second one
+		mergeNodes(hcn1->nodes, hcn2->nodes, &lacking1, &lacking2);
+		{
+			lock_guard<mutex>  lock(hcn1->guard);
+			m_cmp1.reset(new CollectionComplement<Count>(*m_cn1, move(lacking1), hcn1->ndhash));
+		}
+		lock_guard<mutex>  lock(hcn2->guard);
+		m_cmp2.reset(new CollectionComplement<Count>(*m_cn2, move(lacking2), hcn2->ndhash));
+	}
+
+    //! \brief Copy constructor, the operands are leased exclusively
+	HandlesEval(const HandlesEval&)=delete;
+
+    //! \brief Copy assignment, the operands are leased exclusively
+	HandlesEval& operator=(const HandlesEval&)=delete;
+
+    //! \brief Destructor, removes the complements under the guards
+	~HandlesEval()
+	{
+		if(m_cmp2) {
+			lock_guard<mutex>  lock(m_cn2.handle().guard);
+			m_cmp2.reset();
+		}
+		if(m_cmp1) {
+			lock_guard<mutex>  lock(m_cn1.handle().guard);
+			m_cmp1.reset();
+		}
+	}
+
+    //! \brief First collection
+    //!
+    //! \return CollectionT&  - the collection
+	CollectionT& cn1() const noexcept  { return *m_cn1; }
+
+    //! \brief Second collection
+    //!
+    //! \return CollectionT&  - the collection
+	CollectionT& cn2() const noexcept  { return *m_cn2; }
+};
+
+//! \brief Validate the collection handles
+//!
+//! \param hcn1 XmsCollectionHandle  - first collection
+//! \param hcn2 XmsCollectionHandle  - second collection
+//! \param func const char*  - name of the calling function
+//! \return bool  - the handles are valid
+static bool validHandles(XmsCollectionHandle hcn1, XmsCollectionHandle hcn2, const char* func)
+{
+	if(hcn1 && hcn2)
+		return true;
+	fprintf(stderr, "ERROR %s(), invalid collection handles\n", func);
+	return false;
+}
+
+//! \brief Evaluate the collection handles
+//! \note The collections are evaluated as the overlapping (fuzzy) ones if any
+//! of them is weighted, otherwise as the multi-resolution (crisp) ones
+//! \pre The handles are valid
+//!
+//! \tparam F  - evaluating functor R(const HandlesEval<Count>&) accepting both
+//! 	counting types
+//!
+//! \param hcn1 XmsCollectionHandle  - first collection
+//! \param hcn2 XmsCollectionHandle  - second collection
+//! \param sync bool  - synchronize node base of the collections
+//! \param feval F&&  - evaluating functor
+//! \return R  - the evaluation result
+template <typename F>
+static auto evalHandles(XmsCollectionHandle hcn1, XmsCollectionHandle hcn2, bool sync, F&& feval)
+{
+	if(hcn1->crisp && hcn2->crisp)
+		return feval(HandlesEval<Id>(hcn1, hcn2, sync));
+	return feval(HandlesEval<AccProb>(hcn1, hcn2, sync));
+}
+
+//! \brief F1 evaluation of the operands
+//!
+//! \param ops const HandlesEval<Count>&  - evaluating collections
+//! \param kind F1  - kind of F1 to be evaluated
+//! \param[out] rec Probability&  - recall of cn2 relative to the ground-truth cn1
+//! \param[out] prc Probability&  - precision of cn2 relative to the ground-truth cn1
+//! \param mkind Match  - matching kind
+//! \param verbose bool  - print intermediate results to the stdout
+//! \return Probability  - resulting F1
+template <typename Count>
+static Probability evalF1(const HandlesEval<Count>& ops, F1 kind, Probability& rec
+	, Probability& prc, Match mkind, bool verbose=false)
+{
+	return Collection<Count>::f1(ops.cn1(), ops.cn2(), kind, rec, prc, mkind, verbose);
+}
+
+//! \brief NMI evaluation of the operands
+//!
+//! \param ops const HandlesEval<Count>&  - evaluating collections
+//! \param expbase bool  - use ln (exp base) or log2 for the information measuring
+//! \param[out] nmis NmiValues*  - NMI for all normalizations, can be NULL
+//! \return Probability  - NMI_max
+template <typename Count>
+static Probability evalNmi(const HandlesEval<Count>& ops, bool expbase, NmiValues* nmis)
+{
+	const auto  rnmi = Collection<Count>::nmi(ops.cn1(), ops.cn2(), expbase);
+	// Note: NMI of the collections without any mutual information says nothing
+	// about their similarity, see evalMeasures() of the CLI
+	if(rnmi.mi <= precision_limit<decltype(rnmi.mi)>())
+		throw domain_error("NMI is not applicable to the specified collections: 0, which says nothing about the similarity");
+	const Probability  nmix = rnmi.mi / std::max(rnmi.h1, rnmi.h2);
+	if(nmis) {
+		nmis->max = nmix;
+		nmis->sqrt = rnmi.mi / sqrt(rnmi.h1 * rnmi.h2);
+		nmis->avg = 2 * rnmi.mi / (rnmi.h1 + rnmi.h2);
+		nmis->min = rnmi.mi / std::min(rnmi.h1, rnmi.h2);
+	}
+	return nmix;
+}
+
+//! \brief Overlapping NMI evaluation of the operands
+//!
+//! \param ops const HandlesEval<Count>&  - evaluating collections
+//! \param[out] lfk Probability*  - ONMI normalized as LFK, can be NULL
+//! \return Probability  - ONMI_max
+template <typename Count>
+static Probability evalOnmi(const HandlesEval<Count>& ops, Probability* lfk)
+{
+	const auto  ronmi = Collection<Count>::onmi(ops.cn1(), ops.cn2());
+	if(lfk)
+		*lfk = ronmi.lfk;
+	return ronmi.nmax();
+}
+
+//! \brief Labeling of the operands, see xms_label()
+//! \note The complementary clusters of the synchronization are omitted
+//! in the resulting labels
+//!
+//! \param ops const HandlesEval<Count>&  - evaluating collections: the ground-truth
+//! and the labeled one
+//! \param gtnum Id  - the number of the ground-truth clusters without the complementary one
+//! \param clsnum Id  - the number of the labeled clusters without the complementary one
+//! \param prob bool  - Partial Probabilities or F1 (harmonic) matching policy
+//! \param weighted bool  - weight labels by the number of instances
+//! \param[out] offsets NodeId*  - offsets of the labels of each cluster, can be NULL
+//! \param[out] labels NodeId*  - labels of all clusters, can be NULL
+//! \param lbscap NodeId  - capacity of the labels buffer
+//! \param[out] lbsnum NodeId*  - the total number of labels, can be NULL
+//! \return PrcRec  - precision and recall of the labeling
+template <typename Count>
+static PrcRec evalLabels(const HandlesEval<Count>& ops, Id gtnum, Id clsnum, bool prob
+	, bool weighted, NodeId* offsets, NodeId* labels, NodeId lbscap, NodeId* lbsnum)
+{
+	using CollectionT = Collection<Count>;
+	if(!(offsets || labels || lbsnum))
+		return CollectionT::label(ops.cn1(), ops.cn2(), prob, weighted);
+
+	typename CollectionT::ClsLabels  csls;
+	const auto  pr = CollectionT::label(ops.cn1(), ops.cn2(), prob, weighted
+		, nullptr, false, &csls);
+	vector<uint64_t>  lboffs;
+	RawIds  marks;
+	CollectionT::labelIndices(ops.cn2(), csls, lboffs, marks);
+	// Omit the complementary clusters and labels, which are the last ones
+	NodeId  num = 0;  // The number of labels
+	for(Id i = 0; i < clsnum; ++i) {
+		if(offsets)
+			offsets[i] = num;
+		for(auto j = lboffs[i]; j < lboffs[i + 1]; ++j)
+			num += marks[j] < gtnum;
+	}
+	if(offsets)
+		offsets[clsnum] = num;
+	// Note: the buffer capacity is validated by the number of the retained labels
+	const bool  output = labels && num <= lbscap;
+	if(output) {
+		NodeId  il = 0;  // Index of the label
+		for(auto j = lboffs[0]; j < lboffs[clsnum]; ++j)
+			if(marks[j] < gtnum)
+				labels[il++] = marks[j];
+	}
+	if(lbsnum)
+		*lbsnum = num;
+	if(labels && !output)
+		fprintf(stderr, "WARNING evalLabels(), the labels are omitted since the buffer"
+			" capacity %lu is less than %lu labels\n", size_t(lbscap), size_t(num));
+	return pr;
+}
+
+//! \brief (Extended) Omega Index evaluation of the operands
+//! \note The collections are retained for the subsequent evaluations.
+//! The overlapping (fuzzy) collections are evaluated by the weighted Omega Index
+//! considering the node shares, which yields the same value for the equal shares.
+//!
+//! \param ops const HandlesEval<Count>&  - evaluating collections
+//! \param ext bool  - evaluate extended omega index
+//! \return Probability  - omega index
+template <typename Count>
+static Probability evalOmega(const HandlesEval<Count>& ops, bool ext)
+{
+	if(is_floating_point<Count>::value) {
+		NodeRDegrees  nddgs;
+		ops.cn1().template degrees<true>(nddgs);
+		ops.cn2().template degrees<false>(nddgs);
+		const Id  clsnum1 = ops.cn1().clsnum();
+		const Id  clsnum2 = ops.cn2().clsnum();
+		return ext ? omega<true>(nddgs, clsnum1, clsnum2)
+			: omega<false>(nddgs, clsnum1, clsnum2);
+	}
+	RawClusters  cls1;
+	RawClusters  cls2;
+	NodeRClusters  ndrcs;
+	ops.cn1().template transfer<true>(cls1, ndrcs, true);
+	ops.cn2().template transfer<false>(cls2, ndrcs, true);
+	return ext ? omega<true>(ndrcs, cls1, cls2)
+		: omega<false>(ndrcs, cls1, cls2);
+}
+
+//! \brief Evaluation of the specified measures of the operands, see xms_evaluate()
+//!
+//! \param ops const HandlesEval<Count>&  - evaluating collections
+//! \param[in,out] msrs Measures&  - the measures to be evaluated and their values
+//! \param[out] evaluated uint32_t&  - the evaluated measures, retained on the failure
+//! \param[out] measure const char*&  - the evaluating measure
+//! \return void
+template <typename Count>
+static void evalMeasures(const HandlesEval<Count>& ops, Measures& msrs, uint32_t& evaluated
+	, const char*& measure)
+{
+	// Note: the evaluation order follows evalMeasures() of the CLI, where
+	// the overlapping F1 after NMI reuses some calculations
+	if(msrs.measures & MEASURE_NMI) {
+		measure = "NMI";
+		evalNmi(ops, msrs.expbase, &msrs.nmi);
+		evaluated |= MEASURE_NMI;
+	}
+	if(msrs.measures & MEASURE_ONMI) {
+		measure = "ONMI";
+		msrs.onmi = evalOnmi(ops, &msrs.onmilfk);
+		evaluated |= MEASURE_ONMI;
+	}
+	if(msrs.measures & MEASURE_F1) {
+		measure = "F1";
+		msrs.f1 = evalF1(ops, static_cast<F1>(msrs.f1kind), msrs.f1rec, msrs.f1prc
+			, static_cast<Match>(msrs.mkind));
+		evaluated |= MEASURE_F1;
+	}
+	if(msrs.measures & MEASURE_LABEL) {
+		measure = "labels";
+		// Reset cluster counters set by F1
+		if(msrs.measures & MEASURE_F1) {
+			ops.cn1().clearcounts();
+			ops.cn2().clearcounts();
+		}
+		const auto  pr = Collection<Count>::label(ops.cn1(), ops.cn2(), msrs.lbprob, msrs.lbweighted);
+		msrs.lbprc = pr.prc;
+		msrs.lbrec = pr.rec;
+		msrs.lbf1 = hmean(pr.prc, pr.rec);
+		evaluated |= MEASURE_LABEL;
+	}
+	if(msrs.measures & MEASURE_OMEGA) {
+		measure = "Omega Index";
+		msrs.omega = evalOmega(ops, msrs.ext);
+		evaluated |= MEASURE_OMEGA;
+	}
+}
+
+XmsCollectionHandle xms_collection_create(const ClusterCollection rcn, uint8_t makeunique)
+{
+	try {
+		if(weightedClusters(rcn))
+			return new XmsCollection(loadClusters<AccProb>(rcn, makeunique, 1, nullptr, nullptr
+				, false, nullptr, nullptr, false));
+		return new XmsCollection(loadCollection(rcn, makeunique));
+	} catch(std::exception& err) {
+		fprintf(stderr, "ERROR %s(), the collection can't be created: %s\n", __FUNCTION__, err.what());
+	}
+	return nullptr;
+}
+
+XmsCollectionHandle xms_collection_create_csr(const CsrCollection rcn, uint8_t makeunique)
+{
+	if(rcn.num && (!rcn.offsets || !rcn.ids)) {
+		fprintf(stderr, "ERROR %s(), invalid (non-allocated) CSR buffers\n", __FUNCTION__);
+		return nullptr;
+	}
+	try {
+		// Represent the CSR rows by the node relations referring the ids in place
+		vector<ClusterNodes>  ndrels;
+		ndrels.reserve(rcn.num);
+		for(NodeId i = 0; i < rcn.num; ++i) {
+			const NodeId  ib = rcn.offsets[i];
+			const NodeId  ie = rcn.offsets[i + 1];
+			if(ie < ib || (!i && ib)) {
+				fprintf(stderr, "ERROR %s(), invalid CSR offsets of the cluster #%lu: %lu .. %lu\n"
+					, __FUNCTION__, size_t(i), size_t(ib), size_t(ie));
+				return nullptr;
+			}
+			// Note: the node relations are not modified by the loading
+			ndrels.push_back({ie - ib, const_cast<NodeId*>(rcn.ids + ib)
+				, rcn.weights ? const_cast<LinkWeight*>(rcn.weights + ib) : nullptr});
+		}
+		return xms_collection_create({rcn.num, ndrels.data()}, makeunique);
+	} catch(std::exception& err) {
+		fprintf(stderr, "ERROR %s(), the collection can't be created: %s\n", __FUNCTION__, err.what());
+	}
+	return nullptr;
+}
+
+void xms_collection_free(XmsCollectionHandle hcn)
+{
+	delete hcn;
+}
+
+Probability xms_f1(XmsCollectionHandle hcn1, XmsCollectionHandle hcn2, F1Kind kind
+	, Probability* rec, Probability* prc, MatchKind mkind, uint8_t sync, uint8_t verbose)
+{
+	if(!validHandles(hcn1, hcn2, __FUNCTION__))
+		return numeric_limits<Probability>::quiet_NaN();
+	try {
+		Probability  tmp;  // Temporary buffer, a placeholder
+		return evalHandles(hcn1, hcn2, sync, [&](const auto& ops) {
+			return evalF1(ops, static_cast<F1>(kind), rec ? *rec : tmp, prc ? *prc : tmp
+				, static_cast<Match>(mkind), verbose);
+		});
+	} catch(std::exception& err) {
+		fprintf(stderr, "ERROR %s(), the evaluation failed: %s\n", __FUNCTION__, err.what());
+	}
+	return numeric_limits<Probability>::quiet_NaN();
+}
+
+Probability xms_omega(XmsCollectionHandle hcn1, XmsCollectionHandle hcn2, uint8_t ext, uint8_t sync)
+{
+	if(!validHandles(hcn1, hcn2, __FUNCTION__))
+		return numeric_limits<Probability>::quiet_NaN();
+	try {
+		return evalHandles(hcn1, hcn2, sync, [ext](const auto& ops) {
+			return evalOmega(ops, ext);
+		});
+	} catch(std::exception& err) {
+		fprintf(stderr, "ERROR %s(), the evaluation failed: %s\n", __FUNCTION__, err.what());
+	}
+	return numeric_limits<Probability>::quiet_NaN();
+}
+
+NodeId xms_collection_size(XmsCollectionHandle hcn)
+{
+	return hcn ? hcn->clsnum : 0;
+}
+
+uint8_t xms_collection_weighted(XmsCollectionHandle hcn)
+{
+	return hcn && !hcn->crisp;
+}
+
+Probability xms_nmi(XmsCollectionHandle hcn1, XmsCollectionHandle hcn2, NmiValues* nmis
+	, uint8_t expbase, uint8_t sync)
+{
+	if(!validHandles(hcn1, hcn2, __FUNCTION__))
+		return numeric_limits<Probability>::quiet_NaN();
+	try {
+		return evalHandles(hcn1, hcn2, sync, [expbase, nmis](const auto& ops) {
+			return evalNmi(ops, expbase, nmis);
+		});
+	} catch(std::exception& err) {
+		fprintf(stderr, "ERROR %s(), the evaluation failed: %s\n", __FUNCTION__, err.what());
+	}
+	return numeric_limits<Probability>::quiet_NaN();
+}
+
+Probability xms_onmi(XmsCollectionHandle hcn1, XmsCollectionHandle hcn2, Probability* lfk
+	, uint8_t sync)
+{
+	if(!validHandles(hcn1, hcn2, __FUNCTION__))
+		return numeric_limits<Probability>::quiet_NaN();
+	try {
+		return evalHandles(hcn1, hcn2, sync, [lfk](const auto& ops) {
+			return evalOnmi(ops, lfk);
+		});
+	} catch(std::exception& err) {
+		fprintf(stderr, "ERROR %s(), the evaluation failed: %s\n", __FUNCTION__, err.what());
+	}
+	return numeric_limits<Probability>::quiet_NaN();
+}
+
+Probability xms_label(XmsCollectionHandle hgt, XmsCollectionHandle hcn, uint8_t prob
+	, uint8_t weighted, Probability* prc, Probability* rec, NodeId* offsets
+	, NodeId* labels, NodeId lbscap, NodeId* lbsnum, uint8_t sync)
+{
+	if(!validHandles(hgt, hcn, __FUNCTION__))
+		return numeric_limits<Probability>::quiet_NaN();
+	try {
+		const auto  pr = evalHandles(hgt, hcn, sync, [&](const auto& ops) {
+			return evalLabels(ops, hgt->clsnum, hcn->clsnum, prob, weighted
+				, offsets, labels, lbscap, lbsnum);
+		});
+		if(prc)
+			*prc = pr.prc;
+		if(rec)
+			*rec = pr.rec;
+		return hmean(pr.prc, pr.rec);
+	} catch(std::exception& err) {
+		fprintf(stderr, "ERROR %s(), the evaluation failed: %s\n", __FUNCTION__, err.what());
+	}
+	return numeric_limits<Probability>::quiet_NaN();
+}
+
+uint32_t xms_evaluate(XmsCollectionHandle hcn1, XmsCollectionHandle hcn2, Measures* msrs
+	, uint8_t sync)
+{
+	if(!msrs) {
+		fprintf(stderr, "ERROR %s(), invalid measures\n", __FUNCTION__);
+		return MEASURE_NONE;
+	}
+	constexpr Probability  nan = numeric_limits<Probability>::quiet_NaN();
+	msrs->nmi = {nan, nan, nan, nan};
+	msrs->onmi = msrs->onmilfk = nan;
+	msrs->f1 = msrs->f1prc = msrs->f1rec = nan;
+	msrs->lbf1 = msrs->lbprc = msrs->lbrec = nan;
+	msrs->omega = nan;
+	if(!validHandles(hcn1, hcn2, __FUNCTION__))
+		return MEASURE_NONE;
+
+	uint32_t  evaluated = MEASURE_NONE;
+	const char*  measure = nullptr;  // Evaluating measure
+	try {
+		// Note: the indexes and the synchronized node base are shared by all measures
+		evalHandles(hcn1, hcn2, sync, [msrs, &evaluated, &measure](const auto& ops) {
+			evalMeasures(ops, *msrs, evaluated, measure);
+		});
+	} catch(std::exception& err) {
+		fprintf(stderr, "ERROR %s(), %s evaluation failed: %s\n", __FUNCTION__
+			, measure ? measure : "the", err.what());
+	}
+	return evaluated;
+}
+
+size_t xms_evaluate_batch(XmsCollectionHandle hgt, const XmsCollectionHandle* hcns, size_t num
+	, const Measures* params, Measures* results, uint8_t sync, uint16_t threads)
+{
+	if(!hgt || (num && !(hcns && params && results))) {
+		fprintf(stderr, "ERROR %s(), invalid arguments\n", __FUNCTION__);
+		return 0;
+	}
+	atomic<size_t>  evaluated(0);  // The number of completely evaluated candidates
+	const unsigned  workers = threads ? std::min<size_t>(threads, num) : daoc::workersNum(num, 1);
+	try {
+		// Note: the candidates are fetched one by one since their evaluation time varies
+		daoc::parallelFor(num, [&](size_t i, unsigned) {
+			results[i] = *params;
+			if(xms_evaluate(hgt, hcns[i], &results[i], sync) == params->measures)
+				++evaluated;
+		}, workers, 1);
+	} catch(std::exception& err) {
+		fprintf(stderr, "ERROR %s(), the evaluation failed: %s\n", __FUNCTION__, err.what());
+	}
+	return evaluated;
+}
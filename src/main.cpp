@@ -10,69 +10,724 @@
 //! \date 2017-02-13
 
 #include <cstdio>
+#include <cstring>
+#include <csignal>
 #include <sstream>
 #include <stdexcept>
+#include <future>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <list>
+#include <deque>
+#include <system_error>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
 #include "cmdline.h"  // Arguments parsing
 #include "macrodef.h"
 #include "interface.hpp"
 
 using std::stringstream;
+using std::future;
+using std::mutex;
+using std::lock_guard;
+using Clock = std::chrono::steady_clock;
+using Seconds = std::chrono::duration<double>;
 
 
-//! \brief Arguments parser
-struct ArgParser: gengetopt_args_info {
-	ArgParser(int argc, char **argv) {
-		auto  err = cmdline_parser(argc, argv, this);
-		if(err)
-			throw std::invalid_argument("Arguments parsing failed: " + to_string(err));
+#ifdef ID64
+namespace id64 {
+#endif // ID64
+
+//! \brief Convert the input clustering to the binary format
+//! \pre The arguments are validated
+//!
+//! \param args_info const gengetopt_args_info&  - the parsed arguments
+//! \return int  - the execution status
+int convert(const gengetopt_args_info& args_info)
+{
+	const auto  cn = Collection<Id>::load(args_info.inputs[0], args_info.unique_flag
+		, args_info.membership_arg, nullptr, nullptr, nullptr, args_info.detailed_flag
+		, args_info.prescan_flag, args_info.cache_dir_arg);
+	if(!cn.ndsnum()) {
+		fprintf(stderr, "ERROR, the input clustering is empty: %s\n", args_info.inputs[0]);
+		return EINVAL;
 	}
+	cn.save(args_info.convert_arg, args_info.compress_flag);
+	return 0;
+}
 
-	~ArgParser() {
-		cmdline_parser_free(this);
+//! Named primary values of the evaluated measures
+using MeasureVals = vector<pair<string, AccProb>>;
+
+//! \brief Evaluate the specified measures for the loaded collections
+//! \pre The collections are not empty
+//!
+//! \tparam Count  - arithmetic counting type of the collections
+//!
+//! \param args_info const gengetopt_args_info&  - the parsed arguments
+//! \param cn1 Collection<Count>&  - the first (ground-truth) collection
+//! \param cn2 Collection<Count>&  - the second (evaluating) collection
+//! \param[out] aggouts stringstream&  - aggregated outputs of the measures
+//! \param print bool  - print the measures (and their aggregated outputs if
+//! 	multiple measures are evaluated)
+//! \param retain=false bool  - retain the collections for the subsequent evaluations
+//! \param[out] vals=nullptr MeasureVals*  - primary values of the evaluated
+//! 	measures except the labeling if required
+//! \return int  - the execution status
+template <typename Count>
+int evalMeasures(const gengetopt_args_info& args_info, Collection<Count>& cn1
+	, Collection<Count>& cn2, stringstream& aggouts, bool print, bool retain=false
+	, MeasureVals* vals=nullptr)
+{
+	const bool  verbose = print && args_info.detailed_flag;
+	// The aggregated outputs are formed for multiple measures or if the measures are not printed
+	const bool  aggregate = !print || args_info.omega_flag + args_info.nmi_flag
+		+ args_info.onmi_flag + args_info.f1_given + args_info.label_given >= 2;
+	// Evaluate and output measures
+	// Note: evaluation of overlapping F1 after NMI allows to reuse some
+	// calculations, for other cases the order of evaluations does not matter
+	if(args_info.nmi_flag) {
+		auto rnmi = Collection<Count>::nmi(cn1, cn2, args_info.ln_flag, verbose);
+		// Set NMI to NULL if collections have no any mutual information
+		// ATTENTION: for some cases, for example when one of the collections is a single cluster,
+		// NMI will always yield 0 for any clusters in the second collection, which is limitation
+		// of the original NMI measure. Similar issues possible in more complex configurations.
+		if(rnmi.mi <= precision_limit<decltype(rnmi.mi)>()) {  // Note: strict ! is fine here
+			throw domain_error("NMI is not applicable to the specified collections: 0, which says nothing about the similarity\n");
+			rnmi.h1 = rnmi.h2 = 1;
+		}
+		const auto  nmix = rnmi.mi / std::max(rnmi.h1, rnmi.h2);
+		if(vals)
+			vals->emplace_back("NMI_max", nmix);
+		if(args_info.all_flag) {
+			if(print)
+				printf("NMI_max: %G, NMI_sqrt: %G, NMI_avg: %G, NMI_min: %G\n"
+					, nmix, rnmi.mi / sqrt(rnmi.h1 * rnmi.h2)
+					, 2 * rnmi.mi / (rnmi.h1 + rnmi.h2)
+					, rnmi.mi / std::min(rnmi.h1, rnmi.h2));
+			if(aggregate)
+				aggouts << "NMI_max: " << nmix
+					<< ", NMI_sqrt: " << rnmi.mi / sqrt(rnmi.h1 * rnmi.h2)
+					<< ", NMI_avg: " << 2 * rnmi.mi / (rnmi.h1 + rnmi.h2)
+					<< ", NMI_min: " << rnmi.mi / std::min(rnmi.h1, rnmi.h2);
+		} else {
+			if(print)
+				printf("NMI_max:\n%G\n", nmix);
+			if(aggregate)
+				aggouts << "NMI_max: " << nmix;
+		}
 	}
-};
+	if(args_info.onmi_flag) {
+		const auto  ronmi = Collection<Count>::onmi(cn1, cn2, verbose);
+		if(vals)
+			vals->emplace_back("ONMI_max", ronmi.nmax());
+		if(print)
+			printf("ONMI_max: %G, ONMI_lfk: %G\n", ronmi.nmax(), ronmi.lfk);
+		if(aggregate) {
+			if(aggouts.tellp())
+				aggouts << "; ";
+			aggouts << "ONMI_max: " << ronmi.nmax() << ", ONMI_lfk: " << ronmi.lfk;
+		}
+	}
+	if(args_info.f1_given) {
+		// Assign required F1 type
+		F1  f1kind = F1::NONE;
+		// Note: args_info.f1_orig is empty if default value is used
+		char  f1suf = '-';  // Suffix char of the selected F1 measure
+		switch(args_info.f1_arg) {
+		case f1_arg_partprob:
+			f1kind = F1::PARTPROB;
+			f1suf = 'p';
+			break;
+		case f1_arg_harmonic:
+			f1kind = F1::HARMONIC;
+			f1suf = 'h';
+			break;
+		case f1_arg_average:
+			f1kind = F1::AVERAGE;  // Suggested by Leskovec
+			f1suf = 'a';
+			break;
+		default:
+			throw invalid_argument("main(), UNKNOWN F1 policy specified\n");
+		}
+		// Assign matching kind
+		Match  mkind = Match::NONE;
+		// Note: args_info.kind_orig is empty if default value is used
+		char  kindsuf = '-';  // Suffix char of the selected F1 measure
+		switch(args_info.kind_arg) {
+		case kind_arg_weighted:
+			mkind = Match::WEIGHTED;
+			kindsuf = 'w';
+			break;
+		case kind_arg_unweighed:
+			mkind = Match::UNWEIGHTED;
+			kindsuf = 'u';
+			break;
+		case kind_arg_combined:
+			mkind = Match::COMBINED;
+			kindsuf = 'c';
+			break;
+		default:
+			throw invalid_argument("main(), UNKNOWN Matching policy specified\n");
+		}
+
+		//if(args_info.nmi_flag)
+		//	fputs("; ", stdout);
+		Prob  prc, rec;  // Precision and recall of cn2 relative to ground-truth cn1
+		const auto  f1val = Collection<Count>::f1(cn1, cn2, f1kind, rec, prc, mkind, verbose);
+		if(vals)
+			vals->emplace_back(string("MF1") + f1suf + '_' + kindsuf, f1val);
+		if(print) {
+			printf("MF1%c_%c (%s, %s):\n%G", f1suf, kindsuf, to_string(f1kind).c_str()
+				, to_string(mkind).c_str(), f1val);
+			if(prc || rec)
+				printf(" (Prc: %G, Rec: %G)", prc, rec);
+			fputc('\n', stdout);
+		}
+		if(aggregate) {
+			if(aggouts.tellp())
+				aggouts << "; ";
+			aggouts << "MF1" << f1suf << '_' << kindsuf << ": " << f1val;
+			// Note: prc and rec are zeroized if the matching strategy does not support them
+			if(prc || rec)
+				aggouts << " (Prc: " << prc << ", Rec: " << rec << ')';
+		}
+	}
+	// Label clusters with the ground-truth clusters indices and output F1 for the labels if required
+	if(args_info.label_given) {
+		if(args_info.policy_arg == policy__NULL) {
+			fputs("WARNING f1(), labels matching policy is not specified, the evaluation is skipped\n", stderr);
+			return 0;
+		}
+		// Reset cluster counters if they were set (could be set only by F1)
+		if(args_info.f1_given) {
+			cn1.clearcounts();
+			cn2.clearcounts();
+		}
+		const bool  prob = args_info.policy_arg == policy_arg_partprob;  // Partial Probabilities matching policy
+		const bool  weighted = !args_info.unweighted_flag;
+		PrcRec pr = Collection<Count>::label(cn1, cn2 //, lostcls
+			, prob, weighted, args_info.identifiers_arg, args_info.binary_labels_flag); //, args_info.detailed_flag);
+		// Note: each measure name should form a single world to be properly parsed in a uniform way (see Clubmark),
+		// that is why doubled underscore is used rather than a single space.
+		if(print)
+			printf("F1%c_%c__labels: %G (Prc: %G, Rec: %G)\n"
+				, prob ? 'p' : 'h', weighted ? 'w' : 'u'
+				, hmean(pr.prc, pr.rec), pr.prc, pr.rec);
+		if(aggregate) {
+			if(aggouts.tellp())
+				aggouts << "; ";
+			aggouts << "F1" << (prob ? 'p' : 'h') << '_' << (weighted ? 'w' : 'u')
+				<< "__labels: " << hmean(pr.prc, pr.rec)
+				<< " (Prc: " << pr.prc << ", Rec: " << pr.rec << ')';
+		}
+	}
+	if(args_info.omega_flag) {
+		// Transform loaded and pre-processed collection to the representation
+		// suitable for Omega Index evaluation
+		RawClusters  cls1;
+		RawClusters  cls2;
+		NodeRClusters  ndrcs;
 
+		cn1.template transfer<true>(cls1, ndrcs, retain);
+		cn2.template transfer<false>(cls2, ndrcs, retain);
+		const auto oi = args_info.extended_flag
+			? omega<true>(ndrcs, cls1, cls2)
+			: omega<false>(ndrcs, cls1, cls2)
+			;
+		if(vals)
+			vals->emplace_back(args_info.extended_flag ? "OIx" : "OI", oi);
+		if(print)
+			printf("OI%s:\n%G\n", args_info.extended_flag ? "x" : "", oi);
+		if(aggregate) {
+			if(aggouts.tellp())
+				aggouts << "; ";
+			aggouts << "OI" << (args_info.extended_flag ? "x" : "") << ": " << oi;
+		}
+	}
+	if(print && aggouts.tellp())
+		puts(aggouts.str().c_str());
 
-int main(int argc, char **argv)
+	return 0;
+}
+
+//! \brief Fetch the input clusterings expanding the lists of files ("@<filename>")
+//! \note The list holds a file name per line, empty lines and lines starting
+//! with '#' are skipped
+//!
+//! \param args_info const gengetopt_args_info&  - the parsed arguments
+//! \param ibeg unsigned  - index of the first fetching input
+//! \param[out] names vector<string>&  - file names of the clusterings
+//! \return bool  - the lists of files are successfully read
+static bool fetchInputs(const gengetopt_args_info& args_info, unsigned ibeg
+	, vector<string>& names)
 {
-	ArgParser  args_info(argc, argv);
+	for(unsigned i = ibeg; i < args_info.inputs_num; ++i) {
+		const char*  name = args_info.inputs[i];
+		if(name[0] != '@') {
+			names.emplace_back(name);
+			continue;
+		}
+		NamedFileWrapper  flist(name + 1, "r");
+		if(!flist) {
+			perror((string("ERROR, the list of clusterings can't be opened: ") += name + 1).c_str());
+			return false;
+		}
+		LineReader  lines(flist);
+		for(char* line = lines.readline(); line; line = lines.readline())
+			if(line[0] && line[0] != '#')
+				names.emplace_back(line);
+	}
+	return true;
+}
+
+//! \brief Loading pipeline of the batch candidates, which parses, indexes and
+//! synchronizes the candidates ahead of their evaluation
+//! \note The candidates are requested in the ascending order (up to the
+//! concurrent workers), the number of the candidates loaded ahead of the latest
+//! requested one is bounded by the depth to cap the memory consumption
+//!
+//! \tparam Count  - arithmetic counting type of the collections
+template <typename Count>
+class Prefetcher {
+	const gengetopt_args_info&  m_args;  //!< The parsed arguments
+	const vector<string>&  m_cands;  //!< File names of the candidates
+	const NodeBaseI*  m_ndbase;  //!< Node base filtering the candidates if any
+	Interner*  m_strids;  //!< Interner of the string node ids if required
+	const size_t  m_depth;  //!< Pipeline depth, 0 means the loading on request
+	//! The candidates are loaded serially since they are evaluated concurrently
+	const bool  m_serial;
+	vector<future<Collection<Count>>>  m_loads;  //!< Loading candidates
+	vector<::AggHash>  m_hashes;  //!< Nodes hash of each candidate
+	vector<double>  m_ltimes;  //!< Loading time of each candidate, sec
+	size_t  m_next;  //!< Index of the next candidate to be loaded
+	mutex  m_mutex;  //!< Guard of the loading initiation
+public:
+    //! \brief Constructor
+    //!
+    //! \param args_info const gengetopt_args_info&  - the parsed arguments
+    //! \param cands const vector<string>&  - file names of the candidates
+    //! \param ndbase const NodeBaseI*  - node base filtering the candidates,
+    //! 	which is not modified during the pipeline lifetime, or nullptr
+    //! \param strids Interner*  - interner of the string node ids if required
+    //! \param depth size_t  - the number of candidates loaded ahead, 0 means
+    //! 	the loading on request in the calling thread
+    //! \param serial bool  - load each candidate serially to not oversubscribe
+    //! 	the CPUs by the concurrent evaluation
+	Prefetcher(const gengetopt_args_info& args_info, const vector<string>& cands
+	, const NodeBaseI* ndbase, Interner* strids, size_t depth, bool serial)
+	: m_args(args_info), m_cands(cands), m_ndbase(ndbase), m_strids(strids)
+	, m_depth(depth), m_serial(serial), m_loads(cands.size()), m_hashes(cands.size())
+	, m_ltimes(cands.size()), m_next(0), m_mutex()  {}
+
+    //! \brief Copy constructor, the loadings refer the pipeline
+	Prefetcher(const Prefetcher&)=delete;
+
+    //! \brief Copy assignment, the loadings refer the pipeline
+	Prefetcher& operator=(const Prefetcher&)=delete;
 
-	// Validate required xmeasure
-	if(!args_info.omega_flag && !args_info.nmi_flag && !args_info.f1_given && !args_info.label_given) {
-		fputs("WARNING, no any measures to evaluate are specified\n", stderr);
-		cmdline_parser_print_help();
+    //! \brief Destructor, waits for the initiated loadings, which refer the pipeline
+	~Prefetcher()
+	{
+		// Note: the deferred loadings are not waited since it would execute them
+		if(m_depth)
+			for(auto& ld: m_loads)
+				if(ld.valid())
+					ld.wait();
+	}
+
+    //! \brief Fetch the loaded candidate initiating the loading of the
+    //! subsequent candidates up to the pipeline depth
+    //! \note Each candidate is fetched at most once, the loading exception
+    //! is rethrown
+    //!
+    //! \param i size_t  - index of the candidate
+    //! \param[out] ahash AggHash&  - nodes hash of the candidate
+    //! \return Collection<Count>  - the loaded candidate
+	Collection<Count> fetch(size_t i, ::AggHash& ahash)
+	{
+		{
+			lock_guard<mutex>  lock(m_mutex);
+			for(; m_next < m_cands.size() && m_next <= i + m_depth; ++m_next)
+				m_loads[m_next] = std::async(m_depth ? std::launch::async
+					: std::launch::deferred, [this](size_t ic) {
+						const SerialScope  scope(m_serial);
+						const auto  tload = Clock::now();
+						auto cn = Collection<Count>::load(m_cands[ic].c_str()
+							, m_args.unique_flag, m_args.membership_arg, &m_hashes[ic]
+							, m_ndbase, nullptr, false, m_args.prescan_flag
+							, m_args.cache_dir_arg, m_strids);
+						m_ltimes[ic] = Seconds(Clock::now() - tload).count();
+						return cn;
+					}, m_next);
+		}
+		auto cn = m_loads[i].get();
+		ahash = m_hashes[i];
+		return cn;
+	}
+
+    //! \brief Total loading time of the candidates
+    //! \pre All loadings are completed
+    //!
+    //! \return double  - loading time, sec
+	double loadtime() const noexcept
+	{
+		double  ltime = 0;
+		for(auto tm: m_ltimes)
+			ltime += tm;
+		return ltime;
+	}
+};
+
+//! \brief Evaluate the candidate clusterings against the resident ground-truth
+//! \note The candidates are evaluated concurrently, each worker holds its own
+//! evaluation state of the shared ground-truth. The candidates are loaded ahead
+//! of their evaluation by the pipeline.
+//! \pre The arguments are validated, inputs[0] is the ground-truth
+//!
+//! \tparam Count  - arithmetic counting type of the collections
+//!
+//! \param args_info const gengetopt_args_info&  - the parsed arguments
+//! \param strids Interner*  - interner of the string node ids if required
+//! \return int  - the execution status
+template <typename Count>
+int evalBatch(const gengetopt_args_info& args_info, Interner* strids)
+{
+	// Fetch the candidates expanding the lists of files ("@<filename>")
+	vector<string>  cands;
+	if(!fetchInputs(args_info, 1, cands))
+		return EINVAL;
+
+	// Load the ground-truth synchronizing it with the node base if required
+	::AggHash  nbhash, gthash;
+	NodeBase  ndbase;
+	if(args_info.sync_given)
+		ndbase = NodeBase::load(args_info.sync_arg, args_info.membership_arg
+			, &nbhash, 0, 0, args_info.detailed_flag, strids);
+	Collection<Count>  gt = Collection<Count>::load(args_info.inputs[0]
+		, args_info.unique_flag, args_info.membership_arg, &gthash, ndbase ? &ndbase : nullptr
+		, nullptr, args_info.detailed_flag, args_info.prescan_flag, args_info.cache_dir_arg, strids);
+	if(ndbase && nbhash != gthash) {
+		fprintf(stderr, "ERROR, nodebase hash %lu (%lu nodes) != filtered"
+			" ground-truth nodes hash %lu (%lu)\n", nbhash.hash(), nbhash.size()
+			, gthash.hash(), gthash.size());
+		return EINVAL;
+	}
+	ndbase.clear();
+	if(!gt.ndsnum()) {
+		fprintf(stderr, "ERROR, the ground-truth clustering is empty: %s\n", args_info.inputs[0]);
 		return EINVAL;
 	}
 
-	if(args_info.membership_arg <= 0) {
-		fprintf(stderr, "ERROR, positive membership is expected: %G\n", args_info.membership_arg);
-		return EDOM;
+	// Evaluate the candidates forming a single line of the aggregated outputs for each
+	const auto  tstart = Clock::now();
+	const unsigned  workers = workersNum(cands.size(), 1);
+	// Note: the candidates are filtered by the synchronized ground-truth, whose
+	// membership index is not modified by the evaluation
+	const size_t  depth = size_t(args_info.prefetch_arg) * workers;
+	Prefetcher<Count>  prefetcher(args_info, cands, args_info.sync_given ? &gt : nullptr
+		, strids, depth, workers >= 2);
+	// Note: the first worker evaluates the loaded ground-truth, others its
+	// shallow replicas holding only the evaluation state
+	vector<unique_ptr<Collection<Count>>>  replicas(workers);
+	vector<string>  rows(cands.size());
+	// Waiting for the loading and evaluation times of each worker, sec
+	vector<double>  wtimes(workers), etimes(workers);
+	parallelFor(cands.size(), [&](size_t i, unsigned wid) {
+		// Note: the clusters and memberships of the ground-truth are not modified
+		// by the evaluation
+		if(wid && !replicas[wid])
+			replicas[wid].reset(new Collection<Count>(gt.share()));
+		Collection<Count>* const  gtr = wid ? replicas[wid].get() : &gt;
+		try {
+			::AggHash  cnhash;
+			auto  tstage = Clock::now();
+			auto cn = prefetcher.fetch(i, cnhash);
+			wtimes[wid] += Seconds(Clock::now() - tstage).count();
+			if(!cn.ndsnum()) {
+				rows[i] = "ERROR, the clustering is empty";
+				return;
+			}
+			if(gthash != cnhash)
+				fprintf(stderr, "WARNING, the nodes of %s differ from the ground-truth"
+					" (the quality will be penalized): %lu != %lu nodes\n", cands[i].c_str()
+					, size_t(cn.ndsnum()), size_t(gt.ndsnum()));
+			tstage = Clock::now();
+			gtr->clearstate();
+			stringstream  aggouts;
+			evalMeasures(args_info, *gtr, cn, aggouts, false, true);
+			rows[i] = aggouts.str();
+			etimes[wid] += Seconds(Clock::now() - tstage).count();
+		} catch(IdOverflow&) {
+			throw;  // The batch is reloaded with the wider ids
+		} catch(std::exception& err) {
+			auto&  row = rows[i];
+			row = err.what();
+			if(row.compare(0, 5, "ERROR"))
+				row.insert(0, "ERROR, ");
+			if(!row.empty() && row.back() == '\n')
+				row.pop_back();
+		}
+	}, workers, 1);
+
+	// Output the results in the order of the candidates
+	puts(string("= ").append(is_floating_point<Count>::value
+		? "Overlaps" : "Multi-resolution").append(" Batch Evaluation =").c_str());
+	for(size_t i = 0; i < cands.size(); ++i)
+		printf("%s: %s\n", cands[i].c_str(), rows[i].c_str());
+	if(args_info.detailed_flag) {
+		// Note: the loading of each candidate and the waiting for it are
+		// accumulated over the workers
+		double  wtime = 0, etime = 0;
+		for(unsigned i = 0; i < workers; ++i) {
+			wtime += wtimes[i];
+			etime += etimes[i];
+		}
+		fprintf(stderr, "Batch pipeline (%u workers, depth %lu): loading %.3f sec"
+			", waiting for the loading %.3f sec, evaluation %.3f sec, total %.3f sec\n"
+			, workers, depth, prefetcher.loadtime(), wtime, etime
+			, Seconds(Clock::now() - tstart).count());
 	}
+	return 0;
+}
 
-	{	// Validate the number of input files
-		// Note: sync_arg is specified if sync_given
-		const auto  inpfiles = args_info.inputs_num + (args_info.sync_given || args_info.label_given);  // The number of input files
-		if(inpfiles < 2 || inpfiles > 2 + args_info.sync_given + args_info.label_given) {
-			fputs("ERROR, 2 input clusterings are required with possibly additional"
-				" node base and clusters labels, i.e. 2-4 input files in total\n", stderr);
-			cmdline_parser_print_help();
+//! Header of the binary pairwise matrix (.xpm), which is followed by msrsnum
+//! null-padded names of the measures (PmxHeader::NAMESIZE bytes each), the
+//! row-major float64 matrix of each measure and the null-terminated file names
+//! of the clusterings
+struct PmxHeader {
+	constexpr static char  MAGIC[4] = {'X', 'P', 'M', 'X'};  //!< File signature
+	constexpr static uint16_t  VERSION = 1;  //!< Current format version
+	constexpr static size_t  NAMESIZE = 16;  //!< Size of the measure name
+
+	char  magic[4];  //!< File signature, MAGIC
+	uint16_t  version;  //!< Format version
+	uint16_t  msrsnum;  //!< The number of measures
+	uint32_t  cnsnum;  //!< The number of clusterings (matrix dimension)
+	uint32_t  flags;  //!< Format flags, reserved
+};
+static_assert(sizeof(PmxHeader) == 16, "PmxHeader should not have the padding");
+
+constexpr char  PmxHeader::MAGIC[4];
+
+//! \brief Output the symmetric matrices of the pairwise measures
+//!
+//! \param fout FILE*  - output file
+//! \param names const vector<string>&  - file names of the clusterings
+//! \param msrs const vector<string>&  - names of the measures
+//! \param mtxs const vector<vector<AccProb>>&  - row-major matrix of each measure
+//! \param binary bool  - output in the binary format (.xpm) instead of CSV
+//! \return bool  - the output is successful
+static bool writePairwise(FILE* fout, const vector<string>& names
+	, const vector<string>& msrs, const vector<vector<AccProb>>& mtxs, bool binary)
+{
+	const size_t  cnsnum = names.size();
+	if(binary) {
+		PmxHeader  hdr;
+		std::copy_n(PmxHeader::MAGIC, sizeof hdr.magic, hdr.magic);
+		hdr.version = PmxHeader::VERSION;
+		hdr.msrsnum = msrs.size();
+		hdr.cnsnum = cnsnum;
+		hdr.flags = 0;
+		bool  res = fwrite(&hdr, sizeof hdr, 1, fout) == 1;
+		for(const auto& msr: msrs) {
+			char  name[PmxHeader::NAMESIZE] = {0};
+			msr.copy(name, sizeof name - 1);
+			res = res && fwrite(name, sizeof name, 1, fout) == 1;
+		}
+		for(const auto& mtx: mtxs)
+			res = res && fwrite(mtx.data(), sizeof(AccProb), mtx.size(), fout) == mtx.size();
+		for(const auto& name: names)
+			res = res && fwrite(name.c_str(), 1, name.size() + 1, fout) == name.size() + 1;
+		return res;
+	}
+
+	for(size_t im = 0; im < msrs.size(); ++im) {
+		if(im)
+			fputc('\n', fout);
+		fputs(msrs[im].c_str(), fout);
+		for(const auto& name: names)
+			fprintf(fout, ",%s", name.c_str());
+		fputc('\n', fout);
+		const auto&  mtx = mtxs[im];
+		for(size_t i = 0; i < cnsnum; ++i) {
+			fputs(names[i].c_str(), fout);
+			for(size_t j = 0; j < cnsnum; ++j)
+				fprintf(fout, ",%G", mtx[i * cnsnum + j]);
+			fputc('\n', fout);
+		}
+	}
+	return !ferror(fout);
+}
+
+//! \brief Evaluate the measures for all pairs of the resident clusterings
+//! forming the symmetric matrix of each measure
+//! \note The pairs are evaluated concurrently, each worker holds its own
+//! evaluation state of the shared clusterings
+//! \pre The arguments are validated
+//!
+//! \tparam Count  - arithmetic counting type of the collections
+//!
+//! \param args_info const gengetopt_args_info&  - the parsed arguments
+//! \param strids Interner*  - interner of the string node ids if required
+//! \return int  - the execution status
+template <typename Count>
+int evalPairwise(const gengetopt_args_info& args_info, Interner* strids)
+{
+	vector<string>  names;
+	if(!fetchInputs(args_info, 0, names))
+		return EINVAL;
+	const size_t  cnsnum = names.size();
+	if(cnsnum < 2) {
+		fputs("ERROR, at least 2 clusterings are required for the pairwise evaluation\n", stderr);
+		return EINVAL;
+	}
+
+	// Load the clusterings once synchronizing them with the node base if required
+	::AggHash  nbhash;
+	NodeBase  ndbase;
+	if(args_info.sync_given)
+		ndbase = NodeBase::load(args_info.sync_arg, args_info.membership_arg
+			, &nbhash, 0, 0, args_info.detailed_flag, strids);
+	vector<unique_ptr<Collection<Count>>>  cns(cnsnum);
+	vector<::AggHash>  hashes(cnsnum);
+	parallelFor(cnsnum, [&](size_t i, unsigned) {
+		cns[i].reset(new Collection<Count>(Collection<Count>::load(names[i].c_str()
+			, args_info.unique_flag, args_info.membership_arg, &hashes[i]
+			, ndbase ? &ndbase : nullptr, nullptr, false, args_info.prescan_flag
+			, args_info.cache_dir_arg, strids)));
+	}, workersNum(cnsnum, 1), 1);
+	ndbase.clear();
+	for(size_t i = 0; i < cnsnum; ++i) {
+		if(!cns[i]->ndsnum()) {
+			fprintf(stderr, "ERROR, the clustering is empty: %s\n", names[i].c_str());
 			return EINVAL;
 		}
+		if(hashes[i] != hashes[0])
+			fprintf(stderr, "WARNING, the nodes of %s differ from %s (the quality will"
+				" be penalized): %lu != %lu nodes\n", names[i].c_str(), names[0].c_str()
+				, size_t(cns[i]->ndsnum()), size_t(cns[0]->ndsnum()));
 	}
 
-	// Verify that labeled clusters correspond to the node base if any of them is specified
-	if(args_info.sync_given && args_info.label_given && (strcmp(args_info.sync_arg, args_info.label_arg)
-	|| (args_info.inputs_num == 2 && strcmp(args_info.sync_arg, args_info.inputs[0]))))
-		throw invalid_argument("ERROR, node base file should correspond to the labeled clusters and"
-			" represent the first evaluating collection if both are specified\n");
+	// Evaluate the pairs (i < j) in the row-major order
+	vector<pair<uint32_t, uint32_t>>  pairs;
+	pairs.reserve(cnsnum * (cnsnum - 1) / 2);
+	for(uint32_t i = 0; i < cnsnum; ++i)
+		for(uint32_t j = i + 1; j < cnsnum; ++j)
+			pairs.emplace_back(i, j);
+	const unsigned  workers = workersNum(pairs.size(), 1);
+	// Note: the first worker evaluates the loaded clusterings, others their
+	// shallow replicas holding only the evaluation state
+	vector<vector<unique_ptr<Collection<Count>>>>  replicas(workers);
+	auto replica = [&](unsigned wid, size_t i) -> Collection<Count>& {
+		if(!wid)
+			return *cns[i];
+		auto&  reps = replicas[wid];
+		if(reps.empty())
+			reps.resize(cnsnum);
+		// Note: the clusters and memberships are not modified by the evaluation
+		if(!reps[i])
+			reps[i].reset(new Collection<Count>(cns[i]->share()));
+		return *reps[i];
+	};
+	vector<MeasureVals>  pvals(pairs.size());
+	parallelFor(pairs.size(), [&](size_t ip, unsigned wid) {
+		const auto&  pr = pairs[ip];
+		auto&  cn1 = replica(wid, pr.first);
+		auto&  cn2 = replica(wid, pr.second);
+		cn1.clearstate();
+		cn2.clearstate();
+		try {
+			stringstream  aggouts;
+			evalMeasures(args_info, cn1, cn2, aggouts, false, true, &pvals[ip]);
+		} catch(std::exception& err) {
+			// Note: the values of the failed pair are omitted
+			pvals[ip].clear();
+			fprintf(stderr, "WARNING, the evaluation of %s and %s failed: %s"
+				, names[pr.first].c_str(), names[pr.second].c_str(), err.what());
+		}
+	}, workers, 1);
+	replicas.clear();
+
+	// Form the symmetric matrices, the values of the failed pairs are NaN
+	vector<string>  msrs;
+	for(const auto& vals: pvals)
+		if(vals.size() > msrs.size()) {
+			msrs.clear();
+			for(const auto& val: vals)
+				msrs.push_back(val.first);
+		}
+	if(msrs.empty()) {
+		fputs("ERROR, the measures are not applicable to any pair of the clusterings\n", stderr);
+		return EINVAL;
+	}
+	vector<vector<AccProb>>  mtxs(msrs.size(), vector<AccProb>(cnsnum * cnsnum
+		, numeric_limits<AccProb>::quiet_NaN()));
+	for(auto& mtx: mtxs)
+		for(size_t i = 0; i < cnsnum; ++i)
+			mtx[i * cnsnum + i] = 1;  // Self-similarity
+	for(size_t ip = 0; ip < pairs.size(); ++ip) {
+		const auto&  vals = pvals[ip];
+		if(vals.size() != msrs.size())
+			continue;
+		const auto&  pr = pairs[ip];
+		for(size_t im = 0; im < msrs.size(); ++im)
+			mtxs[im][pr.first * cnsnum + pr.second] = mtxs[im][pr.second * cnsnum + pr.first]
+				= vals[im].second;
+	}
+
+	// Output the matrices
+	const bool  binary = args_info.binary_matrix_flag;
+	// Note: "-" designates stdout
+	const char*  flname = args_info.pairwise_arg ? args_info.pairwise_arg : "-";
+	NamedFileWrapper  fout(flname, binary ? "wb" : "w");
+	if(!fout) {
+		perror((string("ERROR, the pairwise matrix can't be created: ") += flname).c_str());
+		return EIO;
+	}
+	if(!writePairwise(fout, names, msrs, mtxs, binary)) {
+		perror("ERROR, the pairwise matrix output failed");
+		return EIO;
+	}
+	return 0;
+}
+
+//! \brief Evaluate the specified measures for the input clusterings
+//! \pre The arguments are validated
+//!
+//! \param args_info const gengetopt_args_info&  - the parsed arguments
+//! \return int  - the execution status
+int evaluate(const gengetopt_args_info& args_info)
+{
+	// Interner of the string node ids shared by the node base and collections
+	Interner  strinter;
+	Interner* const  strids = args_info.string_ids_flag ? &strinter : nullptr;
+	if(args_info.batch_flag)
+		return args_info.ovp_flag ? evalBatch<AccProb>(args_info, strids)
+			: evalBatch<Id>(args_info, strids);
+	if(args_info.pairwise_given)
+		return args_info.ovp_flag ? evalPairwise<AccProb>(args_info, strids)
+			: evalPairwise<Id>(args_info, strids);
 
 	// Load node base if required
 	NodeBase  ndbase;
 	::AggHash  nbhash;
-	// Note: if label_given then either inputs_num < 2 or inputs_num[0] = sync_arg = label_arg
-	if(args_info.sync_given && args_info.inputs_num == 2 && !args_info.label_given)
-		ndbase = NodeBase::load(args_info.sync_arg, args_info.membership_arg
-			, &nbhash, 0, 0, args_info.detailed_flag);
+	// Note: the node base is loaded concurrently with the collections, which are
+	// filtered as soon as the node base is ready
+	std::future<NodeBase>  fndbase;
+	// Note: if label_given then either inputs_num < 2 or inputs_num[0] = sync_arg = label_arg.
+	// The first collection specified as the node base is not filtered, which also
+	// avoids the repeated parsing of the same file
+	if(args_info.sync_given && args_info.inputs_num == 2 && !args_info.label_given
+	&& strcmp(args_info.sync_arg, args_info.inputs[0]))
+		fndbase = std::async(std::launch::async, [&args_info, &nbhash, strids] {
+			return NodeBase::load(args_info.sync_arg, args_info.membership_arg
+				, &nbhash, 0, 0, args_info.detailed_flag, strids);
+		});
 
 	auto process = [&](auto evaluation) -> int {
 		using Count = decltype(evaluation);
@@ -81,40 +736,68 @@ int main(int argc, char **argv)
 		::AggHash  cn1hash, cn2hash;
 		// Note: cn1 is nodebase if specified and not in the separated file
 		const bool  cn1base = (args_info.sync_given || args_info.label_given) && args_info.inputs_num < 2;
+		RawIds  lostcls;
+		// Load cn2 concurrently with cn1, the synchronized cn2 is filtered by cn1
+		// when the latter is loaded.
+		// Note: the promise should be destructed before the future to unblock
+		// the cn2 loading on the cn1 loading failure (broken promise)
+		std::future<Collection>  fcn2;
+		std::promise<const Collection*>  pcn1;
+		{
+			std::shared_future<const Collection*>  fcn1 = pcn1.get_future().share();
+			fcn2 = std::async(std::launch::async, [&args_info, &cn2hash, &lostcls, cn1base, fcn1
+			, strids] {
+				const char*  filename = args_info.inputs[!cn1base];
+				if(!args_info.sync_given)
+					return Collection::load(filename, args_info.unique_flag
+						, args_info.membership_arg, &cn2hash, nullptr, nullptr, args_info.detailed_flag
+						, args_info.prescan_flag, args_info.cache_dir_arg, strids);
+				return Collection::load(filename, [fcn1]() -> const NodeBaseI* { return fcn1.get(); }
+					, args_info.unique_flag, args_info.membership_arg, &cn2hash
+					, args_info.label_given ? &lostcls : nullptr, args_info.detailed_flag
+					, args_info.prescan_flag, args_info.cache_dir_arg, strids);
+			});
+		}
 		//const char*  nbfile = args_info.sync_given
-		auto cn1 = Collection::load(cn1base ? args_info.sync_given ? args_info.sync_arg
-			: args_info.label_arg : args_info.inputs[0]
-			, args_info.unique_flag, args_info.membership_arg, &cn1hash
-			, ndbase ? &ndbase : nullptr, nullptr, args_info.detailed_flag);
+		const char*  cn1file = cn1base ? args_info.sync_given ? args_info.sync_arg
+			: args_info.label_arg : args_info.inputs[0];
+		Collection  cn1 = fndbase.valid()
+			? Collection::load(cn1file, [&ndbase, &fndbase]() -> const NodeBaseI* {
+				ndbase = fndbase.get();
+				return ndbase ? &ndbase : nullptr;
+			}, args_info.unique_flag, args_info.membership_arg, &cn1hash, nullptr
+			, args_info.detailed_flag, args_info.prescan_flag, args_info.cache_dir_arg, strids)
+			: Collection::load(cn1file, args_info.unique_flag, args_info.membership_arg, &cn1hash
+			, nullptr, nullptr, args_info.detailed_flag, args_info.prescan_flag
+			, args_info.cache_dir_arg, strids);
+		pcn1.set_value(&cn1);
 		if(ndbase) {
 			if(nbhash != cn1hash) {
 				fprintf(stderr, "ERROR, nodebase hash %lu (%lu nodes) != filtered"
 					" collection nodes hash %lu (%lu)\n", nbhash.hash(), nbhash.size()
 					, cn1hash.hash(), cn1hash.size());
+				// Note: cn2 is being filtered by cn1, which is released on return
+				fcn2.wait();
 				return EINVAL;
 			}
 			ndbase.clear();
 		}
-		RawIds  lostcls;
-		auto cn2 = Collection::load(args_info.inputs[!cn1base]
-			, args_info.unique_flag, args_info.membership_arg, &cn2hash
-			, args_info.sync_given ? &cn1 : nullptr
-			, args_info.sync_given && args_info.label_given ? &lostcls : nullptr
-			, args_info.detailed_flag);
+		auto cn2 = fcn2.get();
 
 		if(!cn1.ndsnum() || ! cn2.ndsnum()) {
 			fprintf(stderr, "WARNING, at least one of the collections is empty, there is nothing"
-				" to evaluate. Collection nodes sizes: %u, %u\n", cn1.ndsnum(), cn2.ndsnum());
+				" to evaluate. Collection nodes sizes: %lu, %lu\n", size_t(cn1.ndsnum())
+				, size_t(cn2.ndsnum()));
 			return EINVAL;
 		}
 
 		// Check the collections' nodebase
 		if(cn1hash != cn2hash) {
 			fprintf(stderr, "WARNING, the nodes in the collections differ (the quality will be penalized)"
-				": %u nodes with hash %lu, size: %lu, ids: %lu, id2s: %lu) !="
-				" %u nodes with hash %lu, size: %lu, ids: %lu, id2s: %lu);  synchronize: %s, label: %s\n"
-				, cn1.ndsnum(), cn1hash.hash(), cn1hash.size(), cn1hash.idsum(), cn1hash.id2sum()
-				, cn2.ndsnum(), cn2hash.hash(), cn2hash.size(), cn2hash.idsum(), cn2hash.id2sum()
+				": %lu nodes with hash %lu, size: %lu, ids: %lu, id2s: %lu) !="
+				" %lu nodes with hash %lu, size: %lu, ids: %lu, id2s: %lu);  synchronize: %s, label: %s\n"
+				, size_t(cn1.ndsnum()), cn1hash.hash(), cn1hash.size(), cn1hash.idsum(), cn1hash.id2sum()
+				, size_t(cn2.ndsnum()), cn2hash.hash(), cn2hash.size(), cn2hash.idsum(), cn2hash.id2sum()
 				, daoc::toYesNo(args_info.sync_given), daoc::toYesNo(args_info.label_given));
 			//if(args_info.sync_given) {
 			//	fputs("ERROR, the nodes base should be synchronized\n", stderr);
@@ -122,156 +805,995 @@ int main(int argc, char **argv)
 			//}
 		}
 
-		// The number of outputting measures (1 .. 4)
-		uint8_t  outsnum = args_info.omega_flag + args_info.nmi_flag
-			 + args_info.f1_given + args_info.label_given;
-		stringstream  aggouts;  // Aggregated outputs
-		// Evaluate and output measures
-		// Note: evaluation of overlapping F1 after NMI allows to reuse some
-		// calculations, for other cases the order of evaluations does not matter
 		puts(string("= ").append(is_floating_point<Count>::value
 			? "Overlaps" : "Multi-resolution").append(" Evaluation =").c_str());
-		if(args_info.nmi_flag) {
-			auto rnmi = Collection::nmi(cn1, cn2, args_info.ln_flag, args_info.detailed_flag);
-			// Set NMI to NULL if collections have no any mutual information
-			// ATTENTION: for some cases, for example when one of the collections is a single cluster,
-			// NMI will always yield 0 for any clusters in the second collection, which is limitation
-			// of the original NMI measure. Similar issues possible in more complex configurations.
-			if(rnmi.mi <= precision_limit<decltype(rnmi.mi)>()) {  // Note: strict ! is fine here
-				throw domain_error("NMI is not applicable to the specified collections: 0, which says nothing about the similarity\n");
-				rnmi.h1 = rnmi.h2 = 1;
+		stringstream  aggouts;  // Aggregated outputs
+		return evalMeasures(args_info, cn1, cn2, aggouts, true);
+	};
+
+
+	return args_info.ovp_flag ? process(AccProb()) : process(Id());
+}
+
+// Evaluation Server -----------------------------------------------------------
+//! \brief Resident ground-truth of the evaluation server
+//! \note The evaluation state is stored in the clusters, so the concurrent
+//! evaluations of the same ground-truth use its distinct replicas
+struct Resident {
+	string  key;  //!< Cache key: the file name and the loading options
+	uint64_t  size;  //!< Size of the file, the modified file is reloaded
+	uint64_t  mtime;  //!< Modification time of the file, ns
+	::AggHash  hash;  //!< Nodes hash
+	size_t  bytes;  //!< Approximate memory consumption of a replica
+	size_t  repsnum;  //!< The number of replicas
+	bool  evicted;  //!< The resident is evicted from the cache
+
+    //! \brief Constructor
+    //!
+    //! \param key const string&  - cache key
+    //! \param size uint64_t  - size of the file
+    //! \param mtime uint64_t  - modification time of the file, ns
+    //! \param hash const AggHash&  - nodes hash
+    //! \param bytes size_t  - memory consumption of a replica
+	Resident(const string& key, uint64_t size, uint64_t mtime, const ::AggHash& hash
+	, size_t bytes)
+	: key(key), size(size), mtime(mtime), hash(hash), bytes(bytes), repsnum(1)
+	, evicted(false)  {}
+
+    //! \brief Virtual destructor
+	virtual ~Resident()=default;
+};
+
+//! \brief Resident ground-truth with the typed replicas
+//!
+//! \tparam Count  - arithmetic counting type of the collection
+template <typename Count>
+struct ResidentT: Resident {
+	vector<unique_ptr<Collection<Count>>>  replicas;  //!< Loaded collection and its replicas
+	vector<Collection<Count>*>  idle;  //!< Replicas available for the evaluation
+	const Collection<Count>*  origin;  //!< The loaded collection, a source of the replicas
+
+    //! \brief Constructor
+    //!
+    //! \param key const string&  - cache key
+    //! \param size uint64_t  - size of the file
+    //! \param mtime uint64_t  - modification time of the file, ns
+    //! \param hash const AggHash&  - nodes hash
+    //! \param cn unique_ptr<Collection<Count>>&&  - the loaded collection
+	ResidentT(const string& key, uint64_t size, uint64_t mtime, const ::AggHash& hash
+	, unique_ptr<Collection<Count>>&& cn)
+	: Resident(key, size, mtime, hash, cn->memsize()), replicas(), idle(), origin(cn.get())
+	{ replicas.push_back(move(cn)); }
+
+    //! \brief Copy constructor, the replicas have a single owner
+	ResidentT(const ResidentT&)=delete;
+
+    //! \brief Copy assignment, the replicas have a single owner
+	ResidentT& operator=(const ResidentT&)=delete;
+};
+
+//! \brief Resident ground-truth collections of the evaluation server with the
+//! LRU eviction under the memory budget
+//! \note The evicted collections are released when their evaluations are completed
+class Residents {
+	using ResidentPtr = std::shared_ptr<Resident>;
+	using Recents = std::list<ResidentPtr>;
+
+	const size_t  m_budget;  //!< Memory budget, bytes
+	size_t  m_used;  //!< Memory consumed by the residents, bytes
+	Recents  m_lru;  //!< Residents starting from the most recently used
+	unordered_map<string, Recents::iterator>  m_index;  //!< Residents by their keys
+	mutex  m_mutex;  //!< Guard of the residents and their replicas
+
+    //! \brief Remove the resident from the cache
+    //! \pre The guard is locked
+    //!
+    //! \param ir Recents::iterator  - the resident to be removed
+	void remove(Recents::iterator ir) noexcept
+	{
+		auto&  res = **ir;
+		res.evicted = true;
+		m_used -= res.bytes * res.repsnum;
+		m_index.erase(res.key);
+		m_lru.erase(ir);
+	}
+
+    //! \brief Evict the least recently used residents exceeding the memory budget
+    //! \pre The guard is locked
+    //!
+    //! \param keep const Resident*  - the resident to be retained
+	void evict(const Resident* keep) noexcept
+	{
+		while(m_used > m_budget && !m_lru.empty() && m_lru.back().get() != keep) {
+#if TRACE >= 1
+			fprintf(stderr, "evict(), %s is evicted (%lu replicas of %lu bytes)\n"
+				, m_lru.back()->key.c_str(), m_lru.back()->repsnum, m_lru.back()->bytes);
+#endif // TRACE
+			remove(prev(m_lru.end()));
+		}
+	}
+
+    //! \brief Fetch the idle replica of the actual resident
+    //! \pre The guard is locked
+    //!
+    //! \tparam Count  - arithmetic counting type of the collection
+    //!
+    //! \param key const string&  - cache key
+    //! \param fst const struct stat&  - state of the file
+    //! \param[out] res shared_ptr<ResidentT<Count>>&  - the actual resident if any
+    //! \return Collection<Count>*  - the idle replica or nullptr
+	template <typename Count>
+	Collection<Count>* fetch(const string& key, const struct stat& fst
+		, std::shared_ptr<ResidentT<Count>>& res) noexcept
+	{
+		auto ir = m_index.find(key);
+		if(ir == m_index.end())
+			return nullptr;
+		if((*ir->second)->size != uint64_t(fst.st_size) || (*ir->second)->mtime != mtimeNs(fst)) {
+			remove(ir->second);  // The file is modified
+			return nullptr;
+		}
+		m_lru.splice(m_lru.begin(), m_lru, ir->second);
+		// Note: the key determines the counting type
+		res = std::static_pointer_cast<ResidentT<Count>>(m_lru.front());
+		if(res->idle.empty())
+			return nullptr;
+		auto  cn = res->idle.back();
+		res->idle.pop_back();
+		return cn;
+	}
+
+    //! \brief Add a replica to the resident
+    //! \pre The guard is locked
+    //!
+    //! \tparam Count  - arithmetic counting type of the collection
+    //!
+    //! \param res ResidentT<Count>&  - the resident
+    //! \param cn unique_ptr<Collection<Count>>&&  - the replica
+	template <typename Count>
+	void extend(ResidentT<Count>& res, unique_ptr<Collection<Count>>&& cn)
+	{
+		res.replicas.push_back(move(cn));
+		++res.repsnum;
+		if(!res.evicted) {
+			m_used += res.bytes;
+			evict(&res);
+		}
+	}
+public:
+	//! \brief Replica of the resident lent for the evaluation
+	//!
+	//! \tparam Count  - arithmetic counting type of the collection
+	template <typename Count>
+	class Lease {
+		Residents*  m_owner;  //!< Owner of the resident
+		std::shared_ptr<ResidentT<Count>>  m_res;  //!< The resident
+		Collection<Count>*  m_cn;  //!< The lent replica
+	public:
+	    //! \brief Constructor
+	    //!
+	    //! \param owner Residents*  - owner of the resident
+	    //! \param res const shared_ptr<ResidentT<Count>>&  - the resident
+	    //! \param cn Collection<Count>*  - the lent replica
+		Lease(Residents* owner, const std::shared_ptr<ResidentT<Count>>& res
+		, Collection<Count>* cn) noexcept
+		: m_owner(owner), m_res(res), m_cn(cn)  {}
+
+	    //! \brief Move constructor
+		Lease(Lease&& ls) noexcept
+		: m_owner(ls.m_owner), m_res(move(ls.m_res)), m_cn(ls.m_cn)
+		{ ls.m_cn = nullptr; }
+
+	    //! \brief Copy constructor, the replica has a single borrower
+		Lease(const Lease&)=delete;
+
+	    //! \brief Copy assignment, the replica has a single borrower
+		Lease& operator=(const Lease&)=delete;
+
+	    //! \brief Destructor, returns the replica to the resident
+		~Lease()
+		{
+			if(!m_cn)
+				return;
+			lock_guard<mutex>  lock(m_owner->m_mutex);
+			m_res->idle.push_back(m_cn);
+		}
+
+	    //! \brief The lent replica
+	    //!
+	    //! \return Collection<Count>&  - the replica
+		Collection<Count>& operator*() const noexcept  { return *m_cn; }
+
+	    //! \brief Nodes hash of the resident
+	    //!
+	    //! \return const AggHash&  - nodes hash
+		const ::AggHash& hash() const noexcept  { return m_res->hash; }
+	};
+
+    //! \brief Constructor
+    //!
+    //! \param budget size_t  - memory budget, bytes
+	explicit Residents(size_t budget): m_budget(budget), m_used(0), m_lru(), m_index()
+	, m_mutex()  {}
+
+    //! \brief Modification time of the file
+    //!
+    //! \param fst const struct stat&  - state of the file
+    //! \return uint64_t  - modification time, ns
+	static uint64_t mtimeNs(const struct stat& fst) noexcept
+	{
+		return uint64_t(fst.st_mtim.tv_sec) * 1000000000 + fst.st_mtim.tv_nsec;
+	}
+
+    //! \brief Acquire a replica of the resident ground-truth loading it if required
+    //!
+    //! \tparam Count  - arithmetic counting type of the collection
+    //!
+    //! \param args const gengetopt_args_info&  - loading options of the request
+    //! \param filename const char*  - the ground-truth file
+    //! \return Lease<Count>  - the lent replica
+	template <typename Count>
+	Lease<Count> acquire(const gengetopt_args_info& args, const char* filename)
+	{
+		struct stat  fst;
+		if(stat(filename, &fst) || !S_ISREG(fst.st_mode))
+			throw invalid_argument(string("ERROR acquire(), the ground-truth should be"
+				" a regular file: ").append(filename));
+		string  key(filename);
+		key.append(args.ovp_flag ? " ovp" : " mres").append(args.unique_flag ? " unique" : "");
+		if(args.sync_given)
+			key.append(" sync=").append(args.sync_arg);
+
+		std::shared_ptr<ResidentT<Count>>  res;
+		{
+			lock_guard<mutex>  lock(m_mutex);
+			auto cn = fetch<Count>(key, fst, res);
+			if(cn)
+				return Lease<Count>(this, res, cn);
+		}
+		// Replicate the resident, whose members and memberships are not modified
+		// by the evaluation
+		if(res) {
+			unique_ptr<Collection<Count>>  rep(new Collection<Count>(res->origin->clone()));
+			auto  cn = rep.get();
+			lock_guard<mutex>  lock(m_mutex);
+			extend(*res, move(rep));
+			return Lease<Count>(this, res, cn);
+		}
+
+		// Load the ground-truth synchronizing it with the node base if required
+		::AggHash  nbhash, gthash;
+		NodeBase  ndbase;
+		if(args.sync_given)
+			ndbase = NodeBase::load(args.sync_arg, args.membership_arg, &nbhash);
+		unique_ptr<Collection<Count>>  gt(new Collection<Count>(Collection<Count>::load(filename
+			, args.unique_flag, args.membership_arg, &gthash, ndbase ? &ndbase : nullptr
+			, nullptr, false, args.prescan_flag, args.cache_dir_arg)));
+		if(ndbase && nbhash != gthash)
+			throw invalid_argument(string("ERROR acquire(), the node base does not match"
+				" the filtered ground-truth: ").append(filename));
+		if(!gt->ndsnum())
+			throw invalid_argument(string("ERROR acquire(), the ground-truth clustering"
+				" is empty: ").append(filename));
+		auto  cn = gt.get();
+		lock_guard<mutex>  lock(m_mutex);
+		// Note: the ground-truth could be loaded concurrently by another request
+		auto ir = m_index.find(key);
+		if(ir != m_index.end()) {
+			const auto&  cur = **ir->second;
+			if(cur.size == uint64_t(fst.st_size) && cur.mtime == mtimeNs(fst)) {
+				res = std::static_pointer_cast<ResidentT<Count>>(*ir->second);
+				extend(*res, move(gt));
+				return Lease<Count>(this, res, cn);
 			}
-			const auto  nmix = rnmi.mi / std::max(rnmi.h1, rnmi.h2);
-			if(args_info.all_flag) {
-				printf("NMI_max: %G, NMI_sqrt: %G, NMI_avg: %G, NMI_min: %G\n"
-					, nmix, rnmi.mi / sqrt(rnmi.h1 * rnmi.h2)
-					, 2 * rnmi.mi / (rnmi.h1 + rnmi.h2)
-					, rnmi.mi / std::min(rnmi.h1, rnmi.h2));
-				if(--outsnum || aggouts.tellp())
-					aggouts << "NMI_max: " << nmix
-						<< ", NMI_sqrt: " << rnmi.mi / sqrt(rnmi.h1 * rnmi.h2)
-						<< ", NMI_avg: " << 2 * rnmi.mi / (rnmi.h1 + rnmi.h2)
-						<< ", NMI_min: " << rnmi.mi / std::min(rnmi.h1, rnmi.h2);
-			} else {
-				printf("NMI_max:\n%G\n", nmix);
-				if(--outsnum || aggouts.tellp())
-					aggouts << "NMI_max: " << nmix;
+			remove(ir->second);
+		}
+		res = std::make_shared<ResidentT<Count>>(key, fst.st_size, mtimeNs(fst), gthash, move(gt));
+		m_lru.push_front(res);
+		m_index[key] = m_lru.begin();
+		m_used += res->bytes;
+		evict(res.get());
+		return Lease<Count>(this, res, cn);
+	}
+
+    //! \brief Statistics of the residents in JSON
+    //!
+    //! \return string  - the statistics
+	string stats()
+	{
+		lock_guard<mutex>  lock(m_mutex);
+		size_t  repsnum = 0;
+		for(const auto& res: m_lru)
+			repsnum += res->repsnum;
+		return "\"residents\": " + to_string(m_lru.size()) + ", \"replicas\": "
+			+ to_string(repsnum) + ", \"bytes\": " + to_string(m_used)
+			+ ", \"budget\": " + to_string(m_budget);
+	}
+};
+
+//! \brief Escape the string for JSON omitting the trailing new lines
+//!
+//! \param str const string&  - the string to be escaped
+//! \return string  - the escaped string
+static string jsonEscape(const string& str)
+{
+	size_t  len = str.size();
+	while(len && str[len - 1] == '\n')
+		--len;
+	string  res;
+	res.reserve(len + 2);
+	for(size_t i = 0; i < len; ++i) {
+		const char  c = str[i];
+		if(c == '"' || c == '\\')
+			res.append(1, '\\').append(1, c);
+		else if(static_cast<unsigned char>(c) < 0x20) {
+			char  code[8];
+			snprintf(code, sizeof code, "\\u%04x", c);
+			res.append(code);
+		} else res.push_back(c);
+	}
+	return res;
+}
+
+//! \brief Index of the enumerated value
+//! \note The value can be abbreviated by its unique prefix as in the command line
+//!
+//! \param values const char*[]  - null-terminated values of the enumeration
+//! \param val const char*  - the value or its prefix
+//! \return int  - index of the value or -1 if it is not found or ambiguous
+static int enumIndex(const char* values[], const char* val) noexcept
+{
+	const size_t  len = strlen(val);
+	int  ival = -1;  // Index of the matched value
+	for(int i = 0; values[i]; ++i)
+		if(!strncmp(values[i], val, len)) {
+			if(!values[i][len])
+				return i;  // Exact match
+			if(ival >= 0)
+				return -1;  // Ambiguous prefix
+			ival = i;
+		}
+	return ival;
+}
+
+//! \brief Apply the options of the request to the server arguments
+//! \note The options are the long options of the evaluation (measures and
+//! loading), the measures of the request replace the server ones
+//!
+//! \param tokens const vector<string>&  - tokens of the request
+//! \param ibeg size_t  - index of the first option
+//! \param[in,out] args gengetopt_args_info&  - the server arguments to be updated
+//! 	referring the tokens
+//! \return void
+static void applyOptions(const vector<string>& tokens, size_t ibeg, gengetopt_args_info& args)
+{
+	bool  measures = false;  // The measures are specified by the request
+	for(size_t i = ibeg; i < tokens.size(); ++i) {
+		const string&  tok = tokens[i];
+		const auto  ieq = tok.find('=');
+		const string  name = tok.compare(0, 2, "--") ? string()
+			: tok.substr(2, ieq == string::npos ? ieq : ieq - 2);
+		const char*  val = ieq != string::npos ? tok.c_str() + ieq + 1 : nullptr;
+		if(!measures && (name == "omega" || name == "extended" || name == "nmi"
+		|| name == "all" || name == "ln" || name == "onmi" || name == "f1" || name == "kind")) {
+			measures = true;
+			args.omega_flag = args.extended_flag = args.nmi_flag = args.all_flag
+				= args.ln_flag = args.onmi_flag = 0;
+			args.f1_given = 0;
+			args.kind_arg = kind_arg_weighted;
+		}
+		int  ival = 0;  // Index of the enumerated value
+		if(name == "ovp")
+			args.ovp_flag = 1;
+		else if(name == "unique")
+			args.unique_flag = 1;
+		else if(name == "sync" && val && val[0]) {
+			args.sync_given = 1;
+			args.sync_arg = const_cast<char*>(val);
+		} else if(name == "membership" && val && (args.membership_arg = strtof(val, nullptr)) > 0)
+			continue;
+		else if(name == "omega")
+			args.omega_flag = 1;
+		else if(name == "extended")
+			args.extended_flag = 1;
+		else if(name == "nmi")
+			args.nmi_flag = 1;
+		else if(name == "all")
+			args.all_flag = 1;
+		else if(name == "ln")
+			args.ln_flag = 1;
+		else if(name == "onmi")
+			args.onmi_flag = 1;
+		else if(name == "f1" && (!val || (ival = enumIndex(cmdline_parser_f1_values, val)) >= 0)) {
+			args.f1_given = 1;
+			args.f1_arg = enum_f1(ival);
+		} else if(name == "kind" && val && (ival = enumIndex(cmdline_parser_kind_values, val)) >= 0)
+			args.kind_arg = enum_kind(ival);
+		else throw invalid_argument("ERROR applyOptions(), invalid option: " + tok);
+	}
+	if(!args.omega_flag && !args.nmi_flag && !args.onmi_flag && !args.f1_given)
+		throw invalid_argument("ERROR applyOptions(), no any measures to evaluate are specified");
+}
+
+//! \brief Evaluate the clustering against the resident ground-truth
+//!
+//! \tparam Count  - arithmetic counting type of the collections
+//!
+//! \param args const gengetopt_args_info&  - arguments of the request
+//! \param gtname const char*  - the ground-truth file
+//! \param cnname const char*  - the evaluating clustering file
+//! \param residents Residents&  - resident ground-truth collections
+//! \return string  - JSON fields of the evaluated measures
+template <typename Count>
+string serveEvaluation(const gengetopt_args_info& args, const char* gtname
+	, const char* cnname, Residents& residents)
+{
+	auto gt = residents.acquire<Count>(args, gtname);
+	// Note: the clustering is filtered by the synchronized ground-truth
+	::AggHash  cnhash;
+	auto cn = Collection<Count>::load(cnname, args.unique_flag, args.membership_arg
+		, &cnhash, args.sync_given ? &*gt : nullptr, nullptr, false, args.prescan_flag
+		, args.cache_dir_arg);
+	if(!cn.ndsnum())
+		throw invalid_argument(string("ERROR serveEvaluation(), the clustering is empty: ")
+			.append(cnname));
+	(*gt).clearstate();
+	stringstream  aggouts;
+	MeasureVals  vals;
+	evalMeasures(args, *gt, cn, aggouts, false, true, &vals);
+
+	string  res = "\"measures\": {";
+	for(size_t i = 0; i < vals.size(); ++i) {
+		char  num[32] = "null";  // Non-finite values are not representable in JSON
+		if(std::isfinite(vals[i].second))
+			snprintf(num, sizeof num, "%.9G", vals[i].second);
+		res.append(i ? ", \"" : "\"").append(vals[i].first).append("\": ").append(num);
+	}
+	res.append("}, \"nodes\": [").append(to_string((*gt).ndsnum())).append(", ")
+		.append(to_string(cn.ndsnum())).append("], \"details\": \"")
+		.append(jsonEscape(aggouts.str())).append("\"");
+	if(gt.hash() != cnhash)
+		res.append(", \"warning\": \"the nodes differ from the ground-truth\"");
+	return res;
+}
+
+//! \brief Load the ground-truth to be resident
+//!
+//! \tparam Count  - arithmetic counting type of the collection
+//!
+//! \param args const gengetopt_args_info&  - arguments of the request
+//! \param gtname const char*  - the ground-truth file
+//! \param residents Residents&  - resident ground-truth collections
+//! \return string  - JSON fields of the resident
+template <typename Count>
+string serveLoading(const gengetopt_args_info& args, const char* gtname, Residents& residents)
+{
+	const auto  gt = residents.acquire<Count>(args, gtname);
+	return "\"clusters\": " + to_string((*gt).clsnum()) + ", \"nodes\": "
+		+ to_string((*gt).ndsnum()) + ", \"bytes\": " + to_string((*gt).memsize());
+}
+
+//! \brief Client connection of the evaluation server
+class Connection {
+	int  m_fd;  //!< Socket
+	string  m_buf;  //!< Received data
+	size_t  m_pos;  //!< Begin of the unprocessed data in the buffer
+public:
+    //! \brief Constructor
+    //!
+    //! \param fd int  - socket of the connection, which is owned
+	explicit Connection(int fd) noexcept: m_fd(fd), m_buf(), m_pos(0)  {}
+
+    //! \brief Copy constructor, the socket has a single owner
+	Connection(const Connection&)=delete;
+
+    //! \brief Copy assignment, the socket has a single owner
+	Connection& operator=(const Connection&)=delete;
+
+    //! \brief Destructor, closes the socket
+	~Connection()  { close(m_fd); }
+
+    //! \brief Socket of the connection
+    //!
+    //! \return int  - socket
+	int fd() const noexcept  { return m_fd; }
+
+    //! \brief Whether a complete line is buffered
+    //!
+    //! \return bool  - the buffered line exists
+	bool buffered() const noexcept  { return m_buf.find('\n', m_pos) != string::npos; }
+
+    //! \brief Read the line blocking until it is received
+    //!
+    //! \param[out] line string&  - the line without the terminating new line
+    //! \return bool  - the line is read, false on the connection closing
+	bool readline(string& line)
+	{
+		while(true) {
+			const auto  iend = m_buf.find('\n', m_pos);
+			if(iend != string::npos) {
+				line.assign(m_buf, m_pos, iend - m_pos);
+				if(!line.empty() && line.back() == '\r')
+					line.pop_back();
+				m_pos = iend + 1;
+				return true;
 			}
+			m_buf.erase(0, m_pos);
+			m_pos = 0;
+			char  chunk[64 << 10];
+			const ssize_t  len = read(m_fd, chunk, sizeof chunk);
+			if(len > 0)
+				m_buf.append(chunk, len);
+			else if(len == -1 && errno == EINTR)
+				continue;
+			else return false;
 		}
-		if(args_info.f1_given) {
-			// Assign required F1 type
-			F1  f1kind = F1::NONE;
-			// Note: args_info.f1_orig is empty if default value is used
-			char  f1suf = '-';  // Suffix char of the selected F1 measure
-			switch(args_info.f1_arg) {
-			case f1_arg_partprob:
-				f1kind = F1::PARTPROB;
-				f1suf = 'p';
-				break;
-			case f1_arg_harmonic:
-				f1kind = F1::HARMONIC;
-				f1suf = 'h';
-				break;
-			case f1_arg_average:
-				f1kind = F1::AVERAGE;  // Suggested by Leskovec
-				f1suf = 'a';
-				break;
-			default:
-				throw invalid_argument("main(), UNKNOWN F1 policy specified\n");
+	}
+
+    //! \brief Write the line
+    //!
+    //! \param line const string&  - the line to be written with the new line
+    //! \return bool  - the line is written
+	bool writeline(string line) const noexcept
+	{
+		line.push_back('\n');
+		for(size_t pos = 0; pos < line.size(); ) {
+			// Note: the disconnected client should not terminate the server
+			const ssize_t  len = send(m_fd, line.data() + pos, line.size() - pos, MSG_NOSIGNAL);
+			if(len > 0)
+				pos += len;
+			else if(len == -1 && errno == EINTR)
+				continue;
+			else return false;
+		}
+		return true;
+	}
+};
+
+//! \brief Shared state of the evaluation server
+//! \note The idle connections are polled by the listening thread, which passes
+//! the connections having the requests to the pool of workers
+struct ServerState {
+	using ConnectionPtr = unique_ptr<Connection>;
+
+	int  wakefd[2];  //!< Pipe waking up the polling of the connections
+	bool  stop;  //!< The server is stopping
+	std::deque<ConnectionPtr>  pending;  //!< Connections having the requests
+	vector<ConnectionPtr>  served;  //!< Connections served by the workers to be polled
+	mutex  guard;  //!< Guard of the state
+	std::condition_variable  ready;  //!< A connection is pending or the server is stopping
+
+    //! \brief Constructor
+	ServerState(): wakefd{-1, -1}, stop(false), pending(), served(), guard(), ready()
+	{
+		if(pipe(wakefd))
+			throw std::system_error(errno, std::generic_category(), "ERROR ServerState()"
+				", the waking pipe can't be created");
+	}
+
+    //! \brief Copy constructor, the pipe has a single owner
+	ServerState(const ServerState&)=delete;
+
+    //! \brief Copy assignment, the pipe has a single owner
+	ServerState& operator=(const ServerState&)=delete;
+
+    //! \brief Destructor
+	~ServerState()
+	{
+		close(wakefd[0]);
+		close(wakefd[1]);
+	}
+
+    //! \brief Wake up the polling
+    //! \pre The guard is locked
+	void wake() const noexcept
+	{
+		const char  sig = 1;
+		if(write(wakefd[1], &sig, 1) == -1)
+			perror("WARNING wake(), the polling can't be woken up");
+	}
+
+    //! \brief Stop the server
+	void terminate()
+	{
+		lock_guard<mutex>  lock(guard);
+		stop = true;
+		wake();
+		ready.notify_all();
+	}
+};
+
+//! \brief Read the inline CNL payload of the request to the temporary file
+//! \note The payload is terminated by the line consisting of a single '.'
+//!
+//! \param conn Connection&  - the client connection
+//! \return string  - the temporary file name
+static string savePayload(Connection& conn)
+{
+	const char*  tmpdir = getenv("TMPDIR");
+	string  name = string(tmpdir && tmpdir[0] ? tmpdir : "/tmp").append("/xmeasures.XXXXXX");
+	const int  fd = mkstemp(&name[0]);
+	FileWrapper  fout(fd != -1 ? fdopen(fd, "w") : nullptr);
+	if(!fout) {
+		if(fd != -1) {
+			close(fd);
+			unlink(name.c_str());
+		}
+		// Note: the payload is skipped to retain the requests stream
+		name.clear();
+	}
+	string  line;
+	bool  terminated = false;
+	while(conn.readline(line) && !(terminated = line == "."))
+		if(fout) {
+			fwrite(line.data(), 1, line.size(), fout);
+			fputc('\n', fout);
+		}
+	if(name.empty())
+		throw std::runtime_error("ERROR savePayload(), the temporary file can't be created");
+	if(!terminated || ferror(fout) || fflush(fout)) {
+		fout.reset();
+		unlink(name.c_str());
+		throw invalid_argument("ERROR savePayload(), the payload is not terminated or can't be saved");
+	}
+	return name;
+}
+
+//! \brief Process the request of the client
+//!
+//! \param args_info const gengetopt_args_info&  - the server arguments
+//! \param tokens const vector<string>&  - tokens of the request
+//! \param conn Connection&  - the client connection providing the inline payload
+//! \param residents Residents&  - resident ground-truth collections
+//! \param state ServerState&  - the server state
+//! \return string  - JSON fields of the response
+static string serveRequest(const gengetopt_args_info& args_info, const vector<string>& tokens
+	, Connection& conn, Residents& residents, ServerState& state)
+{
+	const string&  cmd = tokens[0];
+	if(cmd == "STATS")
+		return residents.stats();
+	if(cmd == "STOP") {
+		state.terminate();
+		return "\"stopping\": true";
+	}
+
+	const bool  eval = cmd == "EVAL";
+	if(!eval && cmd != "LOAD")
+		throw invalid_argument("ERROR serveRequest(), unknown command: " + cmd);
+	// Note: the inline payload is read before the validation to retain the requests stream
+	string  tmpname;
+	if(eval && tokens.size() >= 3 && tokens[2] == "-")
+		tmpname = savePayload(conn);
+	try {
+		if(tokens.size() < 2u + eval)
+			throw invalid_argument("ERROR serveRequest(), the clustering files are expected");
+		gengetopt_args_info  args = args_info;
+		applyOptions(tokens, 2 + eval, args);
+		// Note: the inline payloads are transient, so their snapshots are not cached
+		if(!tmpname.empty())
+			args.cache_dir_arg = nullptr;
+		const char*  gtname = tokens[1].c_str();
+		string  res;
+		if(eval) {
+			const char*  cnname = tmpname.empty() ? tokens[2].c_str() : tmpname.c_str();
+			res = args.ovp_flag ? serveEvaluation<AccProb>(args, gtname, cnname, residents)
+				: serveEvaluation<Id>(args, gtname, cnname, residents);
+		} else res = args.ovp_flag ? serveLoading<AccProb>(args, gtname, residents)
+			: serveLoading<Id>(args, gtname, residents);
+		if(!tmpname.empty())
+			unlink(tmpname.c_str());
+		return res;
+	} catch(...) {
+		if(!tmpname.empty())
+			unlink(tmpname.c_str());
+		throw;
+	}
+}
+
+//! \brief Serve the buffered requests of the client connection
+//! \note Each request is a line of the space-separated tokens, each response
+//! is a line of the JSON object
+//!
+//! \param conn Connection&  - the client connection having a request
+//! \param args_info const gengetopt_args_info&  - the server arguments
+//! \param residents Residents&  - resident ground-truth collections
+//! \param state ServerState&  - the server state
+//! \return bool  - the connection is retained, false if it is closed
+static bool serveClient(Connection& conn, const gengetopt_args_info& args_info
+	, Residents& residents, ServerState& state)
+{
+	string  line;
+	do {
+		if(!conn.readline(line))
+			return false;
+		vector<string>  tokens;
+		char*  ctx = nullptr;  // Tokenization context, the clients are served concurrently
+		for(char* tok = strtok_r(&line[0], " \t", &ctx); tok; tok = strtok_r(nullptr, " \t", &ctx))
+			tokens.emplace_back(tok);
+		if(tokens.empty())
+			continue;
+		string  resp;
+		try {
+			resp = "{\"status\": \"ok\", " + serveRequest(args_info, tokens, conn, residents
+				, state) + "}";
+		} catch(IdOverflow& err) {
+			resp = "{\"status\": \"error\", \"error\": \"" + jsonEscape(err.what())
+				+ ", the server should be started with the wide ids (-w)\"}";
+		} catch(std::exception& err) {
+			resp = "{\"status\": \"error\", \"error\": \"" + jsonEscape(err.what()) + "\"}";
+		}
+		if(!conn.writeline(move(resp)))
+			return false;
+	} while(conn.buffered());
+	return true;
+}
+
+//! \brief Serve the evaluation requests on the Unix domain socket
+//! \pre The arguments are validated
+//!
+//! \param args_info const gengetopt_args_info&  - the parsed arguments
+//! \return int  - the execution status
+int serve(const gengetopt_args_info& args_info)
+{
+	const char*  sockname = args_info.serve_arg;
+	sockaddr_un  addr;
+	memset(&addr, 0, sizeof addr);
+	addr.sun_family = AF_UNIX;
+	if(strlen(sockname) >= sizeof addr.sun_path) {
+		fprintf(stderr, "ERROR, the socket name is too long: %s\n", sockname);
+		return ENAMETOOLONG;
+	}
+	strcpy(addr.sun_path, sockname);
+	// Remove the stale socket
+	struct stat  fst;
+	if(!stat(sockname, &fst) && S_ISSOCK(fst.st_mode))
+		unlink(sockname);
+	const int  lfd = socket(AF_UNIX, SOCK_STREAM, 0);
+	if(lfd == -1 || bind(lfd, reinterpret_cast<sockaddr*>(&addr), sizeof addr)
+	|| listen(lfd, SOMAXCONN)) {
+		const int  err = errno;
+		perror((string("ERROR, the socket can't be served: ") += sockname).c_str());
+		if(lfd != -1)
+			close(lfd);
+		return err;
+	}
+	// Note: the disconnected clients should not terminate the server
+	signal(SIGPIPE, SIG_IGN);
+
+	Residents  residents(size_t(args_info.budget_arg) << 20);
+	ServerState  state;
+	// Serve the requests by the pool of workers
+	const unsigned  workers = workersNum(numeric_limits<size_t>::max(), 1);
+	vector<std::thread>  pool;
+	pool.reserve(workers);
+	for(unsigned i = 0; i < workers; ++i)
+		pool.emplace_back([&args_info, &residents, &state] {
+			while(true) {
+				ServerState::ConnectionPtr  conn;
+				{
+					std::unique_lock<mutex>  lock(state.guard);
+					state.ready.wait(lock, [&state] { return state.stop || !state.pending.empty(); });
+					if(state.stop)
+						return;
+					conn = move(state.pending.front());
+					state.pending.pop_front();
+				}
+				if(!serveClient(*conn, args_info, residents, state))
+					continue;  // The connection is closed
+				lock_guard<mutex>  lock(state.guard);
+				state.served.push_back(move(conn));
+				state.wake();
 			}
-			// Assign matching kind
-			Match  mkind = Match::NONE;
-			// Note: args_info.kind_orig is empty if default value is used
-			char  kindsuf = '-';  // Suffix char of the selected F1 measure
-			switch(args_info.kind_arg) {
-			case kind_arg_weighted:
-				mkind = Match::WEIGHTED;
-				kindsuf = 'w';
-				break;
-			case kind_arg_unweighed:
-				mkind = Match::UNWEIGHTED;
-				kindsuf = 'u';
-				break;
-			case kind_arg_combined:
-				mkind = Match::COMBINED;
-				kindsuf = 'c';
+		});
+	fprintf(stderr, "The evaluation server is listening %s with %u workers\n", sockname, workers);
+
+	// Poll the idle connections passing them to the workers on the requests
+	vector<ServerState::ConnectionPtr>  idle;
+	vector<pollfd>  fds;
+	int  err = 0;
+	while(true) {
+		fds.assign({{lfd, POLLIN, 0}, {state.wakefd[0], POLLIN, 0}});
+		for(const auto& conn: idle)
+			fds.push_back({conn->fd(), POLLIN, 0});
+		if(poll(fds.data(), fds.size(), -1) == -1) {
+			if(errno == EINTR)
+				continue;
+			err = errno;
+			perror("ERROR, the connections can't be polled");
+			break;
+		}
+		// Note: the waking signals are drained, the state is checked afterwards
+		if(fds[1].revents) {
+			char  sigs[64];
+			if(read(state.wakefd[0], sigs, sizeof sigs) == -1 && errno != EINTR) {
+				err = errno;
+				perror("ERROR, the waking pipe can't be read");
 				break;
-			default:
-				throw invalid_argument("main(), UNKNOWN Matching policy specified\n");
 			}
+		}
+		{
+			lock_guard<mutex>  lock(state.guard);
+			if(state.stop)
+				break;
+			// Pass the requested connections to the workers retaining the order
+			size_t  iidle = 0;
+			for(size_t i = 0; i < idle.size(); ++i)
+				if(fds[2 + i].revents)
+					state.pending.push_back(move(idle[i]));
+				else if(iidle++ != i)
+					idle[iidle - 1] = move(idle[i]);
+			idle.resize(iidle);
+			if(!state.pending.empty())
+				state.ready.notify_all();
+			for(auto& conn: state.served)
+				idle.push_back(move(conn));
+			state.served.clear();
+		}
+		if(fds[0].revents) {
+			const int  fd = accept(lfd, nullptr, nullptr);
+			if(fd != -1)
+				idle.emplace_back(new Connection(fd));
+			else if(errno != EINTR && errno != ECONNABORTED)
+				perror("WARNING, the connection can't be accepted");
+		}
+	}
+	state.terminate();
+	for(auto& th: pool)
+		th.join();
+	close(lfd);
+	unlink(sockname);
+	return err;
+}
 
-			//if(args_info.nmi_flag)
-			//	fputs("; ", stdout);
-			Prob  prc, rec;  // Precision and recall of cn2 relative to ground-truth cn1
-			const auto  f1val = Collection::f1(cn1, cn2, f1kind, rec, prc, mkind, args_info.detailed_flag);
-			printf("MF1%c_%c (%s, %s):\n%G", f1suf, kindsuf, to_string(f1kind).c_str()
-				, to_string(mkind).c_str(), f1val);
-			if(prc || rec)
-				printf(" (Prc: %G, Rec: %G)", prc, rec);
-			fputc('\n', stdout);
-			if(--outsnum || aggouts.tellp()) {
-				if(aggouts.tellp())
-					aggouts << "; ";
-				aggouts << "MF1" << f1suf << '_' << kindsuf << ": " << f1val;
-				// Note: prc and rec are zeroized if the matching strategy does not support them
-				if(prc || rec)
-					aggouts << " (Prc: " << prc << ", Rec: " << rec << ')';
-			}
+#ifdef ID64
+}  // id64
+#else
+namespace id64 {
+
+int convert(const gengetopt_args_info& args_info);
+int evaluate(const gengetopt_args_info& args_info);
+int serve(const gengetopt_args_info& args_info);
+
+}  // id64
+
+//! \brief Arguments parser
+struct ArgParser: gengetopt_args_info {
+	ArgParser(int argc, char **argv) {
+		auto  err = cmdline_parser(argc, argv, this);
+		if(err)
+			throw std::invalid_argument("Arguments parsing failed: " + to_string(err));
+	}
+
+	~ArgParser() {
+		cmdline_parser_free(this);
+	}
+};
+
+
+int main(int argc, char **argv)
+{
+	ArgParser  args_info(argc, argv);
+
+	// Ensure existence of the snapshots cache
+	if(args_info.cache_dir_given)
+		ensureDir(args_info.cache_dir_arg);
+
+	// Serve the evaluation requests if required
+	if(args_info.serve_given) {
+		if(args_info.inputs_num || args_info.convert_given || args_info.batch_flag
+		|| args_info.pairwise_given || args_info.label_given || args_info.string_ids_flag) {
+			fputs("ERROR, the evaluating clusterings are specified by the requests in the"
+				" serving mode, where the conversion, batch and pairwise evaluation, labeling"
+				" and string ids are not applicable\n", stderr);
+			return EINVAL;
+		}
+		if(args_info.budget_arg <= 0) {
+			fprintf(stderr, "ERROR, positive memory budget is expected: %d\n", args_info.budget_arg);
+			return EDOM;
+		}
+		// Note: the resident collections can't be reloaded with the wider ids
+		return args_info.wide_ids_flag ? id64::serve(args_info) : serve(args_info);
+	}
+
+	// Validate the conversion of the clustering to the binary format if required
+	if(args_info.convert_given) {
+		if(args_info.string_ids_flag) {
+			fputs("ERROR, the binary clustering holds numeric ids only, the string ids"
+				" can't be converted\n", stderr);
+			return EINVAL;
 		}
-		// Label clusters with the ground-truth clusters indices and output F1 for the labels if required
-		if(args_info.label_given) {
-			if(args_info.policy_arg == policy__NULL) {
-				fputs("WARNING f1(), labels matching policy is not specified, the evaluation is skipped\n", stderr);
-				return 0;
+		if(args_info.inputs_num != 1) {
+			fputs("ERROR, a single input clustering is expected for the conversion\n", stderr);
+			cmdline_parser_print_help();
+			return EINVAL;
+		}
+	} else {
+		// Validate required xmeasure
+		if(!args_info.omega_flag && !args_info.nmi_flag && !args_info.onmi_flag
+		&& !args_info.f1_given && !args_info.label_given) {
+			fputs("WARNING, no any measures to evaluate are specified\n", stderr);
+			cmdline_parser_print_help();
+			return EINVAL;
+		}
+
+		if(args_info.membership_arg <= 0) {
+			fprintf(stderr, "ERROR, positive membership is expected: %G\n", args_info.membership_arg);
+			return EDOM;
+		}
+
+		if(args_info.batch_flag) {
+			if(args_info.inputs_num < 2 || args_info.label_given || args_info.pairwise_given) {
+				fputs("ERROR, the ground-truth followed by the evaluating clusterings are"
+					" required in the batch mode, where the labeling and pairwise"
+					" evaluation are not applicable\n", stderr);
+				cmdline_parser_print_help();
+				return EINVAL;
 			}
-			// Reset cluster counters if they were set (could be set only by F1)
-			if(args_info.f1_given) {
-				cn1.clearcounts();
-				cn2.clearcounts();
+			if(args_info.prefetch_arg < 0) {
+				fprintf(stderr, "ERROR, non-negative prefetching depth is expected: %d\n"
+					, args_info.prefetch_arg);
+				return EDOM;
 			}
-			const bool  prob = args_info.policy_arg == policy_arg_partprob;  // Partial Probabilities matching policy
-			const bool  weighted = !args_info.unweighted_flag;
-			PrcRec pr = Collection::label(cn1, cn2 //, lostcls
-				, prob, weighted, args_info.identifiers_arg); //, args_info.detailed_flag);
-			// Note: each measure name should form a single world to be properly parsed in a uniform way (see Clubmark),
-			// that is why doubled underscore is used rather than a single space.
-			printf("F1%c_%c__labels: %G (Prc: %G, Rec: %G)\n"
-				, prob ? 'p' : 'h', weighted ? 'w' : 'u'
-				, hmean(pr.prc, pr.rec), pr.prc, pr.rec);
-			if(--outsnum || aggouts.tellp()) {
-				if(aggouts.tellp())
-					aggouts << "; ";
-				aggouts << "F1" << (prob ? 'p' : 'h') << '_' << (weighted ? 'w' : 'u')
-					<< "__labels: " << hmean(pr.prc, pr.rec)
-					<< " (Prc: " << pr.prc << ", Rec: " << pr.rec << ')';
+		} else if(args_info.pairwise_given) {
+			if(!args_info.inputs_num || args_info.label_given) {
+				fputs("ERROR, the clusterings are required in the pairwise mode, where"
+					" the labeling is not applicable\n", stderr);
+				cmdline_parser_print_help();
+				return EINVAL;
 			}
-		}
-		if(args_info.omega_flag) {
-			// Transform loaded and pre-processed collection to the representation
-			// suitable for Omega Index evaluation
-			RawClusters  cls1;
-			RawClusters  cls2;
-			NodeRClusters  ndrcs;
-
-			cn1.template transfer<true>(cls1, ndrcs);
-			cn2.template transfer<false>(cls2, ndrcs);
-			const auto oi = args_info.extended_flag
-				? omega<true>(ndrcs, cls1, cls2)
-				: omega<false>(ndrcs, cls1, cls2)
-				;
-			printf("OI%s:\n%G\n", args_info.extended_flag ? "x" : "", oi);
-			if(--outsnum || aggouts.tellp()) {
-				if(aggouts.tellp())
-					aggouts << "; ";
-				aggouts << "OI" << (args_info.extended_flag ? "x" : "") << ": " << oi;
+		} else {	// Validate the number of input files
+			// Note: sync_arg is specified if sync_given
+			const auto  inpfiles = args_info.inputs_num + (args_info.sync_given || args_info.label_given);  // The number of input files
+			if(inpfiles < 2 || inpfiles > 2 + args_info.sync_given + args_info.label_given) {
+				fputs("ERROR, 2 input clusterings are required with possibly additional"
+					" node base and clusters labels, i.e. 2-4 input files in total\n", stderr);
+				cmdline_parser_print_help();
+				return EINVAL;
 			}
 		}
-		if(aggouts.tellp())
-			puts(aggouts.str().c_str());
 
-		return 0;
-	};
+		{	// Validate that the stdin is read at most once
+			unsigned  stdins = (args_info.sync_given && isStdStream(args_info.sync_arg))
+				+ (args_info.label_given && isStdStream(args_info.label_arg));
+			for(unsigned i = 0; i < args_info.inputs_num; ++i)
+				stdins += isStdStream(args_info.inputs[i]);
+			if(stdins >= 2) {
+				fputs("ERROR, the stdin ('-') can be specified for a single input file only\n", stderr);
+				return EINVAL;
+			}
+		}
 
+		// Verify that labeled clusters correspond to the node base if any of them is specified
+		if(args_info.sync_given && args_info.label_given && (strcmp(args_info.sync_arg, args_info.label_arg)
+		|| (args_info.inputs_num == 2 && strcmp(args_info.sync_arg, args_info.inputs[0]))))
+			throw invalid_argument("ERROR, node base file should correspond to the labeled clusters and"
+				" represent the first evaluating collection if both are specified\n");
+	}
 
-    return args_info.ovp_flag ? process(AccProb()) : process(Id());
+	// Process the inputs with the 32-bit node ids, which are reloaded with the
+	// 64-bit ones if required
+	int (*const  task)(const gengetopt_args_info&) = args_info.convert_given ? convert : evaluate;
+	int (*const  task64)(const gengetopt_args_info&) = args_info.convert_given
+		? id64::convert : id64::evaluate;
+	if(args_info.wide_ids_flag)
+		return task64(args_info);
+	try {
+		return task(args_info);
+	} catch(IdOverflow& err) {
+		// Note: the streamed inputs are consumed and can't be reloaded
+		bool  streamed = args_info.sync_given && isStreamed(args_info.sync_arg);
+		streamed = streamed || (args_info.label_given && isStreamed(args_info.label_arg));
+		for(unsigned i = 0; i < args_info.inputs_num && !streamed; ++i)
+			streamed = isStreamed(args_info.inputs[i]);
+		if(streamed) {
+			fprintf(stderr, "ERROR, the streamed input can't be reloaded with the 64-bit"
+				" node ids, the wide ids (-w) should be specified. %s", err.what());
+			return EOVERFLOW;
+		}
+		fprintf(stderr, "WARNING, the clusterings are reloaded with the 64-bit node ids. %s"
+			, err.what());
+	}
+	return task64(args_info);
 }
+#endif // ID64
@@ -0,0 +1,13 @@
+//! \brief Extrinsic measures evaluation for the clusterings with the 64-bit node ids.
+//! \note The evaluation is called by main() when the 32-bit node ids overflow.
+//!
+//! \license Apache License, Version 2.0: http://www.apache.org/licenses/LICENSE-2.0.html
+//! > 	Simple explanation: https://tldrlegal.com/license/apache-license-2.0-(apache-2.0)
+//!
+//! Copyright (c)
+//! \authr Artem Lutov
+//! \email luart@ya.ru
+//! \date 2026-10-18
+
+#define ID64
+#include "main.cpp"
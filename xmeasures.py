@@ -3,6 +3,8 @@
 """
 :Description: Python API and usage example for C API of the xmeasures library
 Note that items in collections are allowed to be non-contiguous (i.e., hashes can be used as ids)
+The evaluation of the collection handles is reentrant and ctypes releases the GIL on the foreign calls,
+so the handles can be evaluated concurrently from multiple Python threads or in batches by xms_evaluate_batch()
 
 :Authors: (c) Artem Lutov <lua@lutan.ch>
 :Date: 2020-03-12
@@ -10,7 +12,7 @@ Note that items in collections are allowed to be non-contiguous (i.e., hashes ca
 
 import pathlib
 import numpy as np
-from ctypes import Structure, CDLL, POINTER, c_uint, c_float #, c_void_p
+from ctypes import Structure, CDLL, POINTER, byref, c_uint, c_float, c_uint8, c_uint16, c_uint32, c_int, c_size_t, c_void_p
 from collections.abc import Iterable
 
 # Python wrappers for C types ------------------------------------------------------------------------------------------
@@ -29,13 +31,15 @@ def clusterNodes(ids, weights=None):
 	"""ClusterNodes initialization
 
 	ids: iterable(uint)  - cluster node ids
-	weights: iterable  - cluster node weights
+	weights: iterable(float)  - cluster node weights (fuzzy memberships) aligned with ids,
+		the weights of each node are normalized to its shares in the clusters
 
 	return ClusterNodes
 	"""
 	assert isinstance(ids, Iterable) and (weights is None or isinstance(weights, Iterable)), 'Invalid argument types'
+	assert weights is None or len(weights) == len(ids), 'Weights should be aligned with ids'
 	cnIds = (c_uint * len(ids))(*ids)
-	cnWeights = c_float_p() if not weights else (c_float * len(weights))(*weights)
+	cnWeights = c_float_p() if weights is None else (c_float * len(weights))(*weights)
 	return ClusterNodes(len(ids), cnIds, cnWeights)
 
 
@@ -58,15 +62,113 @@ def clusterCollection(clusters):
 def weightedClusterCollection(clusters):
 	"""ClusterCollection initialization
 
-	nodes: iterable((iterable(uint), iterable(float)))  - weighted clusters (collections of nodes and their weights)
+	clusters: iterable((iterable(uint), iterable(float)))  - weighted clusters (collections of nodes and their weights)
 
 	return ClusterCollection
 	"""
 	assert isinstance(clusters, Iterable) and len(clusters[0]) == 2 and isinstance(clusters[0][0], Iterable), 'Invalid argument type'
-	cc = (c_uint * len(clusters))(*(clusterNodes(nds, wgs) for nds, wgs in clusters))
+	cc = (ClusterNodes * len(clusters))(*(clusterNodes(nds, wgs) for nds, wgs in clusters))
 	return ClusterCollection(len(clusters), cc)
 
 
+class CsrCollection(Structure):
+	_fields_ = [('num', c_uint),
+				('offsets', c_uint_p),
+				('ids', c_uint_p),
+				('weights', c_float_p)]
+
+def uint32Array(vals):
+	"""Contiguous uint32 array of the values validating their range
+
+	vals: buffer(uint)  - unsigned integer values
+
+	return np.array(uint32)  - the values, which are copied only if they are not a contiguous uint32 array
+	raise ValueError  - the values are not integers or out of the uint32 range
+	"""
+	vals = np.asarray(vals)
+	if vals.dtype != np.uint32 and vals.size:
+		if vals.dtype.kind not in 'iu':
+			raise ValueError('Integer values are expected instead of ' + str(vals.dtype))
+		if vals.min() < 0 or vals.max() > np.iinfo(np.uint32).max:
+			raise ValueError('The values are out of the uint32 range: {} .. {}'.format(vals.min(), vals.max()))
+	return np.ascontiguousarray(vals, dtype=np.uint32)
+
+
+def csrCollection(offsets, ids, weights=None):
+	"""CsrCollection initialization from the flat CSR buffers, which are passed without copying
+
+	offsets: buffer(uint32)  - offsets of the clusters in ids, (clusters number + 1) items starting from 0
+	ids: buffer(uint32)  - node ids of all clusters
+	weights: buffer(float32)  - node weights aligned with ids
+
+	Any object supporting the buffer protocol (NumPy arrays, array.array, memoryview) is accepted;
+	it is copied only if it is not a contiguous array of the required item type.
+	The library copies the node ids once on the creation of the collection handle.
+
+	return CsrCollection  - the collection referring the buffers, which are retained by the collection
+	raise ValueError  - the offsets or ids are not integers or out of the uint32 range
+	"""
+	offsets = uint32Array(offsets)
+	ids = uint32Array(ids)
+	assert offsets.ndim == 1 and offsets.size and offsets[-1] == ids.size, 'Invalid CSR buffers'
+	cc = CsrCollection(offsets.size - 1, offsets.ctypes.data_as(c_uint_p), ids.ctypes.data_as(c_uint_p), c_float_p())
+	if weights is not None:
+		weights = np.ascontiguousarray(weights, dtype=np.float32)
+		assert weights.size == ids.size, 'Weights should be aligned with ids'
+		cc.weights = weights.ctypes.data_as(c_float_p)
+	cc._buffers = (offsets, ids, weights)  # Retain the buffers while the collection is alive
+	return cc
+
+
+def csrClusters(clusters):
+	"""Flat CSR buffers of the clusters
+
+	clusters: iterable(iterable(uint))  - clusters (collection of nodes)
+
+	return offsets: np.array(uint32), ids: np.array(uint32)  - CSR buffers for csrCollection()
+	"""
+	sizes = np.fromiter((len(nds) for nds in clusters), dtype=np.uint32)
+	offsets = np.zeros(sizes.size + 1, dtype=np.uint32)
+	np.cumsum(sizes, out=offsets[1:])
+	ids = np.fromiter((nd for nds in clusters for nd in nds), dtype=np.uint32, count=int(offsets[-1]))
+	return offsets, ids
+
+
+class NmiValues(Structure):
+	_fields_ = [('max', c_float),
+				('sqrt', c_float),
+				('avg', c_float),
+				('min', c_float)]
+
+
+# Measure flags of the combined evaluation
+MEASURE_NMI = 1
+MEASURE_ONMI = 2
+MEASURE_F1 = 4
+MEASURE_LABEL = 8
+MEASURE_OMEGA = 0x10
+
+class Measures(Structure):
+	"""Combined evaluation: the requested measures with their parameters and the resulting values"""
+	_fields_ = [('measures', c_uint32),
+				('f1kind', c_int),
+				('mkind', c_int),
+				('expbase', c_uint8),
+				('lbprob', c_uint8),
+				('lbweighted', c_uint8),
+				('ext', c_uint8),
+				('nmi', NmiValues),
+				('onmi', c_float),
+				('onmilfk', c_float),
+				('f1', c_float),
+				('f1prc', c_float),
+				('f1rec', c_float),
+				('lbf1', c_float),
+				('lbprc', c_float),
+				('lbrec', c_float),
+				('omega', c_float)]
+
+
 # Example of xmeasures usage from Python -------------------------------------------------------------------------------
 if __name__ == "__main__":
 	# Load the shared library into ctypes
@@ -77,6 +179,31 @@ if __name__ == "__main__":
 	xms.f1h.restype = c_float
 	xms.omegaExt.restype = c_float
 	xms.omega.restype = c_float
+	xms.xms_collection_create.restype = c_void_p
+	xms.xms_collection_create.argtypes = (ClusterCollection, c_uint8)
+	xms.xms_collection_create_csr.restype = c_void_p
+	xms.xms_collection_create_csr.argtypes = (CsrCollection, c_uint8)
+	xms.xms_collection_free.argtypes = (c_void_p,)
+	xms.xms_f1.restype = c_float
+	xms.xms_f1.argtypes = (c_void_p, c_void_p, c_uint, c_float_p, c_float_p, c_uint, c_uint8, c_uint8)
+	xms.xms_omega.restype = c_float
+	xms.xms_omega.argtypes = (c_void_p, c_void_p, c_uint8, c_uint8)
+	xms.xms_collection_size.restype = c_uint
+	xms.xms_collection_size.argtypes = (c_void_p,)
+	xms.xms_collection_weighted.restype = c_uint8
+	xms.xms_collection_weighted.argtypes = (c_void_p,)
+	xms.xms_nmi.restype = c_float
+	xms.xms_nmi.argtypes = (c_void_p, c_void_p, POINTER(NmiValues), c_uint8, c_uint8)
+	xms.xms_onmi.restype = c_float
+	xms.xms_onmi.argtypes = (c_void_p, c_void_p, c_float_p, c_uint8)
+	xms.xms_label.restype = c_float
+	xms.xms_label.argtypes = (c_void_p, c_void_p, c_uint8, c_uint8, c_float_p, c_float_p
+		, c_uint_p, c_uint_p, c_uint, c_uint_p, c_uint8)
+	xms.xms_evaluate.restype = c_uint32
+	xms.xms_evaluate.argtypes = (c_void_p, c_void_p, POINTER(Measures), c_uint8)
+	xms.xms_evaluate_batch.restype = c_size_t
+	xms.xms_evaluate_batch.argtypes = (c_void_p, POINTER(c_void_p), c_size_t, POINTER(Measures), POINTER(Measures)
+		, c_uint8, c_uint16)
 	# Perform evaluations
 	nc1 = clusterCollection(((9,2,4), (2,13)))
 	nc2 = clusterCollection([[9,13,2], [2,4]])
@@ -86,3 +213,48 @@ if __name__ == "__main__":
 		xms.omegaExt(nc1, nc2),
 		xms.omega(nc1, nc2)
 	))
+	# Index the collections once and reuse them in multiple evaluations
+	hc1 = xms.xms_collection_create(nc1, 0)
+	# Note: large collections are passed as the flat CSR buffers without the per-cluster marshalling
+	hc2 = xms.xms_collection_create_csr(csrCollection(*csrClusters([[9,13,2], [2,4]])), 0)
+	try:
+		# F1Kind: 1 - F1p, 2 - F1h; MatchKind: 3 - combined (MKind_CMB)
+		print('Handles F1p: {}, F1h: {}, omegaExt: {}, omega: {}'.format(
+			xms.xms_f1(hc1, hc2, 1, None, None, 3, 0, 0),
+			xms.xms_f1(hc1, hc2, 2, None, None, 3, 0, 0),
+			xms.xms_omega(hc1, hc2, 1, 0),
+			xms.xms_omega(hc1, hc2, 0, 0)
+		))
+		nmis = NmiValues()
+		xms.xms_nmi(hc1, hc2, byref(nmis), 0, 0)
+		print('NMI_max: {}, NMI_sqrt: {}, NMI_avg: {}, NMI_min: {}'.format(nmis.max, nmis.sqrt, nmis.avg, nmis.min))
+		# Labels of each cluster of hc2 in the CSR format
+		clsnum = xms.xms_collection_size(hc2)
+		offsets = (c_uint * (clsnum + 1))()
+		# Note: each cluster has at most all ground-truth clusters as labels
+		labels = (c_uint * (xms.xms_collection_size(hc1) * clsnum))()
+		lbsnum = c_uint()
+		prc = c_float()
+		rec = c_float()
+		lbf1 = xms.xms_label(hc1, hc2, 1, 1, byref(prc), byref(rec), offsets, labels, len(labels), byref(lbsnum), 0)
+		print('F1p_w__labels: {} (Prc: {}, Rec: {}), labels: {}'.format(lbf1, prc.value, rec.value
+			, [labels[offsets[i]:offsets[i + 1]] for i in range(clsnum)]))
+		# Multiple measures sharing the indexes
+		msrs = Measures(measures=MEASURE_NMI | MEASURE_ONMI | MEASURE_F1 | MEASURE_OMEGA, f1kind=1, mkind=3, ext=1)
+		xms.xms_evaluate(hc1, hc2, byref(msrs), 0)
+		print('Combined NMI_max: {}, ONMI_max: {}, F1p: {}, omegaExt: {}'.format(msrs.nmi.max, msrs.onmi, msrs.f1, msrs.omega))
+		# Concurrent evaluation of multiple candidates against the ground-truth using all CPUs
+		cands = (c_void_p * 2)(hc2, hc1)
+		results = (Measures * len(cands))()
+		xms.xms_evaluate_batch(hc1, cands, len(cands), byref(msrs), results, 0, 0)
+		print('Batch F1p: {}'.format([res.f1 for res in results]))
+		# Fuzzy clusters, where the node 2 belongs mostly to the first cluster
+		hw = xms.xms_collection_create(weightedClusterCollection((((9,2,4), (1,0.8,1)), ((2,13), (0.2,1)))), 0)
+		try:
+			xms.xms_evaluate(hw, hc2, byref(msrs), 0)
+			print('Weighted NMI_max: {}, F1p: {}, omegaExt: {}'.format(msrs.nmi.max, msrs.f1, msrs.omega))
+		finally:
+			xms.xms_collection_free(hw)
+	finally:
+		xms.xms_collection_free(hc1)
+		xms.xms_collection_free(hc2)